@@ -0,0 +1,65 @@
+#ifndef DEMO_BEHAVIOURS_HPP
+#define DEMO_BEHAVIOURS_HPP
+
+#include "ecs/behaviour.hpp"
+#include "ecs/entity.hpp"
+#include "components.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Steers an entity toward `point` and finishes once it is within `tolerance`
+ *
+ * Only the Velocity is written, and reported with mark_written(); the entity
+ * is expected to be moved by a movement pass. Finishes early if the entity
+ * loses its Position or Velocity.
+ */
+inline game::ecs::Behaviour move_to(game::ecs::Entity& entity, Position point,
+                                    float speed = 10.0f, float tolerance = 1.0f) {
+    while (true) {
+        auto* pos = entity.get_component<Position>();
+        auto* vel = entity.get_component<Velocity>();
+        if (!pos || !vel) {
+            co_return;
+        }
+
+        const float dx = point.x - pos->x;
+        const float dy = point.y - pos->y;
+        const float distance_sq = dx * dx + dy * dy;
+
+        if (distance_sq < tolerance * tolerance) {
+            vel->dx = vel->dy = 0.0f;
+            entity.mark_written<Velocity>();
+            co_return;
+        }
+
+        const float distance = std::sqrt(distance_sq);
+        vel->dx = (dx / distance) * speed;
+        vel->dy = (dy / distance) * speed;
+        entity.mark_written<Velocity>();
+
+        co_await game::ecs::next_tick();
+    }
+}
+
+/**
+ * @brief Walks between `points` forever, pausing `pause_seconds` at each one
+ */
+inline game::ecs::Behaviour patrol(game::ecs::Entity& entity, std::vector<Position> points,
+                                   float pause_seconds = 1.0f) {
+    if (points.empty()) {
+        co_return;
+    }
+
+    for (std::size_t i = 0;; i = (i + 1) % points.size()) {
+        co_await move_to(entity, points[i]);
+        co_await game::ecs::wait_seconds(pause_seconds);
+    }
+}
+
+} // namespace demo
+
+#endif // DEMO_BEHAVIOURS_HPP
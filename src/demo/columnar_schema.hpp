@@ -0,0 +1,62 @@
+#ifndef DEMO_COLUMNAR_SCHEMA_HPP
+#define DEMO_COLUMNAR_SCHEMA_HPP
+
+#include "ecs/columnar.hpp"
+#include "components.hpp"
+#include "systems.hpp"
+#include <string_view>
+
+namespace demo {
+
+/**
+ * @brief Stable lowercase name of an AI state, used as its exported string value
+ */
+inline std::string_view ai_state_name(const AI::State state) {
+    switch (state) {
+        case AI::State::Idle:
+            return "idle";
+        case AI::State::Patrolling:
+            return "patrolling";
+        case AI::State::Chasing:
+            return "chasing";
+        case AI::State::Attacking:
+            return "attacking";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Columns the analytics exports need for heatmaps and balancing
+ *
+ * AI states are exported by name, so they are dictionary-encoded and stay
+ * readable if the enum is reordered.
+ */
+inline game::ecs::ColumnarSchema make_columnar_schema() {
+    game::ecs::ColumnarSchema schema;
+
+    schema.add_system<MovementSystem>("movement");
+    schema.add_system<HealthSystem>("health");
+    schema.add_system<AISystem>("ai");
+
+    schema.add_component<Position>("position")
+        .column("x", &Position::x)
+        .column("y", &Position::y);
+
+    schema.add_component<Velocity>("velocity")
+        .column("dx", &Velocity::dx)
+        .column("dy", &Velocity::dy);
+
+    schema.add_component<Health>("health")
+        .column("current_health", &Health::current_health)
+        .column("max_health", &Health::max_health);
+
+    schema.add_component<AI>("ai")
+        .string("state", [](const AI& ai) { return ai_state_name(ai.current_state); })
+        .column("target_entity_id", &AI::target_entity_id);
+
+    return schema;
+}
+
+} // namespace demo
+
+#endif // DEMO_COLUMNAR_SCHEMA_HPP
@@ -2,12 +2,19 @@
 #define DEMO_COMPONENTS_HPP
 
 #include "ecs/component.hpp"
+#include "ecs/component_meta.hpp"
 #include "ecs/entity.hpp"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 namespace demo {
 
+struct Path;
+
 /**
  * @brief Position component for 2D world coordinates
  * 
@@ -115,6 +122,83 @@ struct Timer : public game::ecs::Component {
     float progress() const { return std::min(elapsed_time / duration, 1.0f); }
 };
 
+/**
+ * @brief Navigation component for grid pathfinding
+ * 
+ * Holds a destination and the path being followed toward it.
+ * The path is requested asynchronously and shared with other
+ * entities heading to the same place. A request still in flight
+ * when the destination changes is left for the system steering
+ * the entity (NavigationSystem or AISystem) to release.
+ */
+struct Navigation : public game::ecs::Component {
+    float destination_x, destination_y;
+    bool has_destination;
+    float speed;
+    std::uint64_t request_id;
+    std::uint64_t abandoned_request_id;
+    std::shared_ptr<const Path> path;
+    size_t waypoint;
+    
+    Navigation(float speed = 10.0f)
+        : destination_x(0.0f), destination_y(0.0f), has_destination(false)
+        , speed(speed), request_id(0), abandoned_request_id(0), waypoint(0) {}
+    
+    void set_destination(float x, float y) {
+        destination_x = x;
+        destination_y = y;
+        has_destination = true;
+        if (request_id != 0) {
+            abandoned_request_id = request_id;
+        }
+        request_id = 0;
+        path.reset();
+        waypoint = 0;
+    }
+};
+
 } // namespace demo
 
+namespace game {
+namespace ecs {
+
+// Metadata for the plain-data demo components. Each only holds scalars next to
+// Component's vtable and owner pointers, so a bitwise copy is a valid move.
+
+template<>
+struct ComponentMeta<demo::Position> {
+    static constexpr std::string_view name = "position";
+    static constexpr auto fields = std::make_tuple(field("x", &demo::Position::x), field("y", &demo::Position::y));
+    static constexpr bool trivially_relocatable = true;
+};
+
+template<>
+struct ComponentMeta<demo::Velocity> {
+    static constexpr std::string_view name = "velocity";
+    static constexpr auto fields = std::make_tuple(field("dx", &demo::Velocity::dx), field("dy", &demo::Velocity::dy));
+    static constexpr bool trivially_relocatable = true;
+};
+
+template<>
+struct ComponentMeta<demo::Health> {
+    static constexpr std::string_view name = "health";
+    static constexpr auto fields = std::make_tuple(
+        field("current_health", &demo::Health::current_health),
+        field("max_health", &demo::Health::max_health));
+    static constexpr bool trivially_relocatable = true;
+};
+
+template<>
+struct ComponentMeta<demo::Timer> {
+    static constexpr std::string_view name = "timer";
+    static constexpr auto fields = std::make_tuple(
+        field("elapsed_time", &demo::Timer::elapsed_time),
+        field("duration", &demo::Timer::duration),
+        field("auto_remove", &demo::Timer::auto_remove));
+    static constexpr bool trivially_relocatable = true;
+};
+
+}//ecs
+}//game
+
 #endif // DEMO_COMPONENTS_HPP 
\ No newline at end of file
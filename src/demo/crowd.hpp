@@ -0,0 +1,223 @@
+#ifndef DEMO_CROWD_HPP
+#define DEMO_CROWD_HPP
+
+#include "ecs/entity.hpp"
+#include "ecs/thread_pool.hpp"
+#include "components.hpp"
+#include "spatial_grid.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Tuning for CrowdSteering
+ *
+ * Separation pushes agents apart with a strength that grows linearly as
+ * they close in from `radius`. Alignment steers toward the neighbours'
+ * average velocity and cohesion toward their average position; both are off
+ * by default so crowds of chasers only avoid each other. A positive
+ * `max_speed` caps the resulting speed.
+ */
+struct CrowdParams {
+    float radius{1.0f};
+    float separation{8.0f};
+    float alignment{0.0f};
+    float cohesion{0.0f};
+    float max_speed{0.0f};
+    std::uint32_t max_neighbours{16};
+};
+
+/**
+ * @brief Boids-style local avoidance that adjusts velocities in place
+ *
+ * Each tick the owner add()s every agent with the velocity it wants this
+ * tick, then step() sorts them into a SpatialGrid and adds the steering
+ * from each agent's neighbours. Grid cells are twice the avoidance radius,
+ * so each query covers at most 2x2 cells. Agents added with `steer == false` still
+ * act as neighbours but keep their velocity. Steering reads only the
+ * gathered copies of positions and velocities and each agent writes only
+ * its own Velocity, so agents are steered in parallel on the ThreadPool.
+ *
+ * Steering starts from the velocity the agent wanted, not the one it was
+ * pushed to. An agent whose Velocity still holds last tick's steered value
+ * was not given a new one, so it is steered again from the velocity it
+ * wanted then instead of accumulating another push every tick.
+ */
+class CrowdSteering {
+    struct Steered {
+        float dx;
+        float dy;
+        float wanted_dx;
+        float wanted_dy;
+    };
+
+    CrowdParams params_;
+    game::ecs::ThreadPool* pool_;
+    SpatialGrid grid_;
+
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> vx_;
+    std::vector<float> vy_;
+    std::vector<Velocity*> out_;
+    std::vector<std::uint8_t> steer_;
+    std::vector<game::ecs::EntityID> ids_;
+    std::unordered_map<game::ecs::EntityID, Steered> steered_;
+    std::unordered_map<game::ecs::EntityID, Steered> next_steered_;
+
+public:
+    explicit CrowdSteering(const CrowdParams& params = {}, game::ecs::ThreadPool* pool = nullptr)
+        : params_(params)
+        , pool_(pool)
+        , grid_(params.radius * 2.0f) {}
+
+    const CrowdParams& get_params() const noexcept { return params_; }
+
+    void set_params(const CrowdParams& params) noexcept {
+        params_ = params;
+        grid_.set_cell_size(params.radius * 2.0f);
+    }
+
+    void set_pool(game::ecs::ThreadPool* pool) noexcept { pool_ = pool; }
+
+    const SpatialGrid& get_grid() const noexcept { return grid_; }
+    std::size_t size() const noexcept { return x_.size(); }
+
+    void clear() noexcept {
+        x_.clear();
+        y_.clear();
+        vx_.clear();
+        vy_.clear();
+        out_.clear();
+        steer_.clear();
+        ids_.clear();
+    }
+
+    /**
+     * @brief Clears the agents and forgets the velocities they wanted
+     */
+    void reset() noexcept {
+        clear();
+        steered_.clear();
+        next_steered_.clear();
+    }
+
+    void add(const game::ecs::EntityID id, const Position& pos, Velocity* vel, bool steer = true) {
+        float dx = vel->dx;
+        float dy = vel->dy;
+        const auto it = steered_.find(id);
+        if (it != steered_.end() && it->second.dx == dx && it->second.dy == dy) {
+            dx = it->second.wanted_dx;
+            dy = it->second.wanted_dy;
+        }
+
+        x_.push_back(pos.x);
+        y_.push_back(pos.y);
+        vx_.push_back(dx);
+        vy_.push_back(dy);
+        out_.push_back(vel);
+        steer_.push_back(steer ? 1 : 0);
+        ids_.push_back(id);
+    }
+
+    /**
+     * @brief Rebuilds the neighbour grid and writes the steered velocity of every agent
+     */
+    void step() {
+        const auto count = x_.size();
+        grid_.build(x_.data(), y_.data(), count, pool_);
+
+        // Walk agents in grid order so consecutive queries share cells
+        const auto& order = grid_.get_order();
+        auto steer_range = [this, &order](std::size_t begin, std::size_t end) {
+            for (auto slot = begin; slot < end; ++slot) {
+                const auto i = order[slot];
+                if (steer_[i]) {
+                    steer(i);
+                }
+            }
+        };
+
+        if (pool_) {
+            pool_->parallel_for(count, 1024, steer_range);
+        } else {
+            steer_range(0, count);
+        }
+
+        // Agents that were not added or not steered this tick are no longer tracked
+        next_steered_.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (steer_[i]) {
+                next_steered_[ids_[i]] = {out_[i]->dx, out_[i]->dy, vx_[i], vy_[i]};
+            } else if (const auto it = steered_.find(ids_[i]); it != steered_.end()) {
+                next_steered_.insert(*it);
+            }
+        }
+        steered_.swap(next_steered_);
+    }
+
+private:
+    void steer(const std::size_t i) {
+        const float radius = params_.radius;
+        float separation_x = 0.0f;
+        float separation_y = 0.0f;
+        float velocity_x = 0.0f;
+        float velocity_y = 0.0f;
+        float offset_x = 0.0f;
+        float offset_y = 0.0f;
+        std::uint32_t neighbours = 0;
+
+        grid_.for_each_near(x_[i], y_[i], radius, [&](std::uint32_t j, float dx, float dy, float distance_sq) {
+            if (j == i) {
+                return true;
+            }
+
+            if (distance_sq > 0.0f) {
+                const float distance = std::sqrt(distance_sq);
+                const float push = (radius - distance) / (radius * distance);
+                separation_x -= dx * push;
+                separation_y -= dy * push;
+            } else {
+                // Exactly overlapping; split the pair apart along x by index
+                separation_x += j < i ? 1.0f : -1.0f;
+            }
+
+            velocity_x += vx_[j];
+            velocity_y += vy_[j];
+            offset_x += dx;
+            offset_y += dy;
+            return ++neighbours < params_.max_neighbours;
+        });
+
+        float vx = vx_[i];
+        float vy = vy_[i];
+
+        if (neighbours > 0) {
+            const float inv = 1.0f / static_cast<float>(neighbours);
+            vx += separation_x * params_.separation + (velocity_x * inv - vx_[i]) * params_.alignment +
+                  offset_x * inv * params_.cohesion;
+            vy += separation_y * params_.separation + (velocity_y * inv - vy_[i]) * params_.alignment +
+                  offset_y * inv * params_.cohesion;
+        }
+
+        if (params_.max_speed > 0.0f) {
+            const float speed_sq = vx * vx + vy * vy;
+            if (speed_sq > params_.max_speed * params_.max_speed) {
+                const float scale = params_.max_speed / std::sqrt(speed_sq);
+                vx *= scale;
+                vy *= scale;
+            }
+        }
+
+        out_[i]->dx = vx;
+        out_[i]->dy = vy;
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_CROWD_HPP
@@ -0,0 +1,332 @@
+#ifndef DEMO_FLOW_FIELD_HPP
+#define DEMO_FLOW_FIELD_HPP
+
+#include "ecs/entity.hpp"
+#include "ecs/thread_pool.hpp"
+#include "nav_grid.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Distance-to-goal and steering direction for every cell of a NavGrid
+ *
+ * The integration pass runs Dijkstra outward from the goal cell. The
+ * direction pass then points each cell at its cheapest neighbour; it reads
+ * only the finished integration field, so ranges of cells can be processed
+ * on different threads. Unreachable cells and the goal cell itself have a
+ * zero direction.
+ */
+class FlowField {
+    std::shared_ptr<const NavGrid> grid_;
+    CellIndex goal_{NavGrid::INVALID_CELL};
+    std::vector<float> cost_;
+    std::vector<float> dir_x_;
+    std::vector<float> dir_y_;
+
+public:
+    static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+    explicit FlowField(std::shared_ptr<const NavGrid> grid)
+        : grid_(std::move(grid)) {}
+
+    const NavGrid& get_grid() const noexcept { return *grid_; }
+    CellIndex get_goal() const noexcept { return goal_; }
+
+    float cost(CellIndex cell) const noexcept { return cost_[cell]; }
+
+    /**
+     * @brief Fills the integration field for `goal`; the direction field is stale until build_directions()
+     */
+    void build_integration(const CellIndex goal) {
+        const auto count = grid_->cell_count();
+        goal_ = goal;
+        cost_.assign(count, UNREACHABLE);
+        dir_x_.resize(count);
+        dir_y_.resize(count);
+
+        if (goal == NavGrid::INVALID_CELL || !grid_->is_walkable(goal)) {
+            return;
+        }
+
+        using Entry = std::pair<float, CellIndex>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        cost_[goal] = 0.0f;
+        open.emplace(0.0f, goal);
+
+        while (!open.empty()) {
+            const auto [distance, cell] = open.top();
+            open.pop();
+
+            if (distance > cost_[cell]) {
+                continue; // Stale heap entry
+            }
+
+            // Moves are symmetric, so the cost from a neighbour to this cell is the same as the reverse
+            grid_->for_each_neighbour(cell, [&](CellIndex next, float step) {
+                const float candidate = distance + step;
+                if (candidate < cost_[next]) {
+                    cost_[next] = candidate;
+                    open.emplace(candidate, next);
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief Points every cell in [begin, end) at its cheapest neighbour
+     */
+    void build_directions(const std::size_t begin, const std::size_t end) {
+        for (auto cell = static_cast<CellIndex>(begin); cell < end; ++cell) {
+            float best = cost_[cell];
+            CellIndex best_cell = NavGrid::INVALID_CELL;
+
+            if (best != UNREACHABLE) {
+                grid_->for_each_neighbour(cell, [&](CellIndex next, float) {
+                    if (cost_[next] < best) {
+                        best = cost_[next];
+                        best_cell = next;
+                    }
+                });
+            }
+
+            if (best_cell == NavGrid::INVALID_CELL) {
+                dir_x_[cell] = dir_y_[cell] = 0.0f;
+                continue;
+            }
+
+            const float dx = static_cast<float>(grid_->cell_x(best_cell)) - static_cast<float>(grid_->cell_x(cell));
+            const float dy = static_cast<float>(grid_->cell_y(best_cell)) - static_cast<float>(grid_->cell_y(cell));
+            const float inv = (dx != 0.0f && dy != 0.0f) ? 0.70710678f : 1.0f;
+            dir_x_[cell] = dx * inv;
+            dir_y_[cell] = dy * inv;
+        }
+    }
+
+    /**
+     * @brief Looks up the steering direction at a world position
+     *
+     * Returns false outside the grid, on unreachable cells and on the goal cell.
+     */
+    bool sample(float x, float y, float& dir_x, float& dir_y) const noexcept {
+        const auto cell = grid_->cell_at(x, y);
+        if (cell == NavGrid::INVALID_CELL || cost_[cell] == UNREACHABLE || cell == goal_) {
+            return false;
+        }
+
+        dir_x = dir_x_[cell];
+        dir_y = dir_y_[cell];
+        return true;
+    }
+};
+
+/**
+ * @brief Shared flow fields for goals chased by many entities
+ *
+ * Chasers report their goal with demand() each tick; update() then builds a
+ * field for every goal with at least `min_agents` chasers. A field is only
+ * rebuilt when its goal leaves the cell it was built for by more than
+ * `retarget_cells`; until then chasers close to the goal are told to steer
+ * straight at it instead. Integration passes for different goals run in
+ * parallel on the pool, followed by one parallel direction pass over the
+ * cells of every rebuilt field. Without a pool everything runs on the
+ * calling thread. Fields that go unused for `max_idle_updates` updates are
+ * dropped, as are the least recently used ones past `max_fields`.
+ */
+class FlowFieldCache {
+    struct Entry {
+        std::unique_ptr<FlowField> field;
+        float goal_x{0.0f};
+        float goal_y{0.0f};
+        std::uint32_t demand{0};
+        std::uint64_t last_used{0};
+    };
+
+    struct Rebuild {
+        FlowField* field;
+        CellIndex goal;
+    };
+
+    std::shared_ptr<const NavGrid> grid_;
+    game::ecs::ThreadPool* pool_;
+    std::uint32_t min_agents_;
+    std::uint32_t retarget_cells_;
+    std::size_t max_fields_;
+    std::uint64_t max_idle_updates_;
+
+    std::unordered_map<game::ecs::EntityID, Entry> entries_;
+    std::vector<Rebuild> rebuild_;
+    std::uint64_t update_count_{0};
+    std::size_t rebuild_count_{0};
+
+public:
+    explicit FlowFieldCache(std::shared_ptr<const NavGrid> grid, game::ecs::ThreadPool* pool = nullptr,
+                            std::uint32_t min_agents = 8, std::uint32_t retarget_cells = 2,
+                            std::size_t max_fields = 8, std::uint64_t max_idle_updates = 60)
+        : grid_(std::move(grid))
+        , pool_(pool)
+        , min_agents_(min_agents)
+        , retarget_cells_(retarget_cells)
+        , max_fields_(max_fields)
+        , max_idle_updates_(max_idle_updates) {}
+
+    const NavGrid& get_grid() const noexcept { return *grid_; }
+    std::size_t size() const noexcept { return entries_.size(); }
+    std::size_t get_rebuild_count() const noexcept { return rebuild_count_; }
+
+    /**
+     * @brief Replaces the grid; every field is rebuilt on its next update
+     */
+    void set_grid(std::shared_ptr<const NavGrid> grid) {
+        grid_ = std::move(grid);
+        entries_.clear();
+    }
+
+    /**
+     * @brief Records one chaser heading for `goal` at the goal's current position
+     */
+    void demand(const game::ecs::EntityID goal, const float goal_x, const float goal_y) {
+        auto& entry = entries_[goal];
+        entry.goal_x = goal_x;
+        entry.goal_y = goal_y;
+        ++entry.demand;
+    }
+
+    /**
+     * @brief Builds or rebuilds the fields demanded since the last update and resets demand
+     */
+    void update() {
+        ++update_count_;
+        rebuild_.clear();
+
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            auto& entry = it->second;
+
+            if (entry.demand >= min_agents_) {
+                entry.last_used = update_count_;
+                const auto goal = grid_->cell_at(entry.goal_x, entry.goal_y);
+                if (!entry.field || needs_retarget(*entry.field, goal)) {
+                    if (!entry.field) {
+                        entry.field = std::make_unique<FlowField>(grid_);
+                    }
+                    rebuild_.push_back({entry.field.get(), goal});
+                }
+            }
+
+            entry.demand = 0;
+            if (!entry.field || update_count_ - entry.last_used > max_idle_updates_) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        evict();
+        rebuild();
+    }
+
+    /**
+     * @brief Returns the field for `goal`, or nullptr if it has too few chasers to have one
+     */
+    const FlowField* find(const game::ecs::EntityID goal) const noexcept {
+        const auto it = entries_.find(goal);
+        return it != entries_.end() ? it->second.field.get() : nullptr;
+    }
+
+    /**
+     * @brief Looks up the direction toward `goal` from (x, y)
+     *
+     * Returns false when there is no field for the goal or the position is
+     * close enough to the goal that steering straight at it is better.
+     */
+    bool sample(const game::ecs::EntityID goal, float x, float y, float& dir_x, float& dir_y) const noexcept {
+        const auto* field = find(goal);
+        if (!field) {
+            return false;
+        }
+
+        const auto cell = grid_->cell_at(x, y);
+        if (cell == NavGrid::INVALID_CELL || field->cost(cell) <= static_cast<float>(retarget_cells_) + 1.5f) {
+            return false;
+        }
+        return field->sample(x, y, dir_x, dir_y);
+    }
+
+private:
+    bool needs_retarget(const FlowField& field, const CellIndex goal) const noexcept {
+        if (goal == NavGrid::INVALID_CELL || field.get_goal() == NavGrid::INVALID_CELL) {
+            return goal != field.get_goal();
+        }
+
+        const auto dx = static_cast<std::int64_t>(grid_->cell_x(goal)) - grid_->cell_x(field.get_goal());
+        const auto dy = static_cast<std::int64_t>(grid_->cell_y(goal)) - grid_->cell_y(field.get_goal());
+        return std::max(std::abs(dx), std::abs(dy)) > static_cast<std::int64_t>(retarget_cells_);
+    }
+
+    void evict() {
+        while (entries_.size() > max_fields_) {
+            auto oldest = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+
+            const auto* field = oldest->second.field.get();
+            rebuild_.erase(std::remove_if(rebuild_.begin(), rebuild_.end(),
+                                          [field](const Rebuild& pending) { return pending.field == field; }),
+                           rebuild_.end());
+            entries_.erase(oldest);
+        }
+    }
+
+    void rebuild() {
+        if (rebuild_.empty()) {
+            return;
+        }
+
+        // Stage 1: one integration pass per goal
+        run(rebuild_.size(), 1, [this](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                rebuild_[i].field->build_integration(rebuild_[i].goal);
+            }
+        });
+
+        // Stage 2: directions for every cell of every rebuilt field
+        const std::size_t cells = grid_->cell_count();
+        run(rebuild_.size() * cells, 4096, [this, cells](std::size_t begin, std::size_t end) {
+            while (begin < end) {
+                const auto field = begin / cells;
+                const auto first = begin % cells;
+                const auto last = std::min(cells, first + (end - begin));
+                rebuild_[field].field->build_directions(first, last);
+                begin += last - first;
+            }
+        });
+
+        rebuild_count_ += rebuild_.size();
+    }
+
+    template<typename Fn>
+    void run(const std::size_t count, const std::size_t grain, Fn&& fn) {
+        if (pool_) {
+            pool_->parallel_for(count, grain, std::forward<Fn>(fn));
+        } else if (count > 0) {
+            fn(std::size_t{0}, count);
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_FLOW_FIELD_HPP
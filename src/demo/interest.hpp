@@ -0,0 +1,446 @@
+#ifndef DEMO_INTEREST_HPP
+#define DEMO_INTEREST_HPP
+
+#include "ecs/replication.hpp"
+#include "ecs/thread_pool.hpp"
+#include "components.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Relevance radii of one observer
+ *
+ * An entity becomes relevant once it is within `enter_radius` and stays
+ * relevant until it is farther than `leave_radius`, so entities near the
+ * edge do not flicker in and out.
+ */
+struct InterestParams {
+    float enter_radius{50.0f};
+    float leave_radius{60.0f};
+};
+
+/**
+ * @brief Keeps a relevance set per observer up to date from entity positions
+ *
+ * The manager tracks every entity with a Position in the given systems
+ * through attached observers, keeping a dense table of entity references
+ * and Position pointers instead of looking components up each tick. The
+ * spatial index is a set of grid cells as wide as the largest leave radius,
+ * each holding its table slots and a copy of their references and positions. Unlike
+ * SpatialGrid it is not rebuilt: update() copies every position into its
+ * cell, in parallel on the ThreadPool, and only moves the entities whose
+ * cell changed. Every observer is then refreshed in parallel, scanning the
+ * contiguous positions of the nearby cells: one radius query per observer
+ * yields its new set, and the differences to the previous set are kept as
+ * that observer's entered and left lists. Sets hold ReplicatedEntity values
+ * whose system index is the position in the list given to the constructor,
+ * so a set can be passed straight to ReplicationEncoder::set_relevant() when
+ * the systems are given in replication schema order.
+ */
+class InterestManager {
+    class Tracker : public game::ecs::EntityObserver {
+        InterestManager& owner_;
+        std::uint32_t system_;
+
+    public:
+        Tracker(InterestManager& owner, const std::uint32_t system) noexcept
+            : owner_(owner)
+            , system_(system) {}
+
+        void on_entity_removed(game::ecs::Entity& entity) noexcept override {
+            owner_.untrack(entity);
+        }
+
+        void on_component_added(game::ecs::Entity& entity, const std::type_index& type) noexcept override {
+            if (type == typeid(Position)) {
+                owner_.track(system_, entity);
+            }
+        }
+
+        void on_component_removed(game::ecs::Entity& entity, const std::type_index& type) noexcept override {
+            if (type == typeid(Position)) {
+                owner_.untrack(entity);
+            }
+        }
+    };
+
+    struct Observer {
+        float x{0.0f};
+        float y{0.0f};
+        InterestParams params;
+        bool active{false};
+        std::vector<game::ecs::ReplicatedEntity> relevant;
+        std::vector<game::ecs::ReplicatedEntity> next;
+        std::vector<game::ecs::ReplicatedEntity> entered;
+        std::vector<game::ecs::ReplicatedEntity> left;
+    };
+
+    std::vector<game::ecs::System*> systems_;
+    std::vector<std::unique_ptr<Tracker>> trackers_;
+    game::ecs::ThreadPool* pool_;
+
+    static constexpr std::uint32_t NO_CELL = 0xFFFFFFFFu;
+
+    // Members of one grid cell; positions are copied in so queries scan contiguous memory
+    struct Cell {
+        std::uint64_t key{0};
+        std::vector<std::uint32_t> slots;
+        std::vector<game::ecs::ReplicatedEntity> refs;
+        std::vector<float> xs;
+        std::vector<float> ys;
+    };
+
+    // Dense table of tracked entities; a slot's index_in_cell_ is NO_CELL until its first update()
+    std::vector<game::ecs::ReplicatedEntity> refs_;
+    std::vector<const Position*> positions_;
+    std::vector<std::uint32_t> cell_of_;
+    std::vector<std::uint32_t> index_in_cell_;
+    std::unordered_map<const game::ecs::Entity*, std::uint32_t> slot_of_;
+
+    float cell_size_{0.0f};
+    float inv_cell_size_{0.0f};
+    std::vector<Cell> cells_;
+    std::unordered_map<std::uint64_t, std::uint32_t> cell_index_;
+
+    // Scratch filled by update()
+    std::vector<std::uint8_t> moved_;
+    std::vector<std::uint32_t> movers_;
+    std::size_t moved_count_{0};
+
+    std::vector<Observer> observers_;
+
+public:
+    explicit InterestManager(std::vector<game::ecs::System*> systems, game::ecs::ThreadPool* pool = nullptr)
+        : systems_(std::move(systems))
+        , pool_(pool) {
+        for (std::uint32_t s = 0; s < systems_.size(); ++s) {
+            trackers_.push_back(std::make_unique<Tracker>(*this, s));
+            if (!systems_[s]) {
+                continue;
+            }
+
+            systems_[s]->attach_observer(trackers_.back().get());
+            for (auto& [_, entity] : systems_[s]->get_entities()) {
+                if (entity->has_component<Position>()) {
+                    track(s, *entity);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Tracks the systems of a replication schema, in schema order
+     */
+    InterestManager(game::ecs::World& world, const game::ecs::ReplicationSchema& schema,
+                    game::ecs::ThreadPool* pool = nullptr)
+        : InterestManager(systems_of(world, schema), pool) {}
+
+    InterestManager(const InterestManager&) = delete;
+    InterestManager& operator=(const InterestManager&) = delete;
+
+    ~InterestManager() {
+        for (std::size_t s = 0; s < systems_.size(); ++s) {
+            if (systems_[s]) {
+                systems_[s]->detach_observer(trackers_[s].get());
+            }
+        }
+    }
+
+    void set_pool(game::ecs::ThreadPool* pool) noexcept { pool_ = pool; }
+
+    /**
+     * @brief Number of tracked entities with a Position
+     */
+    std::size_t size() const noexcept { return refs_.size(); }
+
+    /**
+     * @brief Entities that changed cell in the last update()
+     */
+    std::size_t get_moved_count() const noexcept { return moved_count_; }
+
+    std::uint32_t add_observer(const float x, const float y, const InterestParams& params = {}) {
+        std::uint32_t id = 0;
+        while (id < observers_.size() && observers_[id].active) {
+            ++id;
+        }
+        if (id == observers_.size()) {
+            observers_.emplace_back();
+        }
+
+        auto& observer = observers_[id];
+        observer = {};
+        observer.x = x;
+        observer.y = y;
+        observer.params = params;
+        observer.active = true;
+        return id;
+    }
+
+    void remove_observer(const std::uint32_t observer) noexcept {
+        if (observer < observers_.size()) {
+            observers_[observer].active = false;
+            observers_[observer].relevant.clear();
+            observers_[observer].entered.clear();
+            observers_[observer].left.clear();
+        }
+    }
+
+    void move_observer(const std::uint32_t observer, const float x, const float y) noexcept {
+        if (observer < observers_.size()) {
+            observers_[observer].x = x;
+            observers_[observer].y = y;
+        }
+    }
+
+    /**
+     * @brief Entities relevant to `observer` as of the last update(), sorted
+     */
+    const std::vector<game::ecs::ReplicatedEntity>& get_relevant(const std::uint32_t observer) const noexcept {
+        return observers_[observer].relevant;
+    }
+
+    /**
+     * @brief Entities that became relevant to `observer` in the last update(), sorted
+     */
+    const std::vector<game::ecs::ReplicatedEntity>& get_entered(const std::uint32_t observer) const noexcept {
+        return observers_[observer].entered;
+    }
+
+    /**
+     * @brief Entities that stopped being relevant to `observer` in the last update(), including removed ones
+     */
+    const std::vector<game::ecs::ReplicatedEntity>& get_left(const std::uint32_t observer) const noexcept {
+        return observers_[observer].left;
+    }
+
+    bool is_relevant(const std::uint32_t observer, const game::ecs::ReplicatedEntity& entity) const noexcept {
+        const auto& relevant = observers_[observer].relevant;
+        return std::binary_search(relevant.begin(), relevant.end(), entity);
+    }
+
+    /**
+     * @brief Moves entities that changed cell and refreshes every observer's set and events
+     */
+    void update() {
+        // Cells as large as the widest query keep every query within 3x3 cells
+        float cell_size = 1.0f;
+        for (const auto& observer : observers_) {
+            if (observer.active) {
+                cell_size = std::max({cell_size, observer.params.enter_radius, observer.params.leave_radius});
+            }
+        }
+        if (cell_size != cell_size_) {
+            cell_size_ = cell_size;
+            inv_cell_size_ = 1.0f / cell_size;
+            cells_.clear();
+            cell_index_.clear();
+            std::fill(index_in_cell_.begin(), index_in_cell_.end(), NO_CELL);
+        }
+
+        // Read positions in table order, which follows allocation order, and scatter them into their cells
+        const auto count = positions_.size();
+        moved_.resize(count);
+        run(count, 16384, [this](const std::size_t begin, const std::size_t end) {
+            for (auto slot = begin; slot < end; ++slot) {
+                const auto index = index_in_cell_[slot];
+                if (index == NO_CELL) {
+                    moved_[slot] = 1;
+                    continue;
+                }
+
+                const auto* pos = positions_[slot];
+                auto& cell = cells_[cell_of_[slot]];
+                cell.xs[index] = pos->x;
+                cell.ys[index] = pos->y;
+                moved_[slot] = pack(cell_coord(pos->x), cell_coord(pos->y)) != cell.key;
+            }
+        });
+
+        movers_.clear();
+        for (std::uint32_t slot = 0; slot < count; ++slot) {
+            if (moved_[slot]) {
+                movers_.push_back(slot);
+            }
+        }
+
+        for (const auto slot : movers_) {
+            leave_cell(slot);
+            enter_cell(slot);
+        }
+        moved_count_ = movers_.size();
+
+        run(observers_.size(), 8, [this](const std::size_t begin, const std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                if (observers_[i].active) {
+                    refresh(observers_[i]);
+                }
+            }
+        });
+    }
+
+private:
+    static std::vector<game::ecs::System*> systems_of(game::ecs::World& world,
+                                                      const game::ecs::ReplicationSchema& schema) {
+        std::vector<game::ecs::System*> systems;
+        for (const auto& entry : schema.get_systems()) {
+            systems.push_back(entry.get(world));
+        }
+        return systems;
+    }
+
+    void track(const std::uint32_t system, game::ecs::Entity& entity) {
+        const auto* pos = entity.get_component<Position>();
+        if (!pos || slot_of_.find(&entity) != slot_of_.end()) {
+            return;
+        }
+
+        slot_of_.emplace(&entity, static_cast<std::uint32_t>(refs_.size()));
+        refs_.push_back({system, entity.get_id()});
+        positions_.push_back(pos);
+        cell_of_.push_back(0);
+        index_in_cell_.push_back(NO_CELL);
+    }
+
+    void untrack(const game::ecs::Entity& entity) noexcept {
+        const auto it = slot_of_.find(&entity);
+        if (it == slot_of_.end()) {
+            return;
+        }
+
+        const auto slot = it->second;
+        const auto last = static_cast<std::uint32_t>(refs_.size() - 1);
+        slot_of_.erase(it);
+        leave_cell(slot);
+
+        // Swap the last entry into the freed slot
+        if (slot != last) {
+            refs_[slot] = refs_[last];
+            positions_[slot] = positions_[last];
+            cell_of_[slot] = cell_of_[last];
+            index_in_cell_[slot] = index_in_cell_[last];
+            if (index_in_cell_[slot] != NO_CELL) {
+                cells_[cell_of_[slot]].slots[index_in_cell_[slot]] = slot;
+            }
+            const auto* moved = systems_[refs_[slot].system]->get_entity(refs_[slot].id);
+            slot_of_[moved] = slot;
+        }
+        refs_.pop_back();
+        positions_.pop_back();
+        cell_of_.pop_back();
+        index_in_cell_.pop_back();
+    }
+
+    void leave_cell(const std::uint32_t slot) noexcept {
+        const auto index = index_in_cell_[slot];
+        if (index == NO_CELL) {
+            return;
+        }
+
+        auto& cell = cells_[cell_of_[slot]];
+        const auto back = cell.slots.back();
+        cell.slots[index] = back;
+        cell.refs[index] = cell.refs.back();
+        cell.xs[index] = cell.xs.back();
+        cell.ys[index] = cell.ys.back();
+        index_in_cell_[back] = index;
+        cell.slots.pop_back();
+        cell.refs.pop_back();
+        cell.xs.pop_back();
+        cell.ys.pop_back();
+        index_in_cell_[slot] = NO_CELL;
+    }
+
+    void enter_cell(const std::uint32_t slot) {
+        const auto* pos = positions_[slot];
+        const auto key = pack(cell_coord(pos->x), cell_coord(pos->y));
+        const auto [it, inserted] = cell_index_.emplace(key, static_cast<std::uint32_t>(cells_.size()));
+        if (inserted) {
+            cells_.emplace_back().key = key;
+        }
+
+        auto& cell = cells_[it->second];
+        cell_of_[slot] = it->second;
+        index_in_cell_[slot] = static_cast<std::uint32_t>(cell.slots.size());
+        cell.slots.push_back(slot);
+        cell.refs.push_back(refs_[slot]);
+        cell.xs.push_back(pos->x);
+        cell.ys.push_back(pos->y);
+    }
+
+    void refresh(Observer& observer) const {
+        const float enter_sq = observer.params.enter_radius * observer.params.enter_radius;
+        const float leave = std::max(observer.params.enter_radius, observer.params.leave_radius);
+
+        const float leave_sq = leave * leave;
+
+        observer.next.clear();
+        const auto min_x = cell_coord(observer.x - leave);
+        const auto max_x = cell_coord(observer.x + leave);
+        const auto min_y = cell_coord(observer.y - leave);
+        const auto max_y = cell_coord(observer.y + leave);
+        for (auto cy = min_y; cy <= max_y; ++cy) {
+            for (auto cx = min_x; cx <= max_x; ++cx) {
+                const auto it = cell_index_.find(pack(cx, cy));
+                if (it == cell_index_.end()) {
+                    continue;
+                }
+
+                const auto& cell = cells_[it->second];
+                for (std::size_t i = 0; i < cell.slots.size(); ++i) {
+                    const float dx = cell.xs[i] - observer.x;
+                    const float dy = cell.ys[i] - observer.y;
+                    const float distance_sq = dx * dx + dy * dy;
+                    if (distance_sq > leave_sq) {
+                        continue;
+                    }
+
+                    const auto& entity = cell.refs[i];
+                    if (distance_sq <= enter_sq ||
+                        std::binary_search(observer.relevant.begin(), observer.relevant.end(), entity)) {
+                        observer.next.push_back(entity);
+                    }
+                }
+            }
+        }
+        std::sort(observer.next.begin(), observer.next.end());
+
+        observer.entered.clear();
+        observer.left.clear();
+        std::set_difference(observer.next.begin(), observer.next.end(), observer.relevant.begin(),
+                            observer.relevant.end(), std::back_inserter(observer.entered));
+        std::set_difference(observer.relevant.begin(), observer.relevant.end(), observer.next.begin(),
+                            observer.next.end(), std::back_inserter(observer.left));
+        observer.relevant.swap(observer.next);
+    }
+
+    std::int32_t cell_coord(const float value) const noexcept {
+        return static_cast<std::int32_t>(std::floor(value * inv_cell_size_));
+    }
+
+    static std::uint64_t pack(const std::int32_t cx, const std::int32_t cy) noexcept {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+    }
+
+    template<typename Fn>
+    void run(const std::size_t count, const std::size_t grain, Fn&& fn) {
+        if (pool_) {
+            pool_->parallel_for(count, grain, std::forward<Fn>(fn));
+        } else if (count > 0) {
+            fn(std::size_t{0}, count);
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_INTEREST_HPP
@@ -0,0 +1,113 @@
+#ifndef DEMO_NAV_GRID_HPP
+#define DEMO_NAV_GRID_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Cell index into a NavGrid
+ */
+using CellIndex = std::uint32_t;
+
+/**
+ * @brief Walkability grid used for navigation
+ *
+ * Covers the world from (origin_x, origin_y) with square cells of
+ * `cell_size` units. Cells are addressed by a flat row-major index.
+ * Grids are treated as immutable while navigation queries are in
+ * flight; build a new grid to change the level.
+ */
+class NavGrid {
+    std::uint32_t width_;
+    std::uint32_t height_;
+    float cell_size_;
+    float origin_x_;
+    float origin_y_;
+    std::vector<std::uint8_t> walkable_;
+
+public:
+    static constexpr CellIndex INVALID_CELL = 0xFFFFFFFFu;
+
+    NavGrid(std::uint32_t width, std::uint32_t height, float cell_size = 1.0f,
+            float origin_x = 0.0f, float origin_y = 0.0f)
+        : width_(width)
+        , height_(height)
+        , cell_size_(cell_size)
+        , origin_x_(origin_x)
+        , origin_y_(origin_y)
+        , walkable_(static_cast<std::size_t>(width) * height, 1) {}
+
+    std::uint32_t width() const noexcept { return width_; }
+    std::uint32_t height() const noexcept { return height_; }
+    std::uint32_t cell_count() const noexcept { return width_ * height_; }
+    float cell_size() const noexcept { return cell_size_; }
+
+    CellIndex index(std::uint32_t x, std::uint32_t y) const noexcept { return y * width_ + x; }
+    std::uint32_t cell_x(CellIndex cell) const noexcept { return cell % width_; }
+    std::uint32_t cell_y(CellIndex cell) const noexcept { return cell / width_; }
+
+    bool in_bounds(std::int64_t x, std::int64_t y) const noexcept {
+        return x >= 0 && y >= 0 && x < static_cast<std::int64_t>(width_) && y < static_cast<std::int64_t>(height_);
+    }
+
+    bool is_walkable(CellIndex cell) const noexcept { return walkable_[cell] != 0; }
+
+    bool is_walkable(std::int64_t x, std::int64_t y) const noexcept {
+        return in_bounds(x, y) && walkable_[index(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y))] != 0;
+    }
+
+    void set_walkable(std::uint32_t x, std::uint32_t y, bool walkable) noexcept {
+        walkable_[index(x, y)] = walkable ? 1 : 0;
+    }
+
+    /**
+     * @brief Returns the cell containing a world position, or INVALID_CELL outside the grid
+     */
+    CellIndex cell_at(float world_x, float world_y) const noexcept {
+        const auto x = static_cast<std::int64_t>(std::floor((world_x - origin_x_) / cell_size_));
+        const auto y = static_cast<std::int64_t>(std::floor((world_y - origin_y_) / cell_size_));
+        if (!in_bounds(x, y)) {
+            return INVALID_CELL;
+        }
+        return index(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y));
+    }
+
+    float center_x(CellIndex cell) const noexcept { return origin_x_ + (cell_x(cell) + 0.5f) * cell_size_; }
+    float center_y(CellIndex cell) const noexcept { return origin_y_ + (cell_y(cell) + 0.5f) * cell_size_; }
+
+    /**
+     * @brief Calls `fn(neighbour, cost)` for each walkable 8-neighbour of `cell`
+     *
+     * Diagonal moves cost sqrt(2) and may not cut past a blocked corner.
+     */
+    template<typename Fn>
+    void for_each_neighbour(CellIndex cell, Fn&& fn) const {
+        static constexpr int OFFSETS[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+        const auto x = static_cast<std::int64_t>(cell_x(cell));
+        const auto y = static_cast<std::int64_t>(cell_y(cell));
+
+        for (int i = 0; i < 8; ++i) {
+            const auto nx = x + OFFSETS[i][0];
+            const auto ny = y + OFFSETS[i][1];
+            if (!is_walkable(nx, ny)) {
+                continue;
+            }
+
+            if (i >= 4) {
+                if (!is_walkable(nx, y) || !is_walkable(x, ny)) {
+                    continue;
+                }
+                fn(index(static_cast<std::uint32_t>(nx), static_cast<std::uint32_t>(ny)), 1.41421356f);
+            } else {
+                fn(index(static_cast<std::uint32_t>(nx), static_cast<std::uint32_t>(ny)), 1.0f);
+            }
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_NAV_GRID_HPP
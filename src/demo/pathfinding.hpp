@@ -0,0 +1,396 @@
+#ifndef DEMO_PATHFINDING_HPP
+#define DEMO_PATHFINDING_HPP
+
+#include "ecs/thread_pool.hpp"
+#include "nav_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief A route through a NavGrid, from the start cell to the goal cell
+ */
+struct Path {
+    std::vector<CellIndex> cells;
+};
+
+using PathRequestId = std::uint64_t;
+
+enum class PathStatus { Unknown, Pending, Ready, Failed };
+
+/**
+ * @brief Outcome of a path request
+ *
+ * Paths are shared between requests; the requester's route starts at
+ * `path->cells[offset]`.
+ */
+struct PathResult {
+    PathStatus status{PathStatus::Unknown};
+    std::shared_ptr<const Path> path;
+    std::size_t offset{0};
+};
+
+/**
+ * @brief Asynchronous A* pathfinding over a NavGrid with a shared result cache
+ *
+ * request() never blocks: it answers from the cache when it can, joins an
+ * identical search already in flight, or queues a new search on the worker
+ * threads. When the bounded queue is full the request is rejected (returns 0)
+ * and should simply be retried on a later tick. A request whose start or goal
+ * lies outside the grid is accepted but fails at once, as retrying can't help.
+ *
+ * Finished paths are cached per goal cell. Every cell along a cached path
+ * records where it sits on that path, so any later request whose start lies
+ * on a path to the same goal is served the remaining suffix without a search.
+ * The least recently used goals are evicted past `max_cached_goals`.
+ */
+class PathfindingService {
+    struct Request {
+        PathStatus status;
+        std::shared_ptr<const Path> path;
+        std::size_t offset;
+    };
+
+    struct CachedCell {
+        std::shared_ptr<const Path> path;
+        std::size_t offset;
+    };
+
+    struct GoalCache {
+        std::unordered_map<CellIndex, CachedCell> cells;
+        std::uint64_t last_used{0};
+    };
+
+    std::shared_ptr<const NavGrid> grid_;
+    std::uint64_t grid_generation_{0};
+    std::size_t max_pending_;
+    std::size_t max_cached_goals_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<PathRequestId, Request> requests_;
+    std::unordered_map<std::uint64_t, std::vector<PathRequestId>> in_flight_;
+    std::unordered_map<CellIndex, GoalCache> cache_;
+    PathRequestId next_request_id_{1};
+    std::uint64_t use_counter_{0};
+    std::size_t cache_hits_{0};
+    std::size_t searches_{0};
+
+    // Declared last so workers are joined before the state they use is destroyed
+    game::ecs::ThreadPool pool_;
+
+public:
+    explicit PathfindingService(std::shared_ptr<const NavGrid> grid, std::size_t threads = 1,
+                                std::size_t max_pending = 256, std::size_t max_cached_goals = 64)
+        : grid_(std::move(grid))
+        , max_pending_(max_pending)
+        , max_cached_goals_(max_cached_goals)
+        , pool_(threads) {}
+
+    std::shared_ptr<const NavGrid> get_grid() const {
+        std::lock_guard lock(mutex_);
+        return grid_;
+    }
+
+    /**
+     * @brief Swaps in a new grid; cached paths and in-flight results for the old one are dropped
+     */
+    void set_grid(std::shared_ptr<const NavGrid> grid) {
+        std::lock_guard lock(mutex_);
+        grid_ = std::move(grid);
+        ++grid_generation_;
+        cache_.clear();
+        for (auto& [_, waiting] : in_flight_) {
+            for (const auto id : waiting) {
+                const auto it = requests_.find(id);
+                if (it != requests_.end()) {
+                    it->second.status = PathStatus::Failed;
+                }
+            }
+        }
+        in_flight_.clear();
+    }
+
+    std::size_t get_pending_count() const {
+        std::lock_guard lock(mutex_);
+        return in_flight_.size();
+    }
+
+    /**
+     * @brief Requests issued and not yet released
+     */
+    std::size_t get_request_count() const {
+        std::lock_guard lock(mutex_);
+        return requests_.size();
+    }
+
+    std::size_t get_cache_hits() const {
+        std::lock_guard lock(mutex_);
+        return cache_hits_;
+    }
+
+    std::size_t get_search_count() const {
+        std::lock_guard lock(mutex_);
+        return searches_;
+    }
+
+    /**
+     * @brief Asks for a path between two world positions; returns 0 if the queue is full
+     */
+    PathRequestId request(float start_x, float start_y, float goal_x, float goal_y) {
+        std::lock_guard lock(mutex_);
+
+        const auto start = grid_->cell_at(start_x, start_y);
+        const auto goal = grid_->cell_at(goal_x, goal_y);
+        if (start == NavGrid::INVALID_CELL || goal == NavGrid::INVALID_CELL) {
+            const auto id = next_request_id_++;
+            requests_.emplace(id, Request{PathStatus::Failed, nullptr, 0});
+            return id;
+        }
+
+        const auto cached = cache_.find(goal);
+        if (cached != cache_.end()) {
+            const auto cell = cached->second.cells.find(start);
+            if (cell != cached->second.cells.end()) {
+                cached->second.last_used = ++use_counter_;
+                ++cache_hits_;
+                const auto id = next_request_id_++;
+                requests_.emplace(id, Request{PathStatus::Ready, cell->second.path, cell->second.offset});
+                return id;
+            }
+        }
+
+        const auto key = (static_cast<std::uint64_t>(start) << 32) | goal;
+        auto flight = in_flight_.find(key);
+        if (flight == in_flight_.end()) {
+            if (in_flight_.size() >= max_pending_) {
+                return 0;
+            }
+
+            flight = in_flight_.emplace(key, std::vector<PathRequestId>{}).first;
+            auto grid = grid_;
+            const auto generation = grid_generation_;
+            pool_.submit([this, grid = std::move(grid), generation, key, start, goal] {
+                auto path = find_path(*grid, start, goal);
+                complete(generation, key, goal, std::move(path));
+            });
+        }
+
+        const auto id = next_request_id_++;
+        requests_.emplace(id, Request{PathStatus::Pending, nullptr, 0});
+        flight->second.push_back(id);
+        return id;
+    }
+
+    /**
+     * @brief Like request(), but searches on the calling thread so the result is final on return
+     *
+     * For deterministic simulations: when a path arrives, and which cached
+     * routes later requests are served from, then follow the order of the
+     * calls instead of worker timing. Never rejected.
+     */
+    PathRequestId request_now(float start_x, float start_y, float goal_x, float goal_y) {
+        std::shared_ptr<const NavGrid> grid;
+        CellIndex start;
+        CellIndex goal;
+        {
+            std::lock_guard lock(mutex_);
+            start = grid_->cell_at(start_x, start_y);
+            goal = grid_->cell_at(goal_x, goal_y);
+            if (start == NavGrid::INVALID_CELL || goal == NavGrid::INVALID_CELL) {
+                const auto id = next_request_id_++;
+                requests_.emplace(id, Request{PathStatus::Failed, nullptr, 0});
+                return id;
+            }
+
+            const auto cached = cache_.find(goal);
+            if (cached != cache_.end()) {
+                const auto cell = cached->second.cells.find(start);
+                if (cell != cached->second.cells.end()) {
+                    cached->second.last_used = ++use_counter_;
+                    ++cache_hits_;
+                    const auto id = next_request_id_++;
+                    requests_.emplace(id, Request{PathStatus::Ready, cell->second.path, cell->second.offset});
+                    return id;
+                }
+            }
+            grid = grid_;
+        }
+
+        std::shared_ptr<const Path> path = find_path(*grid, start, goal);
+
+        std::lock_guard lock(mutex_);
+        ++searches_;
+        if (grid != grid_) {
+            path = nullptr; // Grid changed while searching, as set_grid() fails in-flight requests
+        }
+        const auto id = next_request_id_++;
+        requests_.emplace(id, path ? Request{PathStatus::Ready, path, 0} : Request{PathStatus::Failed, nullptr, 0});
+        if (path) {
+            cache_path(goal, path);
+        }
+        return id;
+    }
+
+    /**
+     * @brief Returns the current state of a request without blocking
+     */
+    PathResult poll(PathRequestId id) const {
+        std::lock_guard lock(mutex_);
+        const auto it = requests_.find(id);
+        if (it == requests_.end()) {
+            return {};
+        }
+        return {it->second.status, it->second.path, it->second.offset};
+    }
+
+    /**
+     * @brief Forgets a request once its result has been taken or is no longer wanted
+     */
+    void release(PathRequestId id) {
+        std::lock_guard lock(mutex_);
+        requests_.erase(id);
+    }
+
+    void wait_idle() {
+        pool_.wait_idle();
+    }
+
+    /**
+     * @brief The service's worker pool, e.g. to register it with a ForkCheckpointer
+     */
+    game::ecs::ThreadPool& get_pool() noexcept { return pool_; }
+
+    /**
+     * @brief A* search with an octile heuristic; returns nullptr when the goal is unreachable
+     */
+    static std::shared_ptr<Path> find_path(const NavGrid& grid, CellIndex start, CellIndex goal) {
+        if (!grid.is_walkable(start) || !grid.is_walkable(goal)) {
+            return nullptr;
+        }
+
+        struct Scratch {
+            std::vector<float> g;
+            std::vector<CellIndex> parent;
+            std::vector<std::uint32_t> stamp;
+            std::uint32_t generation{0};
+        };
+        thread_local Scratch scratch;
+
+        const auto count = grid.cell_count();
+        if (scratch.stamp.size() != count) {
+            scratch.g.assign(count, 0.0f);
+            scratch.parent.assign(count, NavGrid::INVALID_CELL);
+            scratch.stamp.assign(count, 0);
+            scratch.generation = 0;
+        }
+        const auto generation = ++scratch.generation;
+
+        const auto goal_x = static_cast<float>(grid.cell_x(goal));
+        const auto goal_y = static_cast<float>(grid.cell_y(goal));
+        auto heuristic = [&](CellIndex cell) {
+            const float dx = std::abs(static_cast<float>(grid.cell_x(cell)) - goal_x);
+            const float dy = std::abs(static_cast<float>(grid.cell_y(cell)) - goal_y);
+            return std::max(dx, dy) + 0.41421356f * std::min(dx, dy);
+        };
+
+        using Entry = std::pair<float, CellIndex>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+        scratch.stamp[start] = generation;
+        scratch.g[start] = 0.0f;
+        scratch.parent[start] = NavGrid::INVALID_CELL;
+        open.emplace(heuristic(start), start);
+
+        while (!open.empty()) {
+            const auto [f, cell] = open.top();
+            open.pop();
+
+            if (cell == goal) {
+                auto path = std::make_shared<Path>();
+                for (auto at = goal; at != NavGrid::INVALID_CELL; at = scratch.parent[at]) {
+                    path->cells.push_back(at);
+                }
+                std::reverse(path->cells.begin(), path->cells.end());
+                return path;
+            }
+
+            if (f - heuristic(cell) > scratch.g[cell] + 1e-4f) {
+                continue; // Stale heap entry
+            }
+
+            grid.for_each_neighbour(cell, [&](CellIndex next, float cost) {
+                const float g = scratch.g[cell] + cost;
+                if (scratch.stamp[next] != generation || g < scratch.g[next]) {
+                    scratch.stamp[next] = generation;
+                    scratch.g[next] = g;
+                    scratch.parent[next] = cell;
+                    open.emplace(g + heuristic(next), next);
+                }
+            });
+        }
+
+        return nullptr;
+    }
+
+private:
+    void complete(std::uint64_t generation, std::uint64_t key, CellIndex goal, std::shared_ptr<Path> path) {
+        std::lock_guard lock(mutex_);
+        ++searches_;
+
+        if (generation != grid_generation_) {
+            return; // Grid changed while searching; set_grid() already failed the waiters
+        }
+
+        const auto flight = in_flight_.find(key);
+        if (flight == in_flight_.end()) {
+            return;
+        }
+
+        std::shared_ptr<const Path> shared = std::move(path);
+        for (const auto id : flight->second) {
+            const auto it = requests_.find(id);
+            if (it != requests_.end()) {
+                it->second = shared ? Request{PathStatus::Ready, shared, 0} : Request{PathStatus::Failed, nullptr, 0};
+            }
+        }
+        in_flight_.erase(flight);
+
+        if (shared) {
+            cache_path(goal, shared);
+        }
+    }
+
+    void cache_path(CellIndex goal, const std::shared_ptr<const Path>& path) {
+        auto& goal_cache = cache_[goal];
+        goal_cache.last_used = ++use_counter_;
+        for (std::size_t i = 0; i < path->cells.size(); ++i) {
+            goal_cache.cells.try_emplace(path->cells[i], CachedCell{path, i});
+        }
+        evict();
+    }
+
+    void evict() {
+        while (cache_.size() > max_cached_goals_) {
+            auto oldest = cache_.begin();
+            for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            cache_.erase(oldest);
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_PATHFINDING_HPP
@@ -0,0 +1,45 @@
+#ifndef DEMO_REPLICATION_SCHEMA_HPP
+#define DEMO_REPLICATION_SCHEMA_HPP
+
+#include "ecs/replication.hpp"
+#include "components.hpp"
+#include "systems.hpp"
+
+namespace demo {
+
+/**
+ * @brief Replication schema for the state clients need to draw the demo world
+ *
+ * Positions are sent in 1/32 unit steps within +-4096 units and velocities
+ * in 1/256 unit steps within +-64 units per second. Names, patrol points and
+ * timers stay on the server.
+ */
+inline game::ecs::ReplicationSchema make_replication_schema() {
+    game::ecs::ReplicationSchema schema;
+
+    schema.add_system<MovementSystem>("movement");
+    schema.add_system<HealthSystem>("health");
+    schema.add_system<AISystem>("ai");
+
+    schema.add_component<Position>("position")
+        ->quantized("x", &Position::x, -4096.0f, 4096.0f, 1.0f / 32.0f)
+        .quantized("y", &Position::y, -4096.0f, 4096.0f, 1.0f / 32.0f);
+
+    schema.add_component<Velocity>("velocity")
+        ->quantized("dx", &Velocity::dx, -64.0f, 64.0f, 1.0f / 256.0f)
+        .quantized("dy", &Velocity::dy, -64.0f, 64.0f, 1.0f / 256.0f);
+
+    schema.add_component<Health>("health")
+        ->integer("current_health", &Health::current_health, 16)
+        .integer("max_health", &Health::max_health, 16);
+
+    // AI::State has a signed underlying type, so its four states take three zigzag-encoded bits
+    schema.add_component<AI>("ai")
+        ->integer("current_state", &AI::current_state, 3);
+
+    return schema;
+}
+
+} // namespace demo
+
+#endif // DEMO_REPLICATION_SCHEMA_HPP
@@ -0,0 +1,104 @@
+#ifndef DEMO_SENSING_HPP
+#define DEMO_SENSING_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DEMO_SENSING_SSE 1
+#endif
+
+namespace demo {
+
+/**
+ * @brief Batched distance and direction kernel for AI sensing
+ *
+ * Callers gather the source and target positions of every agent into
+ * contiguous arrays with push(), run compute() once, and read back the
+ * squared distance and normalized direction per agent. The kernel processes
+ * four agents per instruction with SSE2 where available and falls back to
+ * scalar code otherwise. Callers should compare distance_sq() against squared
+ * ranges rather than taking a square root themselves.
+ */
+class SensingBatch {
+    std::vector<float> from_x_;
+    std::vector<float> from_y_;
+    std::vector<float> to_x_;
+    std::vector<float> to_y_;
+    std::vector<float> distance_sq_;
+    std::vector<float> dir_x_;
+    std::vector<float> dir_y_;
+
+public:
+    std::size_t size() const noexcept { return from_x_.size(); }
+    bool empty() const noexcept { return from_x_.empty(); }
+
+    void clear() noexcept {
+        from_x_.clear();
+        from_y_.clear();
+        to_x_.clear();
+        to_y_.clear();
+    }
+
+    std::size_t push(float from_x, float from_y, float to_x, float to_y) {
+        from_x_.push_back(from_x);
+        from_y_.push_back(from_y);
+        to_x_.push_back(to_x);
+        to_y_.push_back(to_y);
+        return from_x_.size() - 1;
+    }
+
+    float distance_sq(std::size_t i) const noexcept { return distance_sq_[i]; }
+    float dir_x(std::size_t i) const noexcept { return dir_x_[i]; }
+    float dir_y(std::size_t i) const noexcept { return dir_y_[i]; }
+    float to_x(std::size_t i) const noexcept { return to_x_[i]; }
+    float to_y(std::size_t i) const noexcept { return to_y_[i]; }
+
+    /**
+     * @brief Computes squared distances and unit directions for every pushed pair
+     *
+     * Pairs at the same position get a zero direction.
+     */
+    void compute() {
+        const std::size_t count = size();
+        distance_sq_.resize(count);
+        dir_x_.resize(count);
+        dir_y_.resize(count);
+
+        std::size_t i = 0;
+
+#ifdef DEMO_SENSING_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&to_x_[i]), _mm_loadu_ps(&from_x_[i]));
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&to_y_[i]), _mm_loadu_ps(&from_y_[i]));
+            const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+            const __m128 nonzero = _mm_cmpgt_ps(d2, zero);
+            const __m128 inv = _mm_and_ps(nonzero, _mm_div_ps(one, _mm_sqrt_ps(d2)));
+
+            _mm_storeu_ps(&distance_sq_[i], d2);
+            _mm_storeu_ps(&dir_x_[i], _mm_mul_ps(dx, inv));
+            _mm_storeu_ps(&dir_y_[i], _mm_mul_ps(dy, inv));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const float dx = to_x_[i] - from_x_[i];
+            const float dy = to_y_[i] - from_y_[i];
+            const float d2 = dx * dx + dy * dy;
+            const float inv = d2 > 0.0f ? 1.0f / std::sqrt(d2) : 0.0f;
+
+            distance_sq_[i] = d2;
+            dir_x_[i] = dx * inv;
+            dir_y_[i] = dy * inv;
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_SENSING_HPP
@@ -0,0 +1,109 @@
+#ifndef DEMO_SIMULATION_LOD_HPP
+#define DEMO_SIMULATION_LOD_HPP
+
+#include "ecs/lod.hpp"
+#include "ecs/system.hpp"
+#include "components.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Distance-based level of detail for a system's entities
+ *
+ * Tracks every entity of a system in LodBuckets keyed by the squared
+ * distance from its Position to the nearest point of interest (usually the
+ * players). Entities are reclassified right after they are updated, so a
+ * far entity notices an approaching player within one of its own intervals.
+ * With no points of interest every entity lands in the coarsest level.
+ */
+class SimulationLod {
+    game::ecs::LodBuckets buckets_;
+    std::vector<Position> points_of_interest_;
+    std::vector<std::pair<game::ecs::EntityID, float>> due_;
+    bool enabled_{false};
+
+public:
+    bool is_enabled() const noexcept { return enabled_; }
+    const game::ecs::LodBuckets& get_buckets() const noexcept { return buckets_; }
+
+    void enable(game::ecs::System& system, std::vector<game::ecs::LodLevel> levels) {
+        buckets_.clear();
+        buckets_.set_levels(std::move(levels));
+        for (const auto& [id, _] : system.get_entities()) {
+            buckets_.assign(id, 0.0f);
+        }
+        enabled_ = true;
+    }
+
+    void disable() noexcept {
+        buckets_.clear();
+        enabled_ = false;
+    }
+
+    void set_points_of_interest(std::vector<Position> points) {
+        points_of_interest_ = std::move(points);
+    }
+
+    float nearest_distance_sq(const Position& pos) const noexcept {
+        float best = std::numeric_limits<float>::max();
+        for (const auto& point : points_of_interest_) {
+            const float dx = point.x - pos.x;
+            const float dy = point.y - pos.y;
+            best = std::min(best, dx * dx + dy * dy);
+        }
+        return best;
+    }
+
+    void track(const game::ecs::EntityID id) {
+        if (enabled_) {
+            buckets_.assign(id, 0.0f);
+        }
+    }
+
+    void untrack(const game::ecs::EntityID id) {
+        if (enabled_) {
+            buckets_.remove(id);
+        }
+    }
+
+    /**
+     * @brief Runs `fn(id, entity, elapsed)` for the entities due this tick, then reclassifies them
+     */
+    template<typename Fn>
+    void update(game::ecs::System& system, const float delta, Fn&& fn) {
+        buckets_.advance(delta);
+
+        due_.clear();
+        buckets_.for_each_due([this](const game::ecs::EntityID id, const float elapsed) {
+            due_.emplace_back(id, elapsed);
+        });
+
+        for (const auto& [id, elapsed] : due_) {
+            auto* entity = system.get_entity(id);
+            if (entity) {
+                fn(id, *entity, elapsed);
+            }
+        }
+
+        for (const auto& due : due_) {
+            const auto id = due.first;
+            game::ecs::Entity* entity = system.get_entity(id);
+            if (!entity) {
+                continue;
+            }
+
+            const auto* pos = entity->get_component<Position>();
+            if (pos) {
+                buckets_.assign(id, nearest_distance_sq(*pos));
+            }
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_SIMULATION_LOD_HPP
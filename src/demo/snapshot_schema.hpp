@@ -0,0 +1,93 @@
+#ifndef DEMO_SNAPSHOT_SCHEMA_HPP
+#define DEMO_SNAPSHOT_SCHEMA_HPP
+
+#include "ecs/snapshot.hpp"
+#include "components.hpp"
+#include "systems.hpp"
+#include <cstdint>
+#include <string>
+
+namespace demo {
+
+/**
+ * @brief Snapshot schema covering every demo system and component
+ *
+ * Navigation only saves its destination and speed; the path in progress is
+ * requested again after loading.
+ */
+inline game::ecs::SnapshotSchema make_snapshot_schema() {
+    game::ecs::SnapshotSchema schema;
+
+    schema.add_system<MovementSystem>("movement");
+    schema.add_system<RenderSystem>("render");
+    schema.add_system<HealthSystem>("health");
+    schema.add_system<AISystem>("ai");
+    schema.add_system<TimerSystem>("timer");
+    schema.add_system<NavigationSystem>("navigation");
+
+    schema.add_component<Position>();
+
+    schema.add_component<Velocity>();
+
+    schema.add_component<Health>();
+
+    schema.add_component<Renderable>("renderable")
+        .field("symbol", &Renderable::symbol)
+        .field("visible", &Renderable::visible)
+        .custom("color", 1,
+            [](const Renderable& renderable, game::ecs::SnapshotWriter& out) { out.write_string(renderable.color); },
+            [](Renderable& renderable, game::ecs::SnapshotReader& in) { return in.read_string(renderable.color); });
+
+    schema.add_component<Name>("name")
+        .custom("name", 1,
+            [](const Name& name, game::ecs::SnapshotWriter& out) { out.write_string(name.name); },
+            [](Name& name, game::ecs::SnapshotReader& in) { return in.read_string(name.name); });
+
+    schema.add_component<AI>("ai")
+        .field("current_state", &AI::current_state)
+        .field("target_entity_id", &AI::target_entity_id)
+        .field("current_patrol_index", &AI::current_patrol_index)
+        .field("detection_range", &AI::detection_range)
+        .custom("patrol_points", 1,
+            [](const AI& ai, game::ecs::SnapshotWriter& out) {
+                out.write(static_cast<std::uint32_t>(ai.patrol_points.size()));
+                for (const auto& point : ai.patrol_points) {
+                    out.write(point.x);
+                    out.write(point.y);
+                }
+            },
+            [](AI& ai, game::ecs::SnapshotReader& in) {
+                std::uint32_t count = 0;
+                if (!in.read(count)) {
+                    return false;
+                }
+                ai.patrol_points.clear();
+                for (std::uint32_t i = 0; i < count; ++i) {
+                    float x = 0.0f;
+                    float y = 0.0f;
+                    if (!in.read(x) || !in.read(y)) {
+                        return false;
+                    }
+                    ai.patrol_points.emplace_back(x, y);
+                }
+                return true;
+            })
+        .validate([](const AI& ai) {
+            return ai.current_state >= AI::State::Idle && ai.current_state <= AI::State::Attacking &&
+                   (ai.patrol_points.empty() || ai.current_patrol_index < ai.patrol_points.size());
+        });
+
+    schema.add_component<Timer>();
+
+    schema.add_component<Navigation>("navigation")
+        .field("destination_x", &Navigation::destination_x)
+        .field("destination_y", &Navigation::destination_y)
+        .field("has_destination", &Navigation::has_destination)
+        .field("speed", &Navigation::speed);
+
+    return schema;
+}
+
+} // namespace demo
+
+#endif // DEMO_SNAPSHOT_SCHEMA_HPP
@@ -0,0 +1,205 @@
+#ifndef DEMO_SPATIAL_GRID_HPP
+#define DEMO_SPATIAL_GRID_HPP
+
+#include "ecs/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace demo {
+
+/**
+ * @brief Cell-sorted point set for radius queries, rebuilt from scratch each tick
+ *
+ * Points are bucketed by hashing their (unbounded) cell coordinates into a
+ * power-of-two table and then counting-sorted by bucket, so every bucket's
+ * points are contiguous together with a copy of their positions. build() is
+ * split into chunks that run on a ThreadPool: each chunk counts its own
+ * points per bucket, the per-chunk counts are turned into write offsets in
+ * parallel over bucket ranges, and each chunk then scatters its points. The
+ * sort is stable, so bucket contents follow the input order.
+ */
+class SpatialGrid {
+    float cell_size_;
+    float inv_cell_size_;
+    std::uint32_t bucket_count_{0};
+    std::size_t chunk_count_{0};
+    std::size_t chunk_size_{0};
+
+    std::vector<std::uint32_t> bucket_of_;
+    std::vector<std::uint64_t> cell_of_;
+    std::vector<std::uint32_t> counts_; // chunk_count_ rows of bucket_count_ entries
+    std::vector<std::uint32_t> start_;
+    std::vector<std::uint32_t> sorted_;
+    std::vector<std::uint64_t> sorted_cell_;
+    std::vector<float> sorted_x_;
+    std::vector<float> sorted_y_;
+
+public:
+    explicit SpatialGrid(float cell_size = 2.0f)
+        : cell_size_(cell_size)
+        , inv_cell_size_(1.0f / cell_size) {}
+
+    float get_cell_size() const noexcept { return cell_size_; }
+
+    void set_cell_size(float cell_size) noexcept {
+        cell_size_ = cell_size;
+        inv_cell_size_ = 1.0f / cell_size;
+    }
+
+    std::size_t size() const noexcept { return sorted_.size(); }
+
+    /**
+     * @brief Point indices in bucket order; queries made in this order touch far fewer cache lines
+     */
+    const std::vector<std::uint32_t>& get_order() const noexcept { return sorted_; }
+
+    /**
+     * @brief Sorts `count` points given as separate x and y arrays into the grid
+     */
+    void build(const float* xs, const float* ys, const std::size_t count, game::ecs::ThreadPool* pool = nullptr) {
+        bucket_count_ = 64;
+        while (bucket_count_ < count) {
+            bucket_count_ <<= 1;
+        }
+
+        const std::size_t min_chunk = 4096;
+        const std::size_t workers = pool ? pool->size() + 1 : 1;
+        chunk_count_ = std::max<std::size_t>(1, std::min(workers, (count + min_chunk - 1) / min_chunk));
+        chunk_size_ = (count + chunk_count_ - 1) / chunk_count_;
+
+        bucket_of_.resize(count);
+        cell_of_.resize(count);
+        counts_.resize(chunk_count_ * bucket_count_);
+        start_.resize(bucket_count_ + 1);
+        sorted_.resize(count);
+        sorted_cell_.resize(count);
+        sorted_x_.resize(count);
+        sorted_y_.resize(count);
+
+        const auto mask = bucket_count_ - 1;
+
+        // Count points per bucket within each chunk
+        run(pool, chunk_count_, 1, [&](std::size_t begin, std::size_t end) {
+            for (auto chunk = begin; chunk < end; ++chunk) {
+                auto* counts = &counts_[chunk * bucket_count_];
+                std::fill(counts, counts + bucket_count_, 0u);
+
+                const auto last = std::min(count, (chunk + 1) * chunk_size_);
+                for (auto i = chunk * chunk_size_; i < last; ++i) {
+                    const auto cx = cell_coord(xs[i]);
+                    const auto cy = cell_coord(ys[i]);
+                    cell_of_[i] = pack(cx, cy);
+                    bucket_of_[i] = hash(cx, cy) & mask;
+                    ++counts[bucket_of_[i]];
+                }
+            }
+        });
+
+        // Turn the per-chunk counts into each chunk's offset within its bucket
+        run(pool, bucket_count_, 16384, [&](std::size_t begin, std::size_t end) {
+            for (auto bucket = begin; bucket < end; ++bucket) {
+                std::uint32_t running = 0;
+                for (std::size_t chunk = 0; chunk < chunk_count_; ++chunk) {
+                    auto& entry = counts_[chunk * bucket_count_ + bucket];
+                    const auto chunk_count = entry;
+                    entry = running;
+                    running += chunk_count;
+                }
+                start_[bucket + 1] = running;
+            }
+        });
+
+        start_[0] = 0;
+        for (std::uint32_t bucket = 0; bucket < bucket_count_; ++bucket) {
+            start_[bucket + 1] += start_[bucket];
+        }
+
+        // Scatter every chunk's points into their buckets
+        run(pool, chunk_count_, 1, [&](std::size_t begin, std::size_t end) {
+            for (auto chunk = begin; chunk < end; ++chunk) {
+                auto* offsets = &counts_[chunk * bucket_count_];
+                const auto last = std::min(count, (chunk + 1) * chunk_size_);
+                for (auto i = chunk * chunk_size_; i < last; ++i) {
+                    const auto bucket = bucket_of_[i];
+                    const auto slot = start_[bucket] + offsets[bucket]++;
+                    sorted_[slot] = static_cast<std::uint32_t>(i);
+                    sorted_cell_[slot] = cell_of_[i];
+                    sorted_x_[slot] = xs[i];
+                    sorted_y_[slot] = ys[i];
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Calls `fn(index, dx, dy, distance_sq)` for each point within `radius` of (x, y)
+     *
+     * `index` is the point's position in the arrays given to build() and
+     * (dx, dy) is its offset from the query position. `fn` returns false to
+     * stop the query early.
+     */
+    template<typename Fn>
+    void for_each_near(const float x, const float y, const float radius, Fn&& fn) const {
+        if (sorted_.empty()) {
+            return;
+        }
+
+        const auto mask = bucket_count_ - 1;
+        const float radius_sq = radius * radius;
+        const auto min_x = cell_coord(x - radius);
+        const auto max_x = cell_coord(x + radius);
+        const auto min_y = cell_coord(y - radius);
+        const auto max_y = cell_coord(y + radius);
+
+        for (auto cy = min_y; cy <= max_y; ++cy) {
+            for (auto cx = min_x; cx <= max_x; ++cx) {
+                const auto bucket = hash(cx, cy) & mask;
+                const auto cell = pack(cx, cy);
+
+                for (auto slot = start_[bucket]; slot < start_[bucket + 1]; ++slot) {
+                    // Other cells can share the bucket; skip them so no point is visited twice
+                    if (sorted_cell_[slot] != cell) {
+                        continue;
+                    }
+
+                    const float dx = sorted_x_[slot] - x;
+                    const float dy = sorted_y_[slot] - y;
+                    const float distance_sq = dx * dx + dy * dy;
+                    if (distance_sq <= radius_sq && !fn(sorted_[slot], dx, dy, distance_sq)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    std::int32_t cell_coord(const float value) const noexcept {
+        return static_cast<std::int32_t>(std::floor(value * inv_cell_size_));
+    }
+
+    static std::uint64_t pack(const std::int32_t cx, const std::int32_t cy) noexcept {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+    }
+
+    static std::uint32_t hash(const std::int32_t cx, const std::int32_t cy) noexcept {
+        return (static_cast<std::uint32_t>(cx) * 73856093u) ^ (static_cast<std::uint32_t>(cy) * 19349663u);
+    }
+
+    template<typename Fn>
+    static void run(game::ecs::ThreadPool* pool, const std::size_t count, const std::size_t grain, Fn&& fn) {
+        if (pool) {
+            pool->parallel_for(count, grain, std::forward<Fn>(fn));
+        } else if (count > 0) {
+            fn(std::size_t{0}, count);
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_SPATIAL_GRID_HPP
@@ -0,0 +1,63 @@
+#ifndef DEMO_STATIC_SYSTEMS_HPP
+#define DEMO_STATIC_SYSTEMS_HPP
+
+#include "ecs/registry.hpp"
+#include "ecs/system_base.hpp"
+#include "components.hpp"
+#include <algorithm>
+
+namespace demo {
+
+/**
+ * @brief Registry holding the components used by the static demo systems
+ */
+using StaticRegistry = game::ecs::Registry<Position, Velocity, Health, Timer>;
+
+/**
+ * @brief MovementSystem as a per-entity update over a StaticRegistry
+ */
+class StaticMovementSystem : public game::ecs::SystemBase<StaticMovementSystem> {
+public:
+    void update(const float delta, Position& pos, const Velocity& vel) noexcept {
+        pos.x += vel.dx * delta;
+        pos.y += vel.dy * delta;
+    }
+};
+
+/**
+ * @brief TimerSystem as a per-entity update; finished auto-remove timers remove their entity
+ */
+class StaticTimerSystem : public game::ecs::SystemBase<StaticTimerSystem> {
+public:
+    void update(const float delta, const game::ecs::EntityID id, Timer& timer) {
+        timer.elapsed_time += delta;
+        if (timer.is_finished() && timer.auto_remove) {
+            destroy_later(id);
+        }
+    }
+};
+
+/**
+ * @brief HealthSystem as a per-entity update; dead entities are removed
+ */
+class StaticHealthSystem : public game::ecs::SystemBase<StaticHealthSystem> {
+    float health_regen_rate_ = 1.0f; // HP per second
+
+public:
+    void update(const float delta, const game::ecs::EntityID id, Health& health) {
+        if (health.current_health < health.max_health && health.current_health > 0) {
+            health.current_health = std::min(
+                health.max_health,
+                health.current_health + static_cast<int>(health_regen_rate_ * delta)
+            );
+        }
+
+        if (!health.is_alive()) {
+            destroy_later(id);
+        }
+    }
+};
+
+} // namespace demo
+
+#endif // DEMO_STATIC_SYSTEMS_HPP
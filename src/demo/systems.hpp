@@ -1,32 +1,126 @@
 #ifndef DEMO_SYSTEMS_HPP
 #define DEMO_SYSTEMS_HPP
 
+#include "ecs/behaviour.hpp"
+#include "ecs/budget.hpp"
+#include "ecs/sleep.hpp"
+#include "ecs/state_buckets.hpp"
 #include "ecs/system.hpp"
 #include "components.hpp"
+#include "crowd.hpp"
+#include "flow_field.hpp"
+#include "pathfinding.hpp"
+#include "sensing.hpp"
+#include "simulation_lod.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <typeindex>
 
 namespace demo {
 
+/**
+ * @brief Sets a velocity held through a cached pointer, reporting the write only if it changes
+ */
+inline void set_velocity(game::ecs::Entity& entity, Velocity* vel, float dx, float dy) {
+    if (vel->dx != dx || vel->dy != dy) {
+        vel->dx = dx;
+        vel->dy = dy;
+        entity.mark_written<Velocity>();
+    }
+}
+
 /**
  * @brief Handles entity movement based on position and velocity
  * 
  * This system processes all entities that have both Position and Velocity components,
  * updating their positions each frame. Demonstrates basic component querying.
+ * With level of detail enabled, entities far from every point of interest are
+ * moved less often using the time they have accumulated. With sleeping
+ * enabled, entities without velocity are skipped until they are woken.
  */
 class MovementSystem : public game::ecs::System {
+    SimulationLod lod_;
+    game::ecs::SleepSet sleep_;
+    bool sleeping_enabled_{false};
+
 public:
-    void tick(const float& delta) noexcept override {
-        for (auto& [id, entity] : get_entities()) {
-            auto* pos = entity->get_component<Position>();
-            auto* vel = entity->get_component<Velocity>();
-            
-            if (pos && vel) {
-                pos->x += vel->dx * delta;
-                pos->y += vel->dy * delta;
+    SimulationLod& get_lod() noexcept { return lod_; }
+    const game::ecs::SleepSet& get_sleep_set() const noexcept { return sleep_; }
+
+    void enable_sleeping() {
+        if (sleeping_enabled_) {
+            return;
+        }
+
+        sleep_.clear();
+        for (const auto& [id, _] : get_entities()) {
+            sleep_.track(id);
+        }
+        attach_observer(&sleep_);
+        sleeping_enabled_ = true;
+    }
+
+    /**
+     * @brief Wakes sleeping entities within `radius` of `center`
+     */
+    std::size_t wake_near(const Position& center, float radius) {
+        const float radius_sq = radius * radius;
+        return sleep_.wake_if([this, &center, radius_sq](game::ecs::EntityID id) {
+            const auto* entity = get_entity(id);
+            const auto* pos = entity ? entity->get_component<Position>() : nullptr;
+            if (!pos) {
+                return false;
             }
+            const float dx = pos->x - center.x;
+            const float dy = pos->y - center.y;
+            return dx * dx + dy * dy <= radius_sq;
+        });
+    }
+
+    void tick(const float& delta) noexcept override {
+        if (lod_.is_enabled()) {
+            lod_.update(*this, delta, [](game::ecs::EntityID, game::ecs::Entity& entity, float elapsed) {
+                move(entity, elapsed);
+            });
+            return;
         }
+
+        if (sleeping_enabled_) {
+            sleep_.update_awake([this, delta](game::ecs::EntityID id) {
+                auto* entity = get_entity(id);
+                return entity && move(*entity, delta);
+            });
+            return;
+        }
+
+        for_each_entity([delta](game::ecs::EntityID, game::ecs::Entity& entity) {
+            move(entity, delta);
+        });
+    }
+
+protected:
+    void on_entity_added(game::ecs::Entity& entity) noexcept override {
+        lod_.track(entity.get_id());
+    }
+
+    void on_entity_removed(const game::ecs::EntityID id) noexcept override {
+        lod_.untrack(id);
+    }
+
+private:
+    // Returns whether the entity is still moving
+    static bool move(game::ecs::Entity& entity, float delta) {
+        auto* pos = entity.get_component<Position>();
+        auto* vel = entity.get_component<Velocity>();
+        
+        if (pos && vel && (vel->dx != 0.0f || vel->dy != 0.0f)) {
+            pos->x += vel->dx * delta;
+            pos->y += vel->dy * delta;
+            entity.mark_written<Position>(); // Lets change trackers pick up the move
+            return true;
+        }
+        return false;
     }
 };
 
@@ -94,7 +188,8 @@ public:
  * @brief Manages entity health and death
  * 
  * This system processes entities with Health components, handling health
- * regeneration and entity removal when health reaches zero.
+ * regeneration and entity removal when health reaches zero. Regeneration
+ * doesn't need to run every frame, so the system honours update slicing.
  */
 class HealthSystem : public game::ecs::System {
     float health_regen_rate_ = 1.0f; // HP per second
@@ -103,16 +198,21 @@ public:
     void tick(const float& delta) noexcept override {
         std::vector<game::ecs::EntityID> entities_to_remove;
         
-        for (auto& [id, entity] : get_entities()) {
-            auto* health = entity->get_component<Health>();
+        for_each_slice_entity([&](game::ecs::EntityID id, game::ecs::Entity& entity) {
+            auto* health = entity.get_component<Health>();
             
             if (health) {
                 // Health regeneration (if not at max)
                 if (health->current_health < health->max_health && health->current_health > 0) {
-                    health->current_health = std::min(
+                    const int regenerated = std::min(
                         health->max_health,
                         health->current_health + static_cast<int>(health_regen_rate_ * delta)
                     );
+                    // Short ticks regenerate less than one point; don't report those
+                    if (regenerated != health->current_health) {
+                        health->current_health = regenerated;
+                        entity.mark_written<Health>();
+                    }
                 }
                 
                 // Mark dead entities for removal
@@ -120,7 +220,7 @@ public:
                     entities_to_remove.push_back(id);
                 }
             }
-        }
+        });
         
         // Remove dead entities
         for (auto entity_id : entities_to_remove) {
@@ -136,53 +236,670 @@ public:
     }
 };
 
+/**
+ * @brief Requests, follows and releases grid paths for Navigation components
+ *
+ * Shared by every system that steers entities along paths from a
+ * PathfindingService. Requests nobody will poll, because the entity or its
+ * Navigation was removed or the destination changed, must be released so
+ * the service doesn't keep them forever.
+ */
+class PathFollower {
+    PathfindingService* pathfinding_;
+
+public:
+    explicit PathFollower(PathfindingService* pathfinding = nullptr) noexcept : pathfinding_(pathfinding) {}
+
+    PathfindingService* get_service() const noexcept { return pathfinding_; }
+    void set_service(PathfindingService* pathfinding) noexcept { pathfinding_ = pathfinding; }
+
+    /**
+     * @brief Releases the request a destination change left behind; returns whether there was one
+     */
+    bool release_abandoned(Navigation* nav) {
+        if (!pathfinding_ || nav->abandoned_request_id == 0) {
+            return false;
+        }
+        pathfinding_->release(nav->abandoned_request_id);
+        nav->abandoned_request_id = 0;
+        return true;
+    }
+
+    /**
+     * @brief Drops every request the entity will never poll, so the service can forget them
+     */
+    void release(Navigation* nav) noexcept {
+        if (!nav || !pathfinding_) {
+            return;
+        }
+        
+        for (auto* id : {&nav->request_id, &nav->abandoned_request_id}) {
+            if (*id != 0) {
+                pathfinding_->release(*id);
+                *id = 0;
+            }
+        }
+    }
+    
+    /**
+     * @brief Moves a navigating entity one tick along its path, requesting the path first if needed
+     *
+     * Returns whether the Navigation changed; Velocity writes are reported as
+     * they happen. With `deterministic` set, paths are searched on the
+     * calling thread so they arrive on the same tick in every run.
+     */
+    bool follow(game::ecs::Entity& entity, Navigation* nav, Position* pos, Velocity* vel, bool deterministic) {
+        bool changed = false;
+        
+        if (!nav->path) {
+            set_velocity(entity, vel, 0.0f, 0.0f);
+            
+            if (nav->request_id == 0) {
+                changed = true;
+                if (!deterministic) {
+                    nav->request_id = pathfinding_->request(pos->x, pos->y, nav->destination_x, nav->destination_y);
+                    return true;
+                }
+                // Worker timing would decide the tick the path arrives on
+                nav->request_id = pathfinding_->request_now(pos->x, pos->y, nav->destination_x, nav->destination_y);
+            }
+            
+            const auto result = pathfinding_->poll(nav->request_id);
+            if (result.status == PathStatus::Pending) {
+                return changed;
+            }
+            
+            pathfinding_->release(nav->request_id);
+            nav->request_id = 0;
+            
+            if (result.status != PathStatus::Ready) {
+                nav->has_destination = false;
+                return true;
+            }
+            
+            nav->path = result.path;
+            nav->waypoint = result.offset;
+            changed = true;
+        }
+        
+        const auto grid = pathfinding_->get_grid();
+        const auto& cells = nav->path->cells;
+        
+        while (nav->waypoint < cells.size()) {
+            const bool last = nav->waypoint + 1 == cells.size();
+            const float target_x = last ? nav->destination_x : grid->center_x(cells[nav->waypoint]);
+            const float target_y = last ? nav->destination_y : grid->center_y(cells[nav->waypoint]);
+            float dx = target_x - pos->x;
+            float dy = target_y - pos->y;
+            float distance = std::sqrt(dx * dx + dy * dy);
+            
+            if (distance < grid->cell_size() * 0.5f) {
+                ++nav->waypoint;
+                changed = true;
+                continue;
+            }
+            
+            set_velocity(entity, vel, (dx / distance) * nav->speed, (dy / distance) * nav->speed);
+            return changed;
+        }
+        
+        // Arrived
+        set_velocity(entity, vel, 0.0f, 0.0f);
+        nav->has_destination = false;
+        nav->path.reset();
+        return true;
+    }
+};
+
 /**
  * @brief Simple AI system for autonomous entity behavior
  * 
  * This system processes entities with AI components, implementing basic
- * state machine behavior. Demonstrates more complex system logic.
+ * state machine behavior. Demonstrates more complex system logic. Decision
+ * making can be spread over several ticks with an UpdateSchedule. With
+ * sleeping enabled, idle entities with nowhere to patrol are skipped until
+ * their AI is written to. Target acquisition scans every potential target
+ * per AI, so it runs time-sliced within a per-tick budget. Entities can also
+ * run coroutine behaviours, which replace the state machine while active.
+ *
+ * Entities are kept bucketed by AI state with cached component pointers, so
+ * each state handler runs over a homogeneous batch instead of switching per
+ * entity. State changes made by a handler are applied as bucket moves after
+ * the pass. Patrolling, chasing and attacking agents first gather their
+ * target positions into a SensingBatch so distances and directions for the
+ * whole bucket are computed by one SIMD kernel. With a FlowFieldCache set,
+ * chasers of a popular target steer along its shared flow field instead of
+ * heading straight for it. With a PathfindingService set, chasers and
+ * patrollers that have a Navigation component follow grid paths from the
+ * service instead, and head straight for the goal only once they arrive or
+ * no path exists. With crowd steering enabled, the velocities set
+ * by a full bucketed pass are then adjusted so nearby agents keep apart.
+ * Every AI, Velocity and target Health the passes change through cached
+ * pointers is reported with mark_written(), so change tracking, checksums
+ * and logs see them.
  */
 class AISystem : public game::ecs::System {
+    struct Target {
+        game::ecs::EntityID id;
+        const Position* pos;
+    };
+
+    struct Agent {
+        AI* ai;
+        Position* pos;
+        Velocity* vel;
+        game::ecs::Entity* entity;
+    };
+
+    struct SensedTarget {
+        game::ecs::Entity* entity;
+        Health* health;
+    };
+
+    game::ecs::StateBuckets<AI::State, 4, Agent> states_;
+    SensingBatch sensing_;
+    std::vector<std::size_t> sensed_agents_;
+    std::vector<SensedTarget> sensed_targets_;
+    SimulationLod lod_;
+    game::ecs::SleepSet sleep_;
+    bool sleeping_enabled_{false};
+    game::ecs::BudgetedCursor acquisition_;
+    std::vector<Target> targets_;
+    std::vector<game::ecs::Entity*> steered_;
+    bool acquisition_enabled_{false};
+    game::ecs::BehaviourScheduler behaviours_;
+    FlowFieldCache* flow_fields_{nullptr};
+    PathFollower paths_;
+    CrowdSteering crowd_;
+    bool crowd_enabled_{false};
+
 public:
+    SimulationLod& get_lod() noexcept { return lod_; }
+    game::ecs::SleepSet& get_sleep_set() noexcept { return sleep_; }
+
+    /**
+     * @brief Shares flow fields between chasers of the same target; pass nullptr to disable
+     */
+    void set_flow_fields(FlowFieldCache* flow_fields) noexcept { flow_fields_ = flow_fields; }
+
+    /**
+     * @brief Routes chasers and patrollers with a Navigation component along grid paths; pass nullptr to disable
+     */
+    void set_pathfinding(PathfindingService* pathfinding) {
+        if (pathfinding == paths_.get_service()) {
+            return;
+        }
+
+        // Requests and paths belong to the previous service
+        for_each_entity([this](game::ecs::EntityID, game::ecs::Entity& entity) {
+            if (auto* nav = entity.get_component<Navigation>()) {
+                paths_.release(nav);
+                nav->has_destination = false;
+                nav->path.reset();
+                entity.mark_written<Navigation>();
+            }
+        });
+        paths_.set_service(pathfinding);
+    }
+
+    const CrowdSteering& get_crowd() const noexcept { return crowd_; }
+
+    /**
+     * @brief Keeps agents from stacking up; runs on the bucketed pass, not with LOD or sleeping
+     */
+    void enable_crowd_steering(const CrowdParams& params, game::ecs::ThreadPool* pool = nullptr) {
+        crowd_.set_params(params);
+        crowd_.set_pool(pool);
+        crowd_enabled_ = true;
+    }
+
+    void disable_crowd_steering() noexcept {
+        crowd_enabled_ = false;
+        crowd_.reset();
+    }
+    const game::ecs::BudgetedCursor& get_target_acquisition() const noexcept { return acquisition_; }
+    game::ecs::BehaviourScheduler& get_behaviours() noexcept { return behaviours_; }
+
+    /**
+     * @brief Runs a coroutine behaviour for an entity until it finishes or the entity is removed
+     */
+    game::ecs::BehaviourHandle run_behaviour(game::ecs::EntityID id, game::ecs::Behaviour&& behaviour) {
+        if (!has_entity(id)) {
+            return {};
+        }
+        return behaviours_.spawn(std::move(behaviour), id);
+    }
+
+    /**
+     * @brief Lets idle and patrolling AIs pick the nearest living non-AI entity in range
+     */
+    void enable_target_acquisition(const game::ecs::TimeBudget& budget) {
+        acquisition_.set_budget(budget);
+        acquisition_.reset();
+        acquisition_enabled_ = true;
+    }
+
+    void enable_sleeping() {
+        if (sleeping_enabled_) {
+            return;
+        }
+
+        sleep_.clear();
+        for (const auto& [id, _] : get_entities()) {
+            sleep_.track(id);
+        }
+        attach_observer(&sleep_);
+        sleeping_enabled_ = true;
+    }
+
     void tick(const float& delta) noexcept override {
-        for (auto& [id, entity] : get_entities()) {
-            auto* ai = entity->get_component<AI>();
-            auto* pos = entity->get_component<Position>();
-            auto* vel = entity->get_component<Velocity>();
-            
-            if (ai && pos && vel) {
-                switch (ai->current_state) {
-                    case AI::State::Idle:
-                        handleIdleState(ai, pos, vel, delta);
-                        break;
-                    case AI::State::Patrolling:
-                        handlePatrolState(ai, pos, vel, delta);
-                        break;
-                    case AI::State::Chasing:
-                        handleChaseState(ai, pos, vel, delta, id);
-                        break;
-                    case AI::State::Attacking:
-                        handleAttackState(ai, pos, vel, delta, id);
-                        break;
+        behaviours_.tick(delta);
+
+        if (acquisition_enabled_) {
+            acquire_targets(delta);
+        }
+
+        if (flow_fields_) {
+            update_flow_fields();
+        }
+
+        if (lod_.is_enabled()) {
+            lod_.update(*this, delta, [this](game::ecs::EntityID id, game::ecs::Entity& entity, float elapsed) {
+                think(id, entity, elapsed);
+            });
+            states_.apply_transitions();
+            return;
+        }
+
+        if (sleeping_enabled_) {
+            sleep_.update_awake([this, delta](game::ecs::EntityID id) {
+                auto* entity = get_entity(id);
+                if (!entity) {
+                    return false;
                 }
-            }
+
+                think(id, *entity, delta);
+                const auto* ai = entity->get_component<AI>();
+                return ai && !(ai->current_state == AI::State::Idle && ai->patrol_points.empty());
+            });
+            states_.apply_transitions();
+            return;
+        }
+
+        run_bucket<AI::State::Idle>(delta);
+        run_bucket<AI::State::Patrolling>(delta);
+        run_bucket<AI::State::Chasing>(delta);
+        run_bucket<AI::State::Attacking>(delta);
+
+        if (crowd_enabled_) {
+            steer_crowd();
+        }
+        states_.apply_transitions();
+    }
+
+    const game::ecs::StateBuckets<AI::State, 4, Agent>& get_state_buckets() const noexcept { return states_; }
+
+protected:
+    void on_entity_added(game::ecs::Entity& entity) noexcept override {
+        lod_.track(entity.get_id());
+    }
+
+    void on_entity_removed(const game::ecs::EntityID id) noexcept override {
+        lod_.untrack(id);
+        states_.erase(id);
+        behaviours_.cancel_owned_by(id);
+        paths_.release(get_entity(id)->get_component<Navigation>());
+    }
+
+    void on_component_added(game::ecs::Entity& entity, const std::type_index&) noexcept override {
+        auto* ai = entity.get_component<AI>();
+        auto* pos = entity.get_component<Position>();
+        auto* vel = entity.get_component<Velocity>();
+
+        if (ai && pos && vel) {
+            states_.insert(entity.get_id(), ai->current_state, Agent{ai, pos, vel, &entity});
+        }
+    }
+
+    void on_component_removed(game::ecs::Entity& entity, const std::type_index& type) noexcept override {
+        if (type == typeid(AI) || type == typeid(Position) || type == typeid(Velocity)) {
+            states_.erase(entity.get_id());
+        } else if (type == typeid(Navigation)) {
+            paths_.release(entity.get_component<Navigation>());
         }
     }
     
 private:
-    void handleIdleState(AI* ai, Position* pos, Velocity* vel, float delta) {
+    void acquire_targets(float delta) {
+        targets_.clear();
+        // Ties between equally close targets go to the first one listed, so list them in a stable order
+        for_each_entity([this](game::ecs::EntityID id, game::ecs::Entity& entity) {
+            if (entity.has_component<AI>()) {
+                return;
+            }
+
+            const auto* pos = entity.get_component<Position>();
+            const auto* health = entity.get_component<Health>();
+            if (pos && health && health->is_alive()) {
+                targets_.push_back({id, pos});
+            }
+        });
+
+        if (targets_.empty()) {
+            return;
+        }
+
+        acquisition_.run(*this, delta, [this](game::ecs::EntityID, game::ecs::Entity& entity, float) {
+            const auto* ai = entity.get_component<AI>();
+            const auto* pos = entity.get_component<Position>();
+            if (!ai || !pos || (ai->current_state != AI::State::Idle && ai->current_state != AI::State::Patrolling)) {
+                return;
+            }
+
+            float best_distance_sq = ai->detection_range * ai->detection_range;
+            game::ecs::EntityID best_target = 0;
+            for (const auto& target : targets_) {
+                const float dx = target.pos->x - pos->x;
+                const float dy = target.pos->y - pos->y;
+                const float distance_sq = dx * dx + dy * dy;
+                if (distance_sq <= best_distance_sq) {
+                    best_distance_sq = distance_sq;
+                    best_target = target.id;
+                }
+            }
+
+            if (best_target != 0) {
+                auto* writable = entity.write_component<AI>();
+                writable->target_entity_id = best_target;
+                writable->current_state = AI::State::Chasing;
+            }
+        });
+    }
+
+    void update_flow_fields() {
+        for (const auto& agent : states_.get_items(AI::State::Chasing)) {
+            auto* target = get_entity(agent.ai->target_entity_id);
+            const auto* target_pos = target ? target->get_component<Position>() : nullptr;
+            if (target_pos) {
+                flow_fields_->demand(agent.ai->target_entity_id, target_pos->x, target_pos->y);
+            }
+        }
+        flow_fields_->update();
+    }
+
+    void steer_crowd() {
+        const bool sliced = get_update_schedule().slices > 1;
+        const bool has_behaviours = behaviours_.get_active_count() > 0;
+
+        crowd_.clear();
+        steered_.clear();
+        for (const auto state : {AI::State::Idle, AI::State::Patrolling, AI::State::Chasing, AI::State::Attacking}) {
+            const auto& ids = states_.get_ids(state);
+            const auto& agents = states_.get_items(state);
+
+            for (std::size_t i = 0; i < agents.size(); ++i) {
+                // Agents skipped by this pass still have last tick's steered velocity; leave it alone
+                const bool updated = !(sliced && !in_current_slice(ids[i])) &&
+                                     !(has_behaviours && behaviours_.has_behaviour(ids[i]));
+                crowd_.add(ids[i], *agents[i].pos, agents[i].vel, updated);
+                if (updated) {
+                    steered_.push_back(agents[i].entity);
+                }
+            }
+        }
+        crowd_.step();
+
+        // Steering may run on the pool, so the writes are reported here on the calling thread
+        for (auto* entity : steered_) {
+            entity->mark_written<Velocity>();
+        }
+    }
+
+    template<AI::State S>
+    void run_bucket(float delta) {
+        const auto& ids = states_.get_ids(S);
+        auto& agents = states_.get_items(S);
+        const bool sliced = get_update_schedule().slices > 1;
+        const bool has_behaviours = behaviours_.get_active_count() > 0;
+
+        sensing_.clear();
+        sensed_agents_.clear();
+        sensed_targets_.clear();
+
+        // Gather stage: resolve each agent's target into the sensing batch
+        for (std::size_t i = 0; i < agents.size(); ++i) {
+            const auto id = ids[i];
+            const auto& agent = agents[i];
+
+            if ((sliced && !in_current_slice(id)) || (has_behaviours && behaviours_.has_behaviour(id))) {
+                continue;
+            }
+
+            if (agent.ai->current_state != S) {
+                // State was changed outside of a pass; handle it here and fix up the bucket
+                dispatch(*agent.entity, agent.ai, agent.pos, agent.vel, delta);
+                states_.record_transition(id, agent.ai->current_state);
+                continue;
+            }
+
+            if constexpr (S == AI::State::Idle) {
+                handleIdleState(*agent.entity, agent.ai, agent.pos, agent.vel, delta);
+                if (agent.ai->current_state != S) {
+                    states_.record_transition(id, agent.ai->current_state);
+                }
+            } else {
+                gather<S>(i, agent);
+            }
+        }
+
+        if constexpr (S != AI::State::Idle) {
+            sensing_.compute();
+
+            for (std::size_t k = 0; k < sensed_agents_.size(); ++k) {
+                const auto i = sensed_agents_[k];
+                const auto& agent = agents[i];
+
+                if constexpr (S == AI::State::Patrolling) {
+                    apply_patrol(agent, k);
+                } else if constexpr (S == AI::State::Chasing) {
+                    apply_chase(agent, k);
+                } else {
+                    apply_attack(agent, sensed_targets_[k], k, delta);
+                }
+
+                if (agent.ai->current_state != S) {
+                    states_.record_transition(ids[i], agent.ai->current_state);
+                }
+            }
+        }
+    }
+
+    template<AI::State S>
+    void gather(std::size_t index, const Agent& agent) {
+        const auto id_of_agent = states_.get_ids(S)[index];
+
+        if constexpr (S == AI::State::Patrolling) {
+            if (agent.ai->patrol_points.empty()) {
+                set_state(*agent.entity, agent.ai, AI::State::Idle);
+                states_.record_transition(id_of_agent, AI::State::Idle);
+                return;
+            }
+
+            const auto& point = agent.ai->patrol_points[agent.ai->current_patrol_index];
+            sensing_.push(agent.pos->x, agent.pos->y, point.x, point.y);
+        } else {
+            auto* target = get_entity(agent.ai->target_entity_id);
+            const auto* target_pos = target ? target->get_component<Position>() : nullptr;
+
+            if constexpr (S == AI::State::Attacking) {
+                set_velocity(*agent.entity, agent.vel, 0.0f, 0.0f);
+                if (!target) {
+                    set_state(*agent.entity, agent.ai, AI::State::Idle);
+                    states_.record_transition(id_of_agent, AI::State::Idle);
+                    return;
+                }
+
+                auto* target_health = target->get_component<Health>();
+                if (!target_health || !target_pos) {
+                    return;
+                }
+                sensed_targets_.push_back({target, target_health});
+            } else if (!target_pos) {
+                set_state(*agent.entity, agent.ai, AI::State::Idle);
+                states_.record_transition(id_of_agent, AI::State::Idle);
+                return;
+            }
+
+            sensing_.push(agent.pos->x, agent.pos->y, target_pos->x, target_pos->y);
+        }
+
+        sensed_agents_.push_back(index);
+    }
+
+    void apply_patrol(const Agent& agent, std::size_t k) {
+        if (sensing_.distance_sq(k) < 1.0f) {
+            // Reached patrol point, move to next
+            agent.ai->current_patrol_index = (agent.ai->current_patrol_index + 1) % agent.ai->patrol_points.size();
+            agent.entity->mark_written<AI>();
+        } else {
+            const float speed = 10.0f;
+            if (!steer_along_path(*agent.entity, agent.pos, agent.vel, sensing_.to_x(k), sensing_.to_y(k), speed)) {
+                set_velocity(*agent.entity, agent.vel, sensing_.dir_x(k) * speed, sensing_.dir_y(k) * speed);
+            }
+        }
+    }
+
+    void apply_chase(const Agent& agent, std::size_t k) {
+        const float distance_sq = sensing_.distance_sq(k);
+
+        if (distance_sq > agent.ai->detection_range * agent.ai->detection_range) {
+            // Lost target
+            set_state(*agent.entity, agent.ai, AI::State::Patrolling);
+            set_velocity(*agent.entity, agent.vel, 0.0f, 0.0f);
+        } else if (distance_sq < 4.0f) {
+            // Close enough to attack
+            set_state(*agent.entity, agent.ai, AI::State::Attacking);
+        } else {
+            const float speed = 15.0f;
+            if (steer_along_path(*agent.entity, agent.pos, agent.vel, sensing_.to_x(k), sensing_.to_y(k), speed)) {
+                return;
+            }
+
+            float dir_x = sensing_.dir_x(k);
+            float dir_y = sensing_.dir_y(k);
+            if (flow_fields_) {
+                flow_fields_->sample(agent.ai->target_entity_id, agent.pos->x, agent.pos->y, dir_x, dir_y);
+            }
+            set_velocity(*agent.entity, agent.vel, dir_x * speed, dir_y * speed);
+        }
+    }
+
+    void apply_attack(const Agent& agent, const SensedTarget& target, std::size_t k, float delta) {
+        if (sensing_.distance_sq(k) <= 4.0f) {
+            target.health->current_health -= static_cast<int>(50.0f * delta); // 50 DPS
+            target.entity->mark_written<Health>();
+            if (target.health->current_health <= 0) {
+                set_state(*agent.entity, agent.ai, AI::State::Idle);
+            }
+        } else {
+            // Target moved away, resume chasing
+            set_state(*agent.entity, agent.ai, AI::State::Chasing);
+        }
+    }
+
+    // Steers along a grid path toward (x, y); false if the agent should head straight there
+    bool steer_along_path(game::ecs::Entity& entity, Position* pos, Velocity* vel, float x, float y, float speed) {
+        auto* pathfinding = paths_.get_service();
+        auto* nav = pathfinding ? entity.get_component<Navigation>() : nullptr;
+        if (!nav) {
+            return false;
+        }
+
+        bool changed = paths_.release_abandoned(nav);
+
+        // Moving goals, such as chase targets, are only re-planned once they leave the goal's cell
+        const float repath = pathfinding->get_grid()->cell_size();
+        const float dx = nav->destination_x - x;
+        const float dy = nav->destination_y - y;
+        const bool same_goal = dx * dx + dy * dy < repath * repath;
+
+        // No destination for the same goal means the agent arrived or no path exists
+        const bool follows = nav->has_destination || !same_goal;
+        if (follows) {
+            if (!same_goal) {
+                nav->set_destination(x, y);
+                changed = true;
+            }
+            if (nav->speed != speed) {
+                nav->speed = speed;
+                changed = true;
+            }
+            changed = paths_.follow(entity, nav, pos, vel, is_deterministic()) || changed;
+        }
+
+        if (changed) {
+            entity.mark_written<Navigation>();
+        }
+
+        // Head straight for the goal while the path is still being searched
+        return follows && nav->path;
+    }
+
+    static void set_state(game::ecs::Entity& entity, AI* ai, AI::State state) {
+        if (ai->current_state != state) {
+            ai->current_state = state;
+            entity.mark_written<AI>();
+        }
+    }
+
+    void think(game::ecs::EntityID id, game::ecs::Entity& entity, float delta) {
+        if (behaviours_.has_behaviour(id)) {
+            return;
+        }
+
+        auto* ai = entity.get_component<AI>();
+        auto* pos = entity.get_component<Position>();
+        auto* vel = entity.get_component<Velocity>();
+        
+        if (ai && pos && vel) {
+            const auto previous = ai->current_state;
+            dispatch(entity, ai, pos, vel, delta);
+            if (ai->current_state != previous) {
+                states_.record_transition(id, ai->current_state);
+            }
+        }
+    }
+
+    void dispatch(game::ecs::Entity& entity, AI* ai, Position* pos, Velocity* vel, float delta) {
+        switch (ai->current_state) {
+            case AI::State::Idle:
+                handleIdleState(entity, ai, pos, vel, delta);
+                break;
+            case AI::State::Patrolling:
+                handlePatrolState(entity, ai, pos, vel, delta);
+                break;
+            case AI::State::Chasing:
+                handleChaseState(entity, ai, pos, vel, delta, entity.get_id());
+                break;
+            case AI::State::Attacking:
+                handleAttackState(entity, ai, pos, vel, delta, entity.get_id());
+                break;
+        }
+    }
+
+    void handleIdleState(game::ecs::Entity& entity, AI* ai, Position* pos, Velocity* vel, float delta) {
         // Stop movement
-        vel->dx = vel->dy = 0.0f;
+        set_velocity(entity, vel, 0.0f, 0.0f);
         
         // Transition to patrol if patrol points exist
         if (!ai->patrol_points.empty()) {
-            ai->current_state = AI::State::Patrolling;
+            set_state(entity, ai, AI::State::Patrolling);
         }
     }
     
-    void handlePatrolState(AI* ai, Position* pos, Velocity* vel, float delta) {
+    void handlePatrolState(game::ecs::Entity& entity, AI* ai, Position* pos, Velocity* vel, float delta) {
         if (ai->patrol_points.empty()) {
-            ai->current_state = AI::State::Idle;
+            set_state(entity, ai, AI::State::Idle);
             return;
         }
         
@@ -194,25 +911,28 @@ private:
         if (distance < 1.0f) {
             // Reached patrol point, move to next
             ai->current_patrol_index = (ai->current_patrol_index + 1) % ai->patrol_points.size();
+            entity.mark_written<AI>();
         } else {
             // Move toward patrol point
             float speed = 10.0f;
-            vel->dx = (dx / distance) * speed;
-            vel->dy = (dy / distance) * speed;
+            if (!steer_along_path(entity, pos, vel, target_point.x, target_point.y, speed)) {
+                set_velocity(entity, vel, (dx / distance) * speed, (dy / distance) * speed);
+            }
         }
     }
     
-    void handleChaseState(AI* ai, Position* pos, Velocity* vel, float delta, game::ecs::EntityID chaser_id) {
+    void handleChaseState(game::ecs::Entity& entity, AI* ai, Position* pos, Velocity* vel, float delta,
+                          game::ecs::EntityID chaser_id) {
         // Find target entity
         auto* target = get_entity(ai->target_entity_id);
         if (!target) {
-            ai->current_state = AI::State::Idle;
+            set_state(entity, ai, AI::State::Idle);
             return;
         }
         
         auto* target_pos = target->get_component<Position>();
         if (!target_pos) {
-            ai->current_state = AI::State::Idle;
+            set_state(entity, ai, AI::State::Idle);
             return;
         }
         
@@ -222,22 +942,24 @@ private:
         
         if (distance > ai->detection_range) {
             // Lost target
-            ai->current_state = AI::State::Patrolling;
-            vel->dx = vel->dy = 0.0f;
+            set_state(entity, ai, AI::State::Patrolling);
+            set_velocity(entity, vel, 0.0f, 0.0f);
         } else if (distance < 2.0f) {
             // Close enough to attack
-            ai->current_state = AI::State::Attacking;
+            set_state(entity, ai, AI::State::Attacking);
         } else {
             // Chase target
             float speed = 15.0f;
-            vel->dx = (dx / distance) * speed;
-            vel->dy = (dy / distance) * speed;
+            if (!steer_along_path(entity, pos, vel, target_pos->x, target_pos->y, speed)) {
+                set_velocity(entity, vel, (dx / distance) * speed, (dy / distance) * speed);
+            }
         }
     }
     
-    void handleAttackState(AI* ai, Position* pos, Velocity* vel, float delta, game::ecs::EntityID attacker_id) {
+    void handleAttackState(game::ecs::Entity& entity, AI* ai, Position* pos, Velocity* vel, float delta,
+                           game::ecs::EntityID attacker_id) {
         // Stop movement during attack
-        vel->dx = vel->dy = 0.0f;
+        set_velocity(entity, vel, 0.0f, 0.0f);
         
         // Find target and damage it
         auto* target = get_entity(ai->target_entity_id);
@@ -253,16 +975,17 @@ private:
                 if (distance <= 2.0f) {
                     // Deal damage
                     target_health->current_health -= static_cast<int>(50.0f * delta); // 50 DPS
+                    target->mark_written<Health>();
                     if (target_health->current_health <= 0) {
-                        ai->current_state = AI::State::Idle;
+                        set_state(entity, ai, AI::State::Idle);
                     }
                 } else {
                     // Target moved away, resume chasing
-                    ai->current_state = AI::State::Chasing;
+                    set_state(entity, ai, AI::State::Chasing);
                 }
             }
         } else {
-            ai->current_state = AI::State::Idle;
+            set_state(entity, ai, AI::State::Idle);
         }
     }
 };
@@ -279,17 +1002,18 @@ public:
         std::vector<game::ecs::EntityID> entities_to_process;
         
         // First pass: update timers
-        for (auto& [id, entity] : get_entities()) {
-            auto* timer = entity->get_component<Timer>();
+        for_each_entity([&](game::ecs::EntityID id, game::ecs::Entity& entity) {
+            auto* timer = entity.get_component<Timer>();
             
             if (timer) {
                 timer->elapsed_time += delta;
+                entity.mark_written<Timer>();
                 
                 if (timer->is_finished() && timer->auto_remove) {
                     entities_to_process.push_back(id);
                 }
             }
-        }
+        });
         
         // Second pass: remove entities with finished auto-remove timers
         for (auto entity_id : entities_to_process) {
@@ -298,6 +1022,61 @@ public:
     }
 };
 
+/**
+ * @brief Steers entities along grid paths toward their destinations
+ * 
+ * This system processes entities with Navigation, Position and Velocity
+ * components. Paths are requested from a PathfindingService and followed
+ * once they arrive; the tick never waits for a search to finish. Rejected
+ * requests are simply retried on the next tick. Requests nobody will poll,
+ * because the entity or its Navigation was removed or the destination
+ * changed, are released so the service doesn't keep them forever. In a
+ * deterministic world paths are searched on the calling thread instead, so
+ * lockstep peers and replays get the same paths on the same ticks.
+ */
+class NavigationSystem : public game::ecs::System {
+    PathFollower paths_;
+    
+public:
+    explicit NavigationSystem(PathfindingService* pathfinding) : paths_(pathfinding) {}
+    
+    void tick(const float&) noexcept override {
+        if (!paths_.get_service()) {
+            return;
+        }
+        
+        // Paths are requested in entity order, so request IDs match across deterministic runs
+        for_each_entity([this](game::ecs::EntityID, game::ecs::Entity& entity) {
+            auto* nav = entity.get_component<Navigation>();
+            auto* pos = entity.get_component<Position>();
+            auto* vel = entity.get_component<Velocity>();
+            if (!nav) {
+                return;
+            }
+            
+            bool changed = paths_.release_abandoned(nav);
+            if (pos && vel && nav->has_destination) {
+                changed = paths_.follow(entity, nav, pos, vel, is_deterministic()) || changed;
+            }
+            
+            if (changed) {
+                entity.mark_written<Navigation>();
+            }
+        });
+    }
+    
+protected:
+    void on_entity_removed(const game::ecs::EntityID id) noexcept override {
+        paths_.release(get_entity(id)->get_component<Navigation>());
+    }
+    
+    void on_component_removed(game::ecs::Entity& entity, const std::type_index& type) noexcept override {
+        if (type == typeid(Navigation)) {
+            paths_.release(entity.get_component<Navigation>());
+        }
+    }
+};
+
 } // namespace demo
 
 #endif // DEMO_SYSTEMS_HPP 
\ No newline at end of file
@@ -0,0 +1,554 @@
+#ifndef GAME_ECS_BEHAVIOUR_HPP
+#define GAME_ECS_BEHAVIOUR_HPP
+
+#include "entity.hpp"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Size-class free-list allocator for coroutine frames
+ *
+ * Frames are rounded up to 64-byte classes and recycled through per-class
+ * free lists backed by slabs, so spawning and finishing behaviours doesn't
+ * touch the global heap once the pool is warm. Frames larger than the
+ * biggest class fall back to operator new. The pool is per thread; frames
+ * must be destroyed on the thread that created them.
+ */
+class FramePool {
+    static constexpr std::size_t CLASS_SIZE = 64;
+    static constexpr std::size_t CLASS_COUNT = 32;
+    static constexpr std::size_t BLOCKS_PER_SLAB = 64;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    FreeBlock* free_lists_[CLASS_COUNT]{};
+    std::vector<std::unique_ptr<std::byte[]>> slabs_;
+
+public:
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    static FramePool& local() noexcept {
+        thread_local FramePool pool;
+        return pool;
+    }
+
+    void* allocate(const std::size_t size) {
+        const auto index = class_of(size);
+        if (index >= CLASS_COUNT) {
+            return ::operator new(size);
+        }
+
+        if (!free_lists_[index]) {
+            refill(index);
+        }
+
+        auto* block = free_lists_[index];
+        free_lists_[index] = block->next;
+        return block;
+    }
+
+    void deallocate(void* ptr, const std::size_t size) noexcept {
+        const auto index = class_of(size);
+        if (index >= CLASS_COUNT) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = free_lists_[index];
+        free_lists_[index] = block;
+    }
+
+    std::size_t get_slab_count() const noexcept { return slabs_.size(); }
+
+private:
+    static std::size_t class_of(const std::size_t size) noexcept {
+        return (size + CLASS_SIZE - 1) / CLASS_SIZE - 1;
+    }
+
+    void refill(const std::size_t index) {
+        const auto block_size = (index + 1) * CLASS_SIZE;
+        auto slab = std::make_unique<std::byte[]>(block_size * BLOCKS_PER_SLAB);
+
+        for (std::size_t i = 0; i < BLOCKS_PER_SLAB; ++i) {
+            auto* block = reinterpret_cast<FreeBlock*>(slab.get() + i * block_size);
+            block->next = free_lists_[index];
+            free_lists_[index] = block;
+        }
+
+        slabs_.push_back(std::move(slab));
+    }
+};
+
+class BehaviourScheduler;
+
+/**
+ * @brief Identifies a behaviour spawned on a BehaviourScheduler
+ */
+struct BehaviourHandle {
+    std::uint32_t slot{0};
+    std::uint32_t generation{0};
+
+    bool valid() const noexcept { return generation != 0; }
+};
+
+/**
+ * @brief A suspended coroutine waiting to be resumed by the scheduler
+ */
+struct BehaviourWaiter {
+    BehaviourScheduler* scheduler;
+    BehaviourHandle task;
+    std::coroutine_handle<> handle;
+};
+
+/**
+ * @brief Coroutine type for entity behaviours
+ *
+ * A behaviour is a coroutine that can `co_await` the scheduler's waits
+ * (wait_seconds(), next_tick(), wait_until(), Signal::wait()) and other
+ * behaviours, which run inline as sub-steps. Frames come from the thread's
+ * FramePool. Behaviours start suspended and run once spawned on a scheduler.
+ */
+class Behaviour {
+public:
+    struct promise_type {
+        BehaviourScheduler* scheduler{nullptr};
+        BehaviourHandle task;
+        std::coroutine_handle<> continuation;
+
+        static void* operator new(const std::size_t size) {
+            return FramePool::local().allocate(size);
+        }
+
+        static void operator delete(void* ptr, const std::size_t size) noexcept {
+            FramePool::local().deallocate(ptr, size);
+        }
+
+        Behaviour get_return_object() noexcept {
+            return Behaviour(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    auto continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Behaviour() = default;
+    explicit Behaviour(const Handle handle) noexcept : handle_(handle) {}
+
+    Behaviour(Behaviour&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Behaviour& operator=(Behaviour&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    Behaviour(const Behaviour&) = delete;
+    Behaviour& operator=(const Behaviour&) = delete;
+
+    ~Behaviour() {
+        destroy();
+    }
+
+    bool valid() const noexcept { return static_cast<bool>(handle_); }
+    bool done() const noexcept { return !handle_ || handle_.done(); }
+
+    Handle release() noexcept { return std::exchange(handle_, nullptr); }
+
+    // Awaiting a behaviour runs it as a sub-step of the awaiting behaviour
+    bool await_ready() const noexcept { return done(); }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> parent) noexcept {
+        auto& promise = handle_.promise();
+        promise.scheduler = parent.promise().scheduler;
+        promise.task = parent.promise().task;
+        promise.continuation = parent;
+        return handle_;
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    Handle handle_;
+};
+
+/**
+ * @brief Runs behaviours and resumes them in one batch per tick
+ *
+ * Timer waits sit in a min-heap and signal waits in the signal's own list, so
+ * a sleeping behaviour costs nothing until it is due. Only wait_until()
+ * predicates are polled every tick. Behaviours can be owned by an entity and
+ * cancelled together when it goes away. A behaviour cancelled while the
+ * batch is resuming, e.g. one that removes its own entity, never resumes
+ * again, but its frame is only destroyed once the batch has finished, as it
+ * may be the one still running.
+ */
+class BehaviourScheduler {
+    struct Task {
+        Behaviour::Handle root;
+        EntityID owner{0};
+        std::uint32_t generation{1};
+        bool alive{false};
+    };
+
+    struct Timer {
+        double wake_time;
+        std::uint64_t sequence;
+        BehaviourWaiter waiter;
+
+        bool operator>(const Timer& other) const noexcept {
+            return wake_time != other.wake_time ? wake_time > other.wake_time : sequence > other.sequence;
+        }
+    };
+
+    struct Poll {
+        BehaviourWaiter waiter;
+        bool (*ready)(void*);
+        void* context;
+    };
+
+    std::vector<Task> tasks_;
+    std::vector<std::uint32_t> free_slots_;
+    std::unordered_map<EntityID, std::uint32_t> owner_counts_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    std::vector<Poll> polls_;
+    std::vector<Poll> polls_pending_;
+    std::vector<BehaviourWaiter> ready_;
+    std::vector<BehaviourWaiter> resuming_;
+    std::vector<Behaviour::Handle> cancelled_;
+    std::uint64_t timer_sequence_{0};
+    double now_{0.0};
+    std::size_t alive_count_{0};
+    bool resuming_batch_{false};
+
+public:
+    BehaviourScheduler() = default;
+    BehaviourScheduler(const BehaviourScheduler&) = delete;
+    BehaviourScheduler& operator=(const BehaviourScheduler&) = delete;
+
+    ~BehaviourScheduler() {
+        for (auto& task : tasks_) {
+            if (task.alive) {
+                task.root.destroy();
+            }
+        }
+        destroy_cancelled();
+    }
+
+    double now() const noexcept { return now_; }
+    std::size_t get_active_count() const noexcept { return alive_count_; }
+    std::size_t get_timer_count() const noexcept { return timers_.size(); }
+    std::size_t get_poll_count() const noexcept { return polls_.size(); }
+
+    bool is_alive(const BehaviourHandle handle) const noexcept {
+        return handle.slot < tasks_.size() && tasks_[handle.slot].alive &&
+               tasks_[handle.slot].generation == handle.generation;
+    }
+
+    bool has_behaviour(const EntityID owner) const noexcept {
+        return owner_counts_.find(owner) != owner_counts_.end();
+    }
+
+    /**
+     * @brief Takes ownership of a behaviour; it first runs on the next tick()
+     */
+    BehaviourHandle spawn(Behaviour&& behaviour, const EntityID owner = 0) {
+        if (behaviour.done()) {
+            return {};
+        }
+
+        std::uint32_t slot;
+        if (!free_slots_.empty()) {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        } else {
+            slot = static_cast<std::uint32_t>(tasks_.size());
+            tasks_.emplace_back();
+        }
+
+        auto& task = tasks_[slot];
+        task.root = behaviour.release();
+        task.owner = owner;
+        task.alive = true;
+        ++alive_count_;
+        if (owner != 0) {
+            ++owner_counts_[owner];
+        }
+
+        const BehaviourHandle handle{slot, task.generation};
+        task.root.promise().scheduler = this;
+        task.root.promise().task = handle;
+
+        ready_.push_back({this, handle, task.root});
+        return handle;
+    }
+
+    bool cancel(const BehaviourHandle handle) noexcept {
+        if (!is_alive(handle)) {
+            return false;
+        }
+
+        auto& task = tasks_[handle.slot];
+        if (resuming_batch_) {
+            cancelled_.push_back(task.root);
+        } else {
+            task.root.destroy();
+        }
+        retire(handle.slot);
+        return true;
+    }
+
+    std::size_t cancel_owned_by(const EntityID owner) noexcept {
+        if (!has_behaviour(owner)) {
+            return 0;
+        }
+
+        std::size_t cancelled = 0;
+        for (std::uint32_t slot = 0; slot < tasks_.size(); ++slot) {
+            if (tasks_[slot].alive && tasks_[slot].owner == owner) {
+                cancel({slot, tasks_[slot].generation});
+                ++cancelled;
+            }
+        }
+        return cancelled;
+    }
+
+    /**
+     * @brief Advances the clock and resumes every behaviour that became ready
+     */
+    void tick(const float delta) {
+        now_ += delta;
+
+        while (!timers_.empty() && timers_.top().wake_time <= now_) {
+            ready_.push_back(timers_.top().waiter);
+            timers_.pop();
+        }
+
+        polls_pending_.clear();
+        for (const auto& poll : polls_) {
+            if (!is_alive(poll.waiter.task)) {
+                continue;
+            }
+            if (poll.ready(poll.context)) {
+                ready_.push_back(poll.waiter);
+            } else {
+                polls_pending_.push_back(poll);
+            }
+        }
+        polls_.swap(polls_pending_);
+
+        // Behaviours made ready while resuming (e.g. by a signal) run next tick
+        resuming_.swap(ready_);
+        resuming_batch_ = true;
+        for (const auto& waiter : resuming_) {
+            if (!is_alive(waiter.task)) {
+                continue;
+            }
+
+            waiter.handle.resume();
+
+            // The behaviour may have been cancelled while it ran, and its slot reused by a spawn
+            auto& task = tasks_[waiter.task.slot];
+            if (is_alive(waiter.task) && task.root.done()) {
+                task.root.destroy();
+                retire(waiter.task.slot);
+            }
+        }
+        resuming_batch_ = false;
+        resuming_.clear();
+        destroy_cancelled();
+    }
+
+    void make_ready(const BehaviourWaiter& waiter) {
+        ready_.push_back(waiter);
+    }
+
+    void wake_at(const double time, const BehaviourWaiter& waiter) {
+        timers_.push({time, timer_sequence_++, waiter});
+    }
+
+    void poll(const BehaviourWaiter& waiter, bool (*ready)(void*), void* context) {
+        polls_.push_back({waiter, ready, context});
+    }
+
+private:
+    void destroy_cancelled() noexcept {
+        for (const auto handle : cancelled_) {
+            handle.destroy();
+        }
+        cancelled_.clear();
+    }
+
+    void retire(const std::uint32_t slot) noexcept {
+        auto& task = tasks_[slot];
+        if (task.owner != 0) {
+            const auto it = owner_counts_.find(task.owner);
+            if (it != owner_counts_.end() && --it->second == 0) {
+                owner_counts_.erase(it);
+            }
+        }
+
+        task.root = nullptr;
+        task.owner = 0;
+        task.alive = false;
+        ++task.generation;
+        --alive_count_;
+        free_slots_.push_back(slot);
+    }
+};
+
+namespace detail {
+
+inline BehaviourWaiter make_waiter(const Behaviour::Handle handle) noexcept {
+    auto& promise = handle.promise();
+    return {promise.scheduler, promise.task, handle};
+}
+
+}//detail
+
+/**
+ * @brief Suspends the behaviour for `seconds` of simulation time
+ */
+inline auto wait_seconds(const float seconds) noexcept {
+    struct Awaiter {
+        float seconds;
+
+        bool await_ready() const noexcept { return seconds <= 0.0f; }
+
+        void await_suspend(const Behaviour::Handle handle) {
+            const auto waiter = detail::make_waiter(handle);
+            waiter.scheduler->wake_at(waiter.scheduler->now() + seconds, waiter);
+        }
+
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{seconds};
+}
+
+/**
+ * @brief Suspends the behaviour until the next tick
+ */
+inline auto next_tick() noexcept {
+    struct Awaiter {
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(const Behaviour::Handle handle) {
+            const auto waiter = detail::make_waiter(handle);
+            waiter.scheduler->wake_at(waiter.scheduler->now(), waiter);
+        }
+
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{};
+}
+
+/**
+ * @brief Suspends the behaviour until `pred()` returns true; the predicate is polled once per tick
+ */
+template<typename Pred>
+auto wait_until(Pred pred) {
+    struct Awaiter {
+        Pred pred;
+
+        bool await_ready() { return pred(); }
+
+        void await_suspend(const Behaviour::Handle handle) {
+            const auto waiter = detail::make_waiter(handle);
+            waiter.scheduler->poll(waiter, [](void* context) {
+                return static_cast<Awaiter*>(context)->pred();
+            }, this);
+        }
+
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{std::move(pred)};
+}
+
+/**
+ * @brief Event that behaviours can wait on without being polled
+ */
+class Signal {
+    std::vector<BehaviourWaiter> waiters_;
+
+public:
+    std::size_t get_waiter_count() const noexcept { return waiters_.size(); }
+
+    auto wait() noexcept {
+        struct Awaiter {
+            Signal& signal;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(const Behaviour::Handle handle) {
+                signal.waiters_.push_back(detail::make_waiter(handle));
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    /**
+     * @brief Makes every waiting behaviour ready; they resume on the scheduler's next tick
+     */
+    void notify_all() {
+        for (const auto& waiter : waiters_) {
+            if (waiter.scheduler->is_alive(waiter.task)) {
+                waiter.scheduler->make_ready(waiter);
+            }
+        }
+        waiters_.clear();
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_BEHAVIOUR_HPP
@@ -0,0 +1,152 @@
+#ifndef GAME_ECS_BUDGET_HPP
+#define GAME_ECS_BUDGET_HPP
+
+#include "system.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Per-tick CPU budget for a time-sliced pass over a system's entities
+ *
+ * `per_tick` caps how long the pass may run each tick. `max_ticks` is the
+ * fairness bound: however tight the budget, every entity present at the start
+ * of a cycle is visited within `max_ticks` ticks. The clock is only read every
+ * `check_every` entities to keep timing overhead low.
+ *
+ * In a deterministic system `per_tick` is ignored: each tick visits exactly
+ * the fairness minimum, or `fixed_per_tick` entities if that is larger, so
+ * lockstep peers and replays process the same entities on the same tick.
+ */
+struct TimeBudget {
+    std::chrono::microseconds per_tick{1000};
+    std::uint32_t max_ticks{8};
+    std::uint32_t check_every{16};
+    std::uint32_t fixed_per_tick{0};
+};
+
+/**
+ * @brief Resumable cursor that spreads a pass over several ticks within a budget
+ *
+ * A cycle snapshots the system's entity IDs and run() works through them from
+ * where the previous tick stopped until the budget is spent, but never fewer
+ * than needed to finish the cycle within `max_ticks`. Entities created during
+ * a cycle join the next one, so any entity waits at most 2 * `max_ticks`
+ * ticks. Each visited entity receives the time elapsed since its last visit.
+ */
+class BudgetedCursor {
+    TimeBudget budget_;
+    std::vector<EntityID> order_;
+    std::size_t cursor_{0};
+    std::uint32_t ticks_in_cycle_{0};
+    std::unordered_map<EntityID, double> last_visit_;
+    double clock_{0.0};
+    std::size_t last_processed_{0};
+    std::uint32_t last_cycle_ticks_{0};
+
+public:
+    BudgetedCursor() = default;
+    explicit BudgetedCursor(const TimeBudget& budget) : budget_(budget) {}
+
+    const TimeBudget& get_budget() const noexcept { return budget_; }
+    void set_budget(const TimeBudget& budget) noexcept { budget_ = budget; }
+
+    std::size_t get_last_processed() const noexcept { return last_processed_; }
+    std::uint32_t get_last_cycle_ticks() const noexcept { return last_cycle_ticks_; }
+    std::size_t get_remaining() const noexcept { return order_.size() - cursor_; }
+
+    void reset() noexcept {
+        order_.clear();
+        cursor_ = 0;
+        ticks_in_cycle_ = 0;
+        last_visit_.clear();
+    }
+
+    /**
+     * @brief Runs `fn(id, entity, elapsed)` for as many entities as the budget allows
+     *
+     * Returns the number of entities visited this tick. When the system is
+     * deterministic the count depends only on the entity set, never on time.
+     */
+    template<typename Fn>
+    std::size_t run(System& system, const float delta, Fn&& fn) {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        clock_ += delta;
+
+        if (cursor_ >= order_.size()) {
+            begin_cycle(system);
+        }
+
+        const auto max_ticks = std::max<std::uint32_t>(budget_.max_ticks, 1);
+        const auto ticks_left = max_ticks > ticks_in_cycle_ ? max_ticks - ticks_in_cycle_ : 1;
+        const auto minimum = (get_remaining() + ticks_left - 1) / ticks_left;
+        const auto check_every = std::max<std::uint32_t>(budget_.check_every, 1);
+        const bool deterministic = system.is_deterministic();
+        const auto fixed = std::max<std::size_t>(minimum, budget_.fixed_per_tick);
+
+        std::size_t processed = 0;
+        while (cursor_ < order_.size()) {
+            if (deterministic) {
+                if (processed >= fixed) {
+                    break;
+                }
+            } else if (processed >= minimum && processed % check_every == 0 &&
+                       Clock::now() - start >= budget_.per_tick) {
+                break;
+            }
+
+            const auto id = order_[cursor_++];
+            auto* entity = system.get_entity(id);
+            if (!entity) {
+                continue; // Removed since the cycle started
+            }
+
+            auto& last_visit = last_visit_.try_emplace(id, clock_ - delta).first->second;
+            const auto elapsed = static_cast<float>(clock_ - last_visit);
+            last_visit = clock_;
+
+            fn(id, *entity, elapsed);
+            ++processed;
+        }
+
+        ++ticks_in_cycle_;
+        last_processed_ = processed;
+        return processed;
+    }
+
+private:
+    void begin_cycle(System& system) {
+        if (!order_.empty()) {
+            last_cycle_ticks_ = ticks_in_cycle_;
+        }
+
+        order_.clear();
+        order_.reserve(system.get_entities().size());
+        for (const auto& [id, _] : system.get_entities()) {
+            order_.push_back(id);
+        }
+        std::sort(order_.begin(), order_.end());
+
+        for (auto it = last_visit_.begin(); it != last_visit_.end();) {
+            if (!system.has_entity(it->first)) {
+                it = last_visit_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        cursor_ = 0;
+        ticks_in_cycle_ = 0;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_BUDGET_HPP
@@ -0,0 +1,841 @@
+#ifndef GAME_ECS_CHANGE_LOG_HPP
+#define GAME_ECS_CHANGE_LOG_HPP
+
+#include "entity.hpp"
+#include "snapshot.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+enum class ChangeKind : std::uint16_t {
+    Schema = 0,
+    EntityAdded = 1,
+    EntityRemoved = 2,
+    ComponentAdded = 3,
+    ComponentRemoved = 4,
+    ComponentWritten = 5
+};
+
+/**
+ * @brief On-disk layout shared by ChangeLog and ChangeLogReader
+ *
+ * A FileHeader is followed by records, each a RecordHeader and a payload,
+ * padded to 8 bytes (native endianness). `committed` in the header is the
+ * number of valid bytes in the file; it is only advanced after the records
+ * before it are complete, so a reader never sees a partial record. The
+ * first record is a Schema record listing the system names, then each
+ * component's name, schema hash and record size. ComponentAdded and
+ * ComponentWritten records carry the component saved with its
+ * SnapshotSchema entry: the fixed-size record followed by the blob, whose
+ * unpadded length is stored in the header's `blob_size`.
+ */
+class ChangeLogFormat {
+public:
+    static constexpr std::uint32_t VERSION = 2;
+
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t committed;
+        std::uint64_t reserved2;
+    };
+
+    struct RecordHeader {
+        std::uint32_t size;
+        ChangeKind kind;
+        std::uint16_t system;
+        std::uint32_t component;
+        std::uint32_t blob_size;
+        std::uint64_t tick;
+        EntityID id;
+    };
+
+    static constexpr std::size_t padded(const std::size_t size) noexcept {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+};
+
+/**
+ * @brief Bounded lock-free queue of pointers for any number of producers and consumers
+ *
+ * Each slot carries a sequence number that tells producers and consumers
+ * whose turn it is, so push() and pop() only contend on one atomic index
+ * each and never block; they fail when the queue is full or empty.
+ */
+template<typename T>
+class PointerRing {
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T* value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+
+public:
+    /**
+     * @brief Rounds `capacity` up to a power of two
+     */
+    explicit PointerRing(const std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        slots_ = std::make_unique<Slot[]>(size);
+        mask_ = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(T* value) noexcept {
+        auto position = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[position & mask_];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T*& value) noexcept {
+        auto position = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[position & mask_];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (difference == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = slot.value;
+                    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Tuning for ChangeLog
+ *
+ * Threads fill blocks of about `block_size` bytes before handing them to
+ * the writer through a ring of `ring_capacity` blocks. The file grows in
+ * steps of at least `file_growth` bytes.
+ */
+struct ChangeLogOptions {
+    std::size_t block_size{64 * 1024};
+    std::size_t ring_capacity{1024};
+    std::uint64_t file_growth{16ull << 20};
+};
+
+/**
+ * @brief Append-only log of entity and component changes that other processes can tail
+ *
+ * Observers on the schema's systems turn every entity creation and removal
+ * and every component addition, removal and write into a record stamped
+ * with the world tick. Records are appended to a block owned by the thread
+ * making the change, so parallel system passes never share a lock. Full
+ * blocks, and on commit() every partial one, go through a lock-free ring to
+ * a writer thread, which appends them to a memory-mapped file and then
+ * advances the header's committed size. If the writer falls a whole ring
+ * behind, blocks are dropped and counted rather than stalling the tick.
+ *
+ * Added components are saved when they are added. Writes are reported
+ * before the new value is stored (write_component()), so they are only
+ * noted, and commit() saves each written component once with its value at
+ * that point, stamped with the tick of its last write. Records keep their
+ * order within a thread; across threads only the tick stamps order them.
+ */
+class ChangeLog {
+    class Watcher : public EntityObserver {
+        ChangeLog& owner_;
+        std::uint16_t system_;
+
+    public:
+        Watcher(ChangeLog& owner, const std::uint16_t system) noexcept
+            : owner_(owner)
+            , system_(system) {}
+
+        void on_entity_added(Entity& entity) noexcept override {
+            owner_.record(ChangeKind::EntityAdded, system_, entity, nullptr);
+        }
+
+        void on_entity_removed(Entity& entity) noexcept override {
+            owner_.record(ChangeKind::EntityRemoved, system_, entity, nullptr);
+        }
+
+        void on_component_added(Entity& entity, const std::type_index& type) noexcept override {
+            owner_.record(ChangeKind::ComponentAdded, system_, entity, &type);
+        }
+
+        void on_component_removed(Entity& entity, const std::type_index& type) noexcept override {
+            owner_.record(ChangeKind::ComponentRemoved, system_, entity, &type);
+        }
+
+        void on_component_written(Entity& entity, const std::type_index& type) noexcept override {
+            owner_.note_write(system_, entity, type);
+        }
+    };
+
+    struct Block {
+        std::vector<char> data;
+        std::size_t events{0};
+    };
+
+    struct Write {
+        std::uint32_t system;
+        std::uint32_t component;
+        EntityID id;
+        std::uint64_t tick;
+
+        // Latest tick first, so std::unique() keeps it
+        bool operator<(const Write& other) const noexcept {
+            return system != other.system       ? system < other.system
+                 : id != other.id               ? id < other.id
+                 : component != other.component ? component < other.component
+                                                : tick > other.tick;
+        }
+
+        bool operator==(const Write& other) const noexcept {
+            return system == other.system && id == other.id && component == other.component;
+        }
+    };
+
+    struct ThreadState {
+        Block* block{nullptr};
+        std::vector<Write> writes;
+        std::vector<char> record;
+        std::vector<char> blob;
+    };
+
+    World& world_;
+    const SnapshotSchema& schema_;
+    ChangeLogOptions options_;
+    std::uint64_t log_id_;
+    std::vector<System*> systems_;
+    std::vector<std::unique_ptr<Watcher>> watchers_;
+    std::unordered_map<std::type_index, std::uint32_t> component_of_;
+
+    std::mutex threads_mutex_;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadState>> threads_;
+    std::mutex blocks_mutex_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+    PointerRing<Block> full_;
+    PointerRing<Block> free_;
+    std::vector<Write> merged_;
+
+    std::thread writer_;
+    std::mutex writing_mutex_; // Held by the writer while it drains the ring
+    std::atomic<std::uint64_t> published_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> committed_{0};
+    std::atomic<bool> failed_{false};
+
+    // Owned by the writer thread
+#ifdef GAME_ECS_SNAPSHOT_MMAP
+    int fd_{-1};
+    char* mapping_{nullptr};
+    std::uint64_t capacity_{0};
+#else
+    std::FILE* file_{nullptr};
+#endif
+
+public:
+    ChangeLog(World& world, const SnapshotSchema& schema, const std::string& path,
+              const ChangeLogOptions& options = {})
+        : world_(world)
+        , schema_(schema)
+        , options_(options)
+        , log_id_(next_log_id())
+        , full_(options.ring_capacity)
+        , free_(options.ring_capacity) {
+        const auto& components = schema_.get_components();
+        for (std::uint32_t c = 0; c < components.size(); ++c) {
+            component_of_.emplace(components[c]->get_type(), c);
+        }
+
+        if (!open(path)) {
+            failed_ = true;
+            return;
+        }
+        write_schema();
+
+        const auto& systems = schema_.get_systems();
+        for (std::uint16_t s = 0; s < systems.size(); ++s) {
+            systems_.push_back(systems[s].get(world_));
+            watchers_.push_back(std::make_unique<Watcher>(*this, s));
+            if (systems_[s]) {
+                systems_[s]->attach_observer(watchers_[s].get());
+            }
+        }
+
+        writer_ = std::thread([this] { work(); });
+    }
+
+    ChangeLog(const ChangeLog&) = delete;
+    ChangeLog& operator=(const ChangeLog&) = delete;
+
+    ~ChangeLog() {
+        for (std::size_t s = 0; s < systems_.size(); ++s) {
+            if (systems_[s]) {
+                systems_[s]->detach_observer(watchers_[s].get());
+            }
+        }
+        if (writer_.joinable()) {
+            commit();
+            stopping_ = true;
+            published_.fetch_add(1, std::memory_order_release);
+            published_.notify_one();
+            writer_.join();
+        }
+        close();
+    }
+
+    /**
+     * @brief Saves the components written since the last commit and hands every thread's block to the writer
+     *
+     * Call it between ticks, when no other thread is changing the world.
+     */
+    void commit() {
+        if (failed_) {
+            return;
+        }
+
+        auto& local = local_state();
+        std::lock_guard lock(threads_mutex_);
+        merged_.clear();
+        for (auto& [_, state] : threads_) {
+            merged_.insert(merged_.end(), state->writes.begin(), state->writes.end());
+            state->writes.clear();
+        }
+        std::sort(merged_.begin(), merged_.end());
+        merged_.erase(std::unique(merged_.begin(), merged_.end()), merged_.end());
+
+        const auto& components = schema_.get_components();
+        for (const auto& write : merged_) {
+            const auto* entity = systems_[write.system]->get_entity(write.id);
+            if (!entity) {
+                continue;
+            }
+            const auto it = entity->get_components().find(components[write.component]->get_type());
+            if (it != entity->get_components().end()) {
+                append(local, ChangeKind::ComponentWritten, static_cast<std::uint16_t>(write.system), write.tick,
+                       write.id, write.component, it->second.get());
+            }
+        }
+
+        for (auto& [_, state] : threads_) {
+            if (state->block && !state->block->data.empty()) {
+                publish(*state);
+            }
+        }
+    }
+
+    /**
+     * @brief Bytes in the file that readers can rely on, including the header
+     */
+    std::uint64_t get_committed_size() const noexcept { return committed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Events lost because the writer was a whole ring behind
+     */
+    std::uint64_t get_dropped_events() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    bool has_failed() const noexcept { return failed_; }
+
+    std::size_t get_thread_count() const noexcept { return writer_.joinable() ? 1 : 0; }
+
+    /**
+     * @brief Keeps the writer from draining the ring while the returned lock is held
+     *
+     * Published blocks wait in the ring. Used before fork() so the writer is
+     * not writing or holding a lock when the process is copied.
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> quiesce() {
+        return std::unique_lock(writing_mutex_);
+    }
+
+private:
+    static std::uint64_t next_log_id() noexcept {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ThreadState& local_state() {
+        struct Cache {
+            std::uint64_t log_id;
+            ThreadState* state;
+        };
+        thread_local Cache cache{0, nullptr};
+        if (cache.log_id == log_id_) {
+            return *cache.state;
+        }
+
+        std::lock_guard lock(threads_mutex_);
+        auto& state = threads_[std::this_thread::get_id()];
+        if (!state) {
+            state = std::make_unique<ThreadState>();
+        }
+        cache = {log_id_, state.get()};
+        return *state;
+    }
+
+    void record(const ChangeKind kind, const std::uint16_t system, const Entity& entity,
+                const std::type_index* type) noexcept {
+        std::uint32_t component = 0;
+        const Component* value = nullptr;
+        if (type) {
+            const auto it = component_of_.find(*type);
+            if (it == component_of_.end()) {
+                return;
+            }
+            component = it->second;
+            if (kind == ChangeKind::ComponentAdded) {
+                const auto found = entity.get_components().find(*type);
+                if (found == entity.get_components().end()) {
+                    return;
+                }
+                value = found->second.get();
+            }
+        }
+        append(local_state(), kind, system, world_.get_tick_count(), entity.get_id(), component, value);
+    }
+
+    void note_write(const std::uint16_t system, const Entity& entity, const std::type_index& type) noexcept {
+        const auto it = component_of_.find(type);
+        if (it != component_of_.end()) {
+            local_state().writes.push_back({system, it->second, entity.get_id(), world_.get_tick_count()});
+        }
+    }
+
+    void append(ThreadState& state, const ChangeKind kind, const std::uint16_t system, const std::uint64_t tick,
+                const EntityID id, const std::uint32_t component, const Component* value) {
+        ChangeLogFormat::RecordHeader header{0, kind, system, component, 0, tick, id};
+        state.record.clear();
+        state.blob.clear();
+        if (value) {
+            const auto& schema = *schema_.get_components()[component];
+            state.record.resize(schema.get_record_size(), 0);
+            SnapshotWriter blob(state.blob);
+            schema.save(*value, state.record.data(), blob);
+        }
+        const auto payload = state.record.size() + state.blob.size();
+        const auto size = ChangeLogFormat::padded(sizeof(header) + payload);
+        header.size = static_cast<std::uint32_t>(size);
+        header.blob_size = static_cast<std::uint32_t>(state.blob.size());
+
+        if (!state.block) {
+            state.block = acquire();
+        } else if (!state.block->data.empty() && state.block->data.size() + size > options_.block_size) {
+            publish(state);
+            state.block = acquire();
+        }
+
+        auto& data = state.block->data;
+        const auto at = data.size();
+        data.resize(at + size, 0);
+        std::memcpy(data.data() + at, &header, sizeof(header));
+        if (!state.record.empty()) {
+            std::memcpy(data.data() + at + sizeof(header), state.record.data(), state.record.size());
+        }
+        if (!state.blob.empty()) {
+            std::memcpy(data.data() + at + sizeof(header) + state.record.size(), state.blob.data(), state.blob.size());
+        }
+        ++state.block->events;
+    }
+
+    Block* acquire() {
+        Block* block = nullptr;
+        if (free_.pop(block)) {
+            return block;
+        }
+
+        std::lock_guard lock(blocks_mutex_);
+        blocks_.push_back(std::make_unique<Block>());
+        blocks_.back()->data.reserve(options_.block_size);
+        return blocks_.back().get();
+    }
+
+    void publish(ThreadState& state) {
+        auto* block = state.block;
+        state.block = nullptr;
+        if (!full_.push(block)) {
+            dropped_.fetch_add(block->events, std::memory_order_relaxed);
+            recycle(block);
+            return;
+        }
+        published_.fetch_add(1, std::memory_order_release);
+        published_.notify_one();
+    }
+
+    void recycle(Block* block) noexcept {
+        block->data.clear();
+        block->events = 0;
+        if (!free_.push(block)) {
+            // Still owned by blocks_; only the spare capacity is given back
+            block->data.shrink_to_fit();
+        }
+    }
+
+    void work() {
+        for (;;) {
+            const auto seen = published_.load(std::memory_order_acquire);
+            bool wrote = false;
+            {
+                std::lock_guard lock(writing_mutex_);
+                Block* block = nullptr;
+                while (full_.pop(block)) {
+                    write(block->data.data(), block->data.size());
+                    recycle(block);
+                    wrote = true;
+                }
+                if (wrote) {
+                    sync_header();
+                }
+            }
+            if (wrote) {
+                continue;
+            }
+            if (stopping_) {
+                return;
+            }
+            published_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    void write_schema() {
+        std::vector<char> payload;
+        SnapshotWriter out(payload);
+        out.write(static_cast<std::uint32_t>(schema_.get_systems().size()));
+        for (const auto& system : schema_.get_systems()) {
+            out.write_string(system.name);
+        }
+        out.write(static_cast<std::uint32_t>(schema_.get_components().size()));
+        for (const auto& component : schema_.get_components()) {
+            out.write_string(component->get_name());
+            out.write(component->get_schema_hash());
+            out.write(static_cast<std::uint64_t>(component->get_record_size()));
+        }
+
+        const auto size = ChangeLogFormat::padded(sizeof(ChangeLogFormat::RecordHeader) + payload.size());
+        const ChangeLogFormat::RecordHeader header{static_cast<std::uint32_t>(size), ChangeKind::Schema, 0, 0, 0,
+                                                   world_.get_tick_count(), 0};
+        std::vector<char> record(size, 0);
+        std::memcpy(record.data(), &header, sizeof(header));
+        std::memcpy(record.data() + sizeof(header), payload.data(), payload.size());
+        write(record.data(), record.size());
+        sync_header();
+    }
+
+#ifdef GAME_ECS_SNAPSHOT_MMAP
+    bool open(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0 || !grow(sizeof(ChangeLogFormat::FileHeader))) {
+            return false;
+        }
+
+        ChangeLogFormat::FileHeader header{};
+        std::memcpy(header.magic, "ECSCDC", 7);
+        header.version = ChangeLogFormat::VERSION;
+        header.committed = sizeof(header);
+        std::memcpy(mapping_, &header, sizeof(header));
+        committed_ = sizeof(header);
+        return true;
+    }
+
+    bool grow(const std::uint64_t needed) {
+        if (needed <= capacity_) {
+            return true;
+        }
+        const auto capacity = std::max<std::uint64_t>(needed, capacity_ + options_.file_growth);
+        if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+            return false;
+        }
+        if (mapping_) {
+            ::munmap(mapping_, capacity_);
+        }
+        void* mapping = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        mapping_ = mapping == MAP_FAILED ? nullptr : static_cast<char*>(mapping);
+        capacity_ = mapping_ ? capacity : 0;
+        return mapping_ != nullptr;
+    }
+
+    void write(const char* data, const std::size_t size) {
+        const auto at = committed_.load(std::memory_order_relaxed);
+        if (failed_ || !grow(at + size)) {
+            failed_ = true;
+            return;
+        }
+        std::memcpy(mapping_ + at, data, size);
+        committed_.store(at + size, std::memory_order_release);
+    }
+
+    void sync_header() noexcept {
+        if (mapping_) {
+            std::atomic_ref<std::uint64_t>(reinterpret_cast<ChangeLogFormat::FileHeader*>(mapping_)->committed)
+                .store(committed_.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+    }
+
+    void close() noexcept {
+        if (mapping_) {
+            ::munmap(mapping_, capacity_);
+        }
+        if (fd_ >= 0) {
+            // Drop the unused tail reserved by the last growth step
+            if (!failed_) {
+                [[maybe_unused]] const auto result = ::ftruncate(fd_, static_cast<off_t>(committed_.load()));
+            }
+            ::close(fd_);
+        }
+    }
+#else
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "w+b");
+        if (!file_) {
+            return false;
+        }
+
+        ChangeLogFormat::FileHeader header{};
+        std::memcpy(header.magic, "ECSCDC", 7);
+        header.version = ChangeLogFormat::VERSION;
+        header.committed = sizeof(header);
+        committed_ = sizeof(header);
+        return std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    }
+
+    void write(const char* data, const std::size_t size) {
+        const auto at = committed_.load(std::memory_order_relaxed);
+        if (failed_ || std::fseek(file_, static_cast<long>(at), SEEK_SET) != 0 ||
+            std::fwrite(data, 1, size, file_) != size) {
+            failed_ = true;
+            return;
+        }
+        committed_.store(at + size, std::memory_order_release);
+    }
+
+    void sync_header() noexcept {
+        const auto committed = committed_.load(std::memory_order_relaxed);
+        std::fflush(file_);
+        if (std::fseek(file_, static_cast<long>(offsetof(ChangeLogFormat::FileHeader, committed)), SEEK_SET) == 0) {
+            std::fwrite(&committed, sizeof(committed), 1, file_);
+            std::fflush(file_);
+        }
+    }
+
+    void close() noexcept {
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+#endif
+};
+
+/**
+ * @brief One record of a change log; pointers refer to the reader's buffer until the next poll()
+ *
+ * `blob_size` is the number of bytes the custom serializers wrote, without
+ * the record's alignment padding.
+ */
+struct ChangeEvent {
+    ChangeKind kind;
+    std::uint64_t tick;
+    std::uint32_t system;
+    std::uint32_t component;
+    EntityID id;
+    const char* record;
+    std::size_t record_size;
+    const char* blob;
+    std::size_t blob_size;
+};
+
+/**
+ * @brief Follows a change log written by another thread or process
+ *
+ * poll() reads the records committed since the previous call, so a tool can
+ * call it in a loop while the simulation keeps running. Component values
+ * can be loaded with the matching SnapshotSchema entry, e.g. through
+ * ComponentSchema::assign().
+ */
+class ChangeLogReader {
+public:
+    struct ComponentInfo {
+        std::string name;
+        std::uint64_t schema_hash;
+        std::uint64_t record_size;
+    };
+
+private:
+    std::FILE* file_{nullptr};
+    std::uint64_t offset_{sizeof(ChangeLogFormat::FileHeader)};
+    std::vector<char> buffer_;
+    std::vector<std::string> systems_;
+    std::vector<ComponentInfo> components_;
+    bool corrupt_{false};
+
+public:
+    ChangeLogReader() = default;
+    ChangeLogReader(const ChangeLogReader&) = delete;
+    ChangeLogReader& operator=(const ChangeLogReader&) = delete;
+
+    ~ChangeLogReader() {
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+
+    SnapshotStatus open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) {
+            return SnapshotStatus::OpenFailed;
+        }
+        // A buffered stream may answer a seek back to the header from stale data
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+
+        ChangeLogFormat::FileHeader header;
+        if (std::fread(&header, sizeof(header), 1, file_) != 1 || std::memcmp(header.magic, "ECSCDC", 7) != 0) {
+            return SnapshotStatus::BadHeader;
+        }
+        if (header.version != ChangeLogFormat::VERSION) {
+            return SnapshotStatus::VersionMismatch;
+        }
+        return SnapshotStatus::Ok;
+    }
+
+    const std::vector<std::string>& get_systems() const noexcept { return systems_; }
+    const std::vector<ComponentInfo>& get_components() const noexcept { return components_; }
+
+    /**
+     * @brief True once a damaged record was found; poll() stops there
+     */
+    bool is_corrupt() const noexcept { return corrupt_; }
+
+    /**
+     * @brief Calls `fn(const ChangeEvent&)` for every record committed since the last call; returns how many
+     */
+    template<typename Fn>
+    std::size_t poll(Fn&& fn) {
+        ChangeLogFormat::FileHeader header;
+        if (!file_ || corrupt_ || std::fseek(file_, 0, SEEK_SET) != 0 ||
+            std::fread(&header, sizeof(header), 1, file_) != 1 || header.committed <= offset_) {
+            return 0;
+        }
+
+        buffer_.resize(static_cast<std::size_t>(header.committed - offset_));
+        if (std::fseek(file_, static_cast<long>(offset_), SEEK_SET) != 0 ||
+            std::fread(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+            return 0;
+        }
+
+        std::size_t count = 0;
+        std::size_t at = 0;
+        while (at < buffer_.size()) {
+            ChangeLogFormat::RecordHeader record;
+            if (sizeof(record) > buffer_.size() - at) {
+                corrupt_ = true;
+                break;
+            }
+            std::memcpy(&record, buffer_.data() + at, sizeof(record));
+            if (record.size < sizeof(record) || record.size > buffer_.size() - at || record.size % 8 != 0) {
+                corrupt_ = true;
+                break;
+            }
+
+            const char* payload = buffer_.data() + at + sizeof(record);
+            const std::size_t payload_size = record.size - sizeof(record);
+            at += record.size;
+
+            if (record.kind == ChangeKind::Schema) {
+                if (!read_schema(payload, payload_size)) {
+                    corrupt_ = true;
+                    break;
+                }
+                continue;
+            }
+
+            ChangeEvent event{record.kind, record.tick, record.system, record.component, record.id,
+                              nullptr, 0, nullptr, 0};
+            if (record.kind == ChangeKind::ComponentAdded || record.kind == ChangeKind::ComponentWritten) {
+                if (record.component >= components_.size() ||
+                    components_[record.component].record_size > payload_size ||
+                    record.blob_size > payload_size - components_[record.component].record_size) {
+                    corrupt_ = true;
+                    break;
+                }
+                event.record = payload;
+                event.record_size = static_cast<std::size_t>(components_[record.component].record_size);
+                event.blob = payload + event.record_size;
+                event.blob_size = record.blob_size;
+            }
+            fn(static_cast<const ChangeEvent&>(event));
+            ++count;
+        }
+        offset_ += at;
+        return count;
+    }
+
+private:
+    bool read_schema(const char* payload, const std::size_t size) {
+        SnapshotReader in(payload, size);
+        std::uint32_t system_count = 0;
+        if (!in.read(system_count) || system_count > size) {
+            return false;
+        }
+        systems_.resize(system_count);
+        for (auto& name : systems_) {
+            if (!in.read_string(name)) {
+                return false;
+            }
+        }
+
+        std::uint32_t component_count = 0;
+        if (!in.read(component_count) || component_count > size) {
+            return false;
+        }
+        components_.resize(component_count);
+        for (auto& component : components_) {
+            if (!in.read_string(component.name) || !in.read(component.schema_hash) || !in.read(component.record_size)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_CHANGE_LOG_HPP
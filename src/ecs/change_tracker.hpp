@@ -0,0 +1,87 @@
+#ifndef GAME_ECS_CHANGE_TRACKER_HPP
+#define GAME_ECS_CHANGE_TRACKER_HPP
+
+#include "entity.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <typeindex>
+#include <unordered_set>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Records which entity ID chunks of a system changed since the last take()
+ *
+ * A chunk is a run of `1 << chunk_shift` consecutive entity IDs. Attached to
+ * a system as an EntityObserver, the tracker marks an entity's chunk dirty
+ * when the entity is created or removed and when one of its components is
+ * added, removed or written; removed IDs are also listed so a delta can
+ * replay the removal. Writes through a raw component pointer are only seen
+ * when they go through write_component() or mark_written().
+ */
+class ChangeTracker : public EntityObserver {
+    std::uint32_t chunk_shift_;
+    std::unordered_set<std::uint64_t> dirty_;
+    std::vector<EntityID> removed_;
+
+public:
+    explicit ChangeTracker(const std::uint32_t chunk_shift = 6)
+        : chunk_shift_(chunk_shift) {}
+
+    std::uint32_t get_chunk_shift() const noexcept { return chunk_shift_; }
+    std::uint64_t chunk_of(const EntityID id) const noexcept { return id >> chunk_shift_; }
+    EntityID chunk_begin(const std::uint64_t chunk) const noexcept { return chunk << chunk_shift_; }
+    EntityID chunk_end(const std::uint64_t chunk) const noexcept { return (chunk + 1) << chunk_shift_; }
+
+    bool has_changes() const noexcept { return !dirty_.empty(); }
+    std::size_t get_dirty_chunk_count() const noexcept { return dirty_.size(); }
+
+    void mark(const EntityID id) {
+        dirty_.insert(chunk_of(id));
+    }
+
+    /**
+     * @brief Moves out the dirty chunks in ascending order and the sorted removed IDs, then resets
+     */
+    void take(std::vector<std::uint64_t>& chunks, std::vector<EntityID>& removed) {
+        chunks.assign(dirty_.begin(), dirty_.end());
+        std::sort(chunks.begin(), chunks.end());
+        removed.swap(removed_);
+        std::sort(removed.begin(), removed.end());
+        removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+        clear();
+    }
+
+    void clear() noexcept {
+        dirty_.clear();
+        removed_.clear();
+    }
+
+    void on_entity_added(Entity& entity) noexcept override {
+        mark(entity.get_id());
+    }
+
+    void on_entity_removed(Entity& entity) noexcept override {
+        mark(entity.get_id());
+        removed_.push_back(entity.get_id());
+    }
+
+    void on_component_added(Entity& entity, const std::type_index&) noexcept override {
+        mark(entity.get_id());
+    }
+
+    void on_component_removed(Entity& entity, const std::type_index&) noexcept override {
+        mark(entity.get_id());
+    }
+
+    void on_component_written(Entity& entity, const std::type_index&) noexcept override {
+        mark(entity.get_id());
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_CHANGE_TRACKER_HPP
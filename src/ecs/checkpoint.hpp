@@ -0,0 +1,480 @@
+#ifndef GAME_ECS_CHECKPOINT_HPP
+#define GAME_ECS_CHECKPOINT_HPP
+
+#include "change_tracker.hpp"
+#include "snapshot.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Tuning for DeltaCheckpointer
+ *
+ * `compact_after` deltas are folded into the base file once that many have
+ * been written. Without `background` every file is written on the calling
+ * thread.
+ */
+struct CheckpointOptions {
+    std::uint32_t compact_after{8};
+    std::uint32_t chunk_shift{6};
+    bool background{true};
+};
+
+/**
+ * @brief Periodic checkpoints that write only what changed since the previous one
+ *
+ * The first checkpoint() writes a Full snapshot to `<path>.base`. Each later
+ * one asks the ChangeTracker attached to every registered system for the ID
+ * chunks touched since the last checkpoint and writes their live entities,
+ * plus the IDs removed in the meantime, as a Delta snapshot to
+ * `<path>.delta.<sequence>`. Encoding happens on the calling thread so it
+ * sees a consistent world; the buffers are then handed to a writer thread,
+ * so the tick never waits on disk. The writer also compacts: after
+ * `compact_after` deltas it folds them into a new base at the byte level
+ * and deletes them. Files are written under a temporary name and renamed,
+ * so a crash leaves either the old or the new file. restore() loads the base
+ * and replays the deltas that follow it.
+ *
+ * A delta only makes sense on top of every delta before it, so after a
+ * failed write the writer drops the deltas still queued and the next
+ * checkpoint() writes a full base instead. flush() reports the failure.
+ *
+ * Component writes are only tracked when they go through write_component()
+ * or mark_written(); call checkpoint_full() after untracked bulk edits.
+ */
+class DeltaCheckpointer {
+    struct Tracked {
+        const SnapshotSchema::SystemEntry* entry;
+        System* system;
+        std::unique_ptr<ChangeTracker> tracker;
+    };
+
+    struct Job {
+        std::vector<char> data;
+        std::uint64_t sequence;
+        Snapshot::Kind kind;
+    };
+
+    World& world_;
+    const SnapshotSchema& schema_;
+    std::string path_;
+    CheckpointOptions options_;
+    std::vector<Tracked> tracked_;
+    std::uint64_t sequence_{0};
+
+    // Scratch reused by every delta
+    std::vector<std::uint64_t> chunks_;
+    std::vector<Snapshot::Selection> selections_;
+
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable idle_;
+    std::deque<Job> jobs_;
+    bool busy_{false};
+    bool stopping_{false};
+    bool needs_full_{true}; // Until a base is submitted, and again after a failed write
+    SnapshotStatus flush_status_{SnapshotStatus::Ok};
+
+    // Owned by whichever thread writes files
+    std::vector<std::uint64_t> deltas_;
+    bool chain_broken_{false};
+    SnapshotStatus last_status_{SnapshotStatus::Ok};
+    std::uint64_t bytes_written_{0};
+    std::size_t compaction_count_{0};
+
+public:
+    DeltaCheckpointer(World& world, const SnapshotSchema& schema, std::string path,
+                      const CheckpointOptions& options = {})
+        : world_(world)
+        , schema_(schema)
+        , path_(std::move(path))
+        , options_(options) {
+        for (const auto& entry : schema_.get_systems()) {
+            if (auto* system = entry.get(world_)) {
+                auto tracker = std::make_unique<ChangeTracker>(options_.chunk_shift);
+                system->attach_observer(tracker.get());
+                tracked_.push_back({&entry, system, std::move(tracker)});
+            }
+        }
+
+        // Continue numbering after any files left by an earlier run so none of them is replayed by mistake
+        sequence_ = latest_sequence(path_);
+
+        if (options_.background) {
+            writer_ = std::thread([this] { work(); });
+        }
+    }
+
+    DeltaCheckpointer(const DeltaCheckpointer&) = delete;
+    DeltaCheckpointer& operator=(const DeltaCheckpointer&) = delete;
+
+    ~DeltaCheckpointer() {
+        if (writer_.joinable()) {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            work_available_.notify_all();
+            writer_.join();
+        }
+        for (auto& tracked : tracked_) {
+            tracked.system->detach_observer(tracked.tracker.get());
+        }
+    }
+
+    const std::string& get_path() const noexcept { return path_; }
+    std::uint64_t get_sequence() const noexcept { return sequence_; }
+
+    std::size_t get_thread_count() const noexcept { return writer_.joinable() ? 1 : 0; }
+
+    /**
+     * @brief Waits until the writer is between files and keeps it there while the returned lock is held
+     *
+     * Queued deltas stay queued. Used before fork() so the writer is not
+     * allocating or holding a lock when the process is copied.
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> quiesce() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return !busy_; });
+        return lock;
+    }
+
+    std::string base_path() const { return base_path(path_); }
+    std::string delta_path(const std::uint64_t sequence) const { return delta_path(path_, sequence); }
+
+    static std::string base_path(const std::string& path) { return path + ".base"; }
+
+    static std::string delta_path(const std::string& path, const std::uint64_t sequence) {
+        return path + ".delta." + std::to_string(sequence);
+    }
+
+    /**
+     * @brief Writes a delta of everything changed since the previous checkpoint, or a base if one is needed
+     *
+     * A base is needed before the first delta and after any failed write.
+     * Returns the checkpoint's sequence number.
+     */
+    std::uint64_t checkpoint() {
+        bool full;
+        {
+            std::lock_guard lock(mutex_);
+            full = needs_full_;
+        }
+        if (full) {
+            return checkpoint_full();
+        }
+
+        selections_.clear();
+        for (auto& tracked : tracked_) {
+            Snapshot::Selection selection{tracked.entry, tracked.system, {}, {}};
+            tracked.tracker->take(chunks_, selection.removed);
+
+            // Chunks are sorted and walked in ID order, so the entities come out sorted as well
+            for (const auto chunk : chunks_) {
+                const auto end = tracked.tracker->chunk_end(chunk);
+                for (auto id = tracked.tracker->chunk_begin(chunk); id < end; ++id) {
+                    if (const auto* entity = tracked.system->get_entity(id)) {
+                        selection.entities.push_back(entity);
+                    }
+                }
+            }
+            selections_.push_back(std::move(selection));
+        }
+
+        Job job{{}, ++sequence_, Snapshot::Kind::Delta};
+        Snapshot::encode(schema_, job.kind, job.sequence, world_.get_tick_count(), selections_, job.data);
+        submit(std::move(job));
+        return sequence_;
+    }
+
+    /**
+     * @brief Writes a new base holding the whole world; the deltas before it are deleted
+     */
+    std::uint64_t checkpoint_full() {
+        for (auto& tracked : tracked_) {
+            tracked.tracker->clear();
+        }
+
+        Job job{{}, ++sequence_, Snapshot::Kind::Full};
+        Snapshot::encode(world_, schema_, job.data, job.sequence);
+        {
+            std::lock_guard lock(mutex_);
+            needs_full_ = false;
+        }
+        submit(std::move(job));
+        return sequence_;
+    }
+
+    /**
+     * @brief Blocks until every submitted checkpoint is written; returns the first failure since the previous flush()
+     */
+    SnapshotStatus flush() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+        return std::exchange(flush_status_, SnapshotStatus::Ok);
+    }
+
+    /**
+     * @brief First failure since construction; flush() first to include pending writes
+     */
+    SnapshotStatus get_last_status() {
+        std::lock_guard lock(mutex_);
+        return last_status_;
+    }
+
+    std::uint64_t get_bytes_written() {
+        std::lock_guard lock(mutex_);
+        return bytes_written_;
+    }
+
+    std::size_t get_compaction_count() {
+        std::lock_guard lock(mutex_);
+        return compaction_count_;
+    }
+
+    /**
+     * @brief Loads `<path>.base` into `world` and applies the consecutive deltas that follow it
+     *
+     * Returns Truncated, with the world restored up to the gap, if a delta
+     * is missing but later ones exist.
+     */
+    static SnapshotStatus restore(World& world, const SnapshotSchema& schema, const std::string& path) {
+        std::uint64_t sequence = 0;
+        {
+            MappedFile base(base_path(path));
+            if (!base.data()) {
+                return SnapshotStatus::OpenFailed;
+            }
+            Snapshot::FileHeader header;
+            auto status = Snapshot::read_header(base.data(), base.size(), header);
+            if (status == SnapshotStatus::Ok && header.kind != Snapshot::Kind::Full) {
+                status = SnapshotStatus::BadHeader;
+            }
+            if (status == SnapshotStatus::Ok) {
+                status = Snapshot::decode(world, schema, base.data(), base.size());
+            }
+            if (status != SnapshotStatus::Ok) {
+                return status;
+            }
+            sequence = header.sequence;
+        }
+
+        for (;;) {
+            MappedFile delta(delta_path(path, ++sequence));
+            if (!delta.data()) {
+                bool later = false;
+                for_each_delta(path, [&](const std::filesystem::path&, const std::uint64_t found) {
+                    later = later || found > sequence;
+                });
+                return later ? SnapshotStatus::Truncated : SnapshotStatus::Ok;
+            }
+            Snapshot::FileHeader header;
+            auto status = Snapshot::read_header(delta.data(), delta.size(), header);
+            if (status == SnapshotStatus::Ok && (header.kind != Snapshot::Kind::Delta || header.sequence != sequence)) {
+                status = SnapshotStatus::BadHeader;
+            }
+            if (status == SnapshotStatus::Ok) {
+                status = Snapshot::decode(world, schema, delta.data(), delta.size());
+            }
+            if (status != SnapshotStatus::Ok) {
+                return status;
+            }
+        }
+    }
+
+private:
+    void submit(Job&& job) {
+        if (!writer_.joinable()) {
+            write(job);
+            return;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        work_available_.notify_one();
+    }
+
+    void work() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock lock(mutex_);
+                work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return; // Only stop once everything submitted is written
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+                busy_ = true;
+            }
+
+            write(job);
+
+            {
+                std::lock_guard lock(mutex_);
+                busy_ = false;
+            }
+            idle_.notify_all();
+        }
+    }
+
+    void write(const Job& job) {
+        const bool full = job.kind == Snapshot::Kind::Full;
+        if (!full && chain_broken_) {
+            return; // It would follow a missing file; the next base covers its changes
+        }
+
+        const auto path = full ? base_path() : delta_path(job.sequence);
+        if (!write_atomic(path, job.data.data(), job.data.size())) {
+            chain_broken_ = true;
+            std::lock_guard lock(mutex_);
+            needs_full_ = true;
+            return;
+        }
+
+        if (full) {
+            chain_broken_ = false;
+            remove_deltas_before(job.sequence);
+            deltas_.clear();
+            return;
+        }
+
+        deltas_.push_back(job.sequence);
+        if (deltas_.size() >= options_.compact_after) {
+            compact();
+        }
+    }
+
+    void compact() {
+        std::vector<char> out;
+        {
+            MappedFile base(base_path());
+            std::vector<std::unique_ptr<MappedFile>> files;
+            std::vector<std::pair<const char*, std::size_t>> deltas;
+            for (const auto sequence : deltas_) {
+                files.push_back(std::make_unique<MappedFile>(delta_path(sequence)));
+                deltas.emplace_back(files.back()->data(), files.back()->size());
+                if (!files.back()->data()) {
+                    return record(SnapshotStatus::OpenFailed, 0);
+                }
+            }
+            if (!base.data()) {
+                return record(SnapshotStatus::OpenFailed, 0);
+            }
+
+            const auto status = Snapshot::compact(schema_, base.data(), base.size(), deltas, out);
+            if (status != SnapshotStatus::Ok) {
+                return record(status, 0);
+            }
+        }
+
+        if (write_atomic(base_path(), out.data(), out.size())) {
+            remove_deltas_before(deltas_.back() + 1);
+            deltas_.clear();
+            std::lock_guard lock(mutex_);
+            ++compaction_count_;
+        }
+    }
+
+    bool write_atomic(const std::string& path, const char* data, const std::size_t size) {
+        const auto temporary = path + ".tmp";
+        auto status = Snapshot::write_file(temporary, data, size);
+        if (status == SnapshotStatus::Ok) {
+            std::error_code error;
+            std::filesystem::rename(temporary, path, error);
+            status = error ? SnapshotStatus::WriteFailed : SnapshotStatus::Ok;
+        }
+        record(status, status == SnapshotStatus::Ok ? size : 0);
+        return status == SnapshotStatus::Ok;
+    }
+
+    void record(const SnapshotStatus status, const std::uint64_t bytes) {
+        std::lock_guard lock(mutex_);
+        if (last_status_ == SnapshotStatus::Ok) {
+            last_status_ = status;
+        }
+        if (flush_status_ == SnapshotStatus::Ok) {
+            flush_status_ = status;
+        }
+        bytes_written_ += bytes;
+    }
+
+    void remove_deltas_before(const std::uint64_t sequence) const {
+        std::vector<std::filesystem::path> stale;
+        for_each_delta(path_, [&](const std::filesystem::path& file, const std::uint64_t delta) {
+            if (delta < sequence) {
+                stale.push_back(file);
+            }
+        });
+        for (const auto& file : stale) {
+            std::error_code error;
+            std::filesystem::remove(file, error);
+        }
+    }
+
+    static std::uint64_t latest_sequence(const std::string& path) {
+        std::uint64_t latest = 0;
+        {
+            MappedFile base(base_path(path));
+            Snapshot::FileHeader header;
+            if (base.data() && Snapshot::read_header(base.data(), base.size(), header) == SnapshotStatus::Ok) {
+                latest = header.sequence;
+            }
+        }
+        for_each_delta(path, [&](const std::filesystem::path&, const std::uint64_t sequence) {
+            latest = std::max(latest, sequence);
+        });
+        return latest;
+    }
+
+    /**
+     * @brief Calls `fn(file, sequence)` for every `<path>.delta.<sequence>` on disk
+     */
+    template<typename Fn>
+    static void for_each_delta(const std::string& path, Fn&& fn) {
+        const std::filesystem::path base(path);
+        auto directory = base.parent_path();
+        if (directory.empty()) {
+            directory = ".";
+        }
+        const auto prefix = base.filename().string() + ".delta.";
+
+        std::error_code error;
+        for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            const auto name = it->path().filename().string();
+            if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+
+            std::uint64_t sequence = 0;
+            bool digits = true;
+            for (auto i = prefix.size(); i < name.size() && digits; ++i) {
+                digits = name[i] >= '0' && name[i] <= '9';
+                sequence = sequence * 10 + static_cast<std::uint64_t>(name[i] - '0');
+            }
+            if (digits) {
+                fn(it->path(), sequence);
+            }
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_CHECKPOINT_HPP
@@ -0,0 +1,283 @@
+#ifndef GAME_ECS_CHECKSUM_HPP
+#define GAME_ECS_CHECKSUM_HPP
+
+#include "change_tracker.hpp"
+#include "random.hpp"
+#include "snapshot.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAME_ECS_CHECKSUM_SSE 1
+#endif
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Hash of a whole world that is kept up to date from component writes
+ *
+ * The world is hashed per ID chunk (`1 << chunk_shift` consecutive entity
+ * IDs) of every system in the schema. A chunk's entities are serialized with
+ * the schema in ID order and hashed four 64-bit lanes at a time, with SSE2
+ * where available; the scalar path gives the same result. The world value is
+ * the wrapping sum of the mixed chunk hashes, so update() only rehashes the
+ * chunks a ChangeTracker saw change and swaps their old contribution for the
+ * new one. The tick count and each system's next entity ID are folded into
+ * the returned value. compute_full() rehashes everything and must agree with
+ * update(); a mismatch means some write bypassed write_component() or
+ * mark_written().
+ *
+ * Peers in lockstep compare update() every tick; the value only depends on
+ * the saved component data, never on pointers or hash map layout.
+ */
+class WorldChecksum {
+    struct Tracked {
+        System* system;
+        std::uint64_t salt;
+        std::unique_ptr<ChangeTracker> tracker;
+        std::unordered_map<std::uint64_t, std::uint64_t> chunks;
+    };
+
+    World& world_;
+    const SnapshotSchema& schema_;
+    std::uint32_t chunk_shift_;
+    std::vector<Tracked> tracked_;
+    std::uint64_t content_{0};
+    std::size_t last_rehashed_{0};
+
+    // Scratch reused by every chunk
+    std::vector<std::uint64_t> dirty_;
+    std::vector<EntityID> removed_;
+    std::vector<char> bytes_;
+    std::vector<char> blob_;
+
+public:
+    WorldChecksum(World& world, const SnapshotSchema& schema, const std::uint32_t chunk_shift = 6)
+        : world_(world)
+        , schema_(schema)
+        , chunk_shift_(chunk_shift) {
+        for (const auto& entry : schema_.get_systems()) {
+            if (auto* system = entry.get(world_)) {
+                auto tracker = std::make_unique<ChangeTracker>(chunk_shift_);
+                system->attach_observer(tracker.get());
+                tracked_.push_back({system, entry.name_hash, std::move(tracker), {}});
+            }
+        }
+        rebuild();
+    }
+
+    WorldChecksum(const WorldChecksum&) = delete;
+    WorldChecksum& operator=(const WorldChecksum&) = delete;
+
+    ~WorldChecksum() {
+        for (auto& tracked : tracked_) {
+            tracked.system->detach_observer(tracked.tracker.get());
+        }
+    }
+
+    /**
+     * @brief Number of chunks the last update() rehashed
+     */
+    std::size_t get_last_rehashed_chunks() const noexcept { return last_rehashed_; }
+
+    /**
+     * @brief Rehashes the chunks changed since the previous call and returns the world checksum
+     */
+    std::uint64_t update() {
+        last_rehashed_ = 0;
+        for (auto& tracked : tracked_) {
+            tracked.tracker->take(dirty_, removed_);
+            for (const auto chunk : dirty_) {
+                auto& contribution = tracked.chunks[chunk];
+                content_ -= contribution;
+                contribution = hash_chunk(tracked, chunk);
+                content_ += contribution;
+                if (contribution == 0) {
+                    tracked.chunks.erase(chunk);
+                }
+            }
+            last_rehashed_ += dirty_.size();
+        }
+        return finish(content_);
+    }
+
+    /**
+     * @brief Rehashes the whole world without touching the incremental state
+     */
+    std::uint64_t compute_full() {
+        std::uint64_t content = 0;
+        for (auto& tracked : tracked_) {
+            for (const auto chunk : live_chunks(*tracked.system)) {
+                content += hash_chunk(tracked, chunk);
+            }
+        }
+        return finish(content);
+    }
+
+    /**
+     * @brief Drops the incremental state and rehashes everything, e.g. after untracked bulk edits
+     */
+    std::uint64_t rebuild() {
+        content_ = 0;
+        last_rehashed_ = 0;
+        for (auto& tracked : tracked_) {
+            tracked.tracker->clear();
+            tracked.chunks.clear();
+            for (const auto chunk : live_chunks(*tracked.system)) {
+                const auto contribution = hash_chunk(tracked, chunk);
+                tracked.chunks.emplace(chunk, contribution);
+                content_ += contribution;
+                ++last_rehashed_;
+            }
+        }
+        return finish(content_);
+    }
+
+    /**
+     * @brief Hashes `size` bytes; four 64-bit lanes per 32-byte stripe, keyed by the stripe's position
+     */
+    static std::uint64_t hash_bytes(const char* data, const std::size_t size, const std::uint64_t seed) noexcept {
+        constexpr std::uint64_t keys[4] = {0x9E3779B185EBCA87ull, 0xC2B2AE3D27D4EB4Full,
+                                           0x165667B19E3779F9ull, 0x85EBCA77C2B2AE63ull};
+        constexpr std::uint64_t step = 0x27D4EB2F165667C5ull;
+        constexpr std::size_t stripe = 32;
+
+        char tail[stripe] = {};
+        const std::size_t full = size / stripe;
+        const std::size_t rest = size % stripe;
+        if (rest > 0) {
+            std::memcpy(tail, data + full * stripe, rest);
+        }
+        const std::size_t stripes = full + (rest > 0 ? 1 : 0);
+
+        std::uint64_t acc[4];
+        for (int i = 0; i < 4; ++i) {
+            acc[i] = seed ^ keys[i];
+        }
+
+        std::size_t s = 0;
+
+#ifdef GAME_ECS_CHECKSUM_SSE
+        __m128i acc_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc));
+        __m128i acc_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2));
+        __m128i key_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+        __m128i key_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 2));
+        const __m128i key_step = _mm_set1_epi64x(static_cast<long long>(step));
+
+        const auto accumulate = [](__m128i acc_half, const __m128i values, const __m128i key) {
+            const __m128i keyed = _mm_xor_si128(values, key);
+            const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            const __m128i swapped = _mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2));
+            return _mm_add_epi64(acc_half, _mm_add_epi64(product, swapped));
+        };
+
+        for (; s < stripes; ++s) {
+            const char* in = s < full ? data + s * stripe : tail;
+            acc_lo = accumulate(acc_lo, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), key_lo);
+            acc_hi = accumulate(acc_hi, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), key_hi);
+            key_lo = _mm_add_epi64(key_lo, key_step);
+            key_hi = _mm_add_epi64(key_hi, key_step);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), acc_lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2), acc_hi);
+#endif
+
+        for (; s < stripes; ++s) {
+            const char* in = s < full ? data + s * stripe : tail;
+            std::uint64_t values[4];
+            std::memcpy(values, in, stripe);
+            for (int i = 0; i < 4; ++i) {
+                const std::uint64_t keyed = values[i] ^ (keys[i] + s * step);
+                acc[i] += (keyed & 0xFFFFFFFFull) * (keyed >> 32) + values[i ^ 1];
+            }
+        }
+
+        std::uint64_t hash = RandomStream::mix(seed ^ size);
+        for (int i = 0; i < 4; ++i) {
+            hash = RandomStream::mix(hash ^ acc[i]);
+        }
+        return hash;
+    }
+
+private:
+    std::uint64_t finish(std::uint64_t content) const noexcept {
+        content = RandomStream::mix(content + world_.get_tick_count());
+        for (const auto& tracked : tracked_) {
+            content = RandomStream::mix(content ^ tracked.system->get_next_entity_id());
+        }
+        return content;
+    }
+
+    std::vector<std::uint64_t> live_chunks(const System& system) const {
+        std::vector<std::uint64_t> chunks;
+        chunks.reserve(system.get_entities().size());
+        for (const auto& [id, _] : system.get_entities()) {
+            chunks.push_back(id >> chunk_shift_);
+        }
+        std::sort(chunks.begin(), chunks.end());
+        chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+        return chunks;
+    }
+
+    // Mixed hash of one chunk's live entities; 0 when the chunk is empty
+    std::uint64_t hash_chunk(const Tracked& tracked, const std::uint64_t chunk) {
+        const auto& components = schema_.get_components();
+        const EntityID begin = chunk << chunk_shift_;
+        const EntityID end = (chunk + 1) << chunk_shift_;
+
+        bytes_.clear();
+        for (auto id = begin; id < end; ++id) {
+            const auto* entity = tracked.system->get_entity(id);
+            if (!entity) {
+                continue;
+            }
+
+            append(&id, sizeof(id));
+            const auto& owned = entity->get_components();
+            for (std::uint32_t i = 0; i < components.size(); ++i) {
+                const auto it = owned.find(components[i]->get_type());
+                if (it == owned.end()) {
+                    continue;
+                }
+
+                // Records are zeroed first so padding between fields hashes the same everywhere
+                const auto record_size = components[i]->get_record_size();
+                const auto at = bytes_.size();
+                append(&i, sizeof(i));
+                bytes_.resize(at + sizeof(i) + record_size, 0);
+
+                blob_.clear();
+                SnapshotWriter blob(blob_);
+                components[i]->save(*it->second, bytes_.data() + at + sizeof(i), blob);
+
+                const auto blob_size = static_cast<std::uint64_t>(blob_.size());
+                append(&blob_size, sizeof(blob_size));
+                append(blob_.data(), blob_.size());
+            }
+        }
+
+        if (bytes_.empty()) {
+            return 0;
+        }
+        return RandomStream::mix(hash_bytes(bytes_.data(), bytes_.size(), tracked.salt) + chunk);
+    }
+
+    void append(const void* data, const std::size_t size) {
+        const auto* bytes = static_cast<const char*>(data);
+        bytes_.insert(bytes_.end(), bytes, bytes + size);
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_CHECKSUM_HPP
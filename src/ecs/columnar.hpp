@@ -0,0 +1,959 @@
+#ifndef GAME_ECS_COLUMNAR_HPP
+#define GAME_ECS_COLUMNAR_HPP
+
+#include "component.hpp"
+#include "entity.hpp"
+#include "snapshot.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief How the values of an exported column are stored
+ *
+ * String columns hold 32-bit indices into the column's dictionary.
+ */
+enum class ColumnKind : std::uint8_t {
+    Bool = 1,
+    Int = 2,
+    UInt = 3,
+    Float = 4,
+    String = 5
+};
+
+/**
+ * @brief The exported columns of one component type
+ */
+class ColumnarComponent {
+public:
+    struct Field {
+        std::string name;
+        ColumnKind kind;
+        std::uint32_t size;
+        std::size_t offset;
+        std::function<std::string_view(const Component&)> text;
+    };
+
+protected:
+    std::string name_;
+    std::type_index type_;
+    std::vector<Field> fields_;
+
+    ColumnarComponent(const std::string_view name, const std::type_index type)
+        : name_(name)
+        , type_(type) {}
+
+public:
+    virtual ~ColumnarComponent() = default;
+
+    const std::string& get_name() const noexcept { return name_; }
+    const std::type_index& get_type() const noexcept { return type_; }
+    const std::vector<Field>& get_fields() const noexcept { return fields_; }
+};
+
+template<typename T>
+class ColumnarComponentOf : public ColumnarComponent {
+public:
+    explicit ColumnarComponentOf(const std::string_view name)
+        : ColumnarComponent(name, std::type_index(typeid(T))) {
+        static_assert(std::is_base_of_v<Component, T>, "T must inherit Component");
+        static_assert(std::is_default_constructible_v<T>, "T must be default constructible to find member offsets");
+    }
+
+    /**
+     * @brief Exports an arithmetic or enum member as is
+     */
+    template<typename F>
+    ColumnarComponentOf& column(const std::string_view name, F T::*member) {
+        static_assert(std::is_arithmetic_v<F> || std::is_enum_v<F>, "Use string() for text members");
+
+        const T sample{};
+        const auto offset = static_cast<std::size_t>(
+            reinterpret_cast<const char*>(&(sample.*member)) - reinterpret_cast<const char*>(&sample));
+        fields_.push_back({std::string(name), kind_of<F>(), static_cast<std::uint32_t>(sizeof(F)), offset, {}});
+        return *this;
+    }
+
+    /**
+     * @brief Exports a string member as a dictionary-encoded column
+     */
+    ColumnarComponentOf& string(const std::string_view name, std::string T::*member) {
+        return string(name, [member](const T& value) { return std::string_view(value.*member); });
+    }
+
+    /**
+     * @brief Exports text computed from the component, e.g. an enum's name, as a dictionary-encoded column
+     */
+    ColumnarComponentOf& string(const std::string_view name, std::function<std::string_view(const T&)> text) {
+        fields_.push_back({std::string(name), ColumnKind::String, static_cast<std::uint32_t>(sizeof(std::uint32_t)), 0,
+                           [text = std::move(text)](const Component& component) {
+                               return text(static_cast<const T&>(component));
+                           }});
+        return *this;
+    }
+
+private:
+    template<typename F>
+    static constexpr ColumnKind kind_of() noexcept {
+        if constexpr (std::is_same_v<F, bool>) {
+            return ColumnKind::Bool;
+        } else if constexpr (std::is_enum_v<F>) {
+            return std::is_signed_v<std::underlying_type_t<F>> ? ColumnKind::Int : ColumnKind::UInt;
+        } else if constexpr (std::is_floating_point_v<F>) {
+            return ColumnKind::Float;
+        } else {
+            return std::is_signed_v<F> ? ColumnKind::Int : ColumnKind::UInt;
+        }
+    }
+};
+
+/**
+ * @brief The systems and component columns a ColumnarExporter writes
+ */
+class ColumnarSchema {
+public:
+    struct SystemEntry {
+        std::string name;
+        System* (*get)(World&);
+    };
+
+private:
+    std::vector<SystemEntry> systems_;
+    std::vector<std::unique_ptr<ColumnarComponent>> components_;
+
+public:
+    template<typename T>
+    void add_system(const std::string_view name) {
+        static_assert(std::is_base_of_v<System, T>, "T must inherit System");
+        systems_.push_back({std::string(name), [](World& world) -> System* {
+            return world.get_system<T>();
+        }});
+    }
+
+    template<typename T>
+    ColumnarComponentOf<T>& add_component(const std::string_view name) {
+        auto component = std::make_unique<ColumnarComponentOf<T>>(name);
+        auto& result = *component;
+        components_.push_back(std::move(component));
+        return result;
+    }
+
+    const std::vector<SystemEntry>& get_systems() const noexcept { return systems_; }
+    const std::vector<std::unique_ptr<ColumnarComponent>>& get_components() const noexcept { return components_; }
+};
+
+/**
+ * @brief On-disk layout shared by ColumnarExporter and ColumnarReader
+ *
+ * A file is a FileHeader followed by messages, each a MessageHeader and a
+ * body padded to 8 bytes (native endianness):
+ *
+ *     Schema      system and component names, each field's name, kind and size
+ *     Dictionary  DictionaryHeader, uint32 offset[count + 1], chars
+ *     Batch       BatchHeader, EntityID[rows], uint8 present[components],
+ *                 per present component: validity bitmap, then each field's values
+ *
+ * A batch holds one system's entities at one tick, in no particular order.
+ * A component's validity bit is set for the rows that have it; the values
+ * of the other rows are zero. Dictionary messages append the strings a
+ * column's following batches refer to for the first time, so every string
+ * is stored once per file. Every buffer starts 8-byte aligned.
+ */
+class Columnar {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    enum class Message : std::uint32_t { Schema = 1, Dictionary = 2, Batch = 3 };
+
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+    };
+
+    struct MessageHeader {
+        Message kind;
+        std::uint32_t reserved;
+        std::uint64_t size;
+    };
+
+    struct DictionaryHeader {
+        std::uint32_t field;
+        std::uint32_t count;
+        std::uint64_t first;
+        std::uint64_t chars_size;
+    };
+
+    struct BatchHeader {
+        std::uint64_t tick;
+        std::uint32_t system;
+        std::uint32_t component_count;
+        std::uint64_t rows;
+    };
+
+    static constexpr std::size_t padded(const std::size_t size) noexcept {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    static constexpr std::size_t bitmap_size(const std::size_t rows) noexcept {
+        return (rows + 7) / 8;
+    }
+};
+
+/**
+ * @brief Tuning for ColumnarExporter
+ *
+ * At most `max_pending` ticks wait for the writer thread; export_tick()
+ * skips a tick rather than wait for the disk. Without `background` every
+ * tick is written on the calling thread.
+ */
+struct ColumnarOptions {
+    std::size_t max_pending{4};
+    bool background{true};
+};
+
+/**
+ * @brief Streams per-tick component columns to a file for offline analytics
+ *
+ * export_tick() copies the exported fields of every entity of the schema's
+ * systems into one column buffer per field, with memcpy at fixed member
+ * offsets, and string fields as raw characters. That copy is the only work
+ * on the calling thread. Components are stored per entity, so there is no
+ * column in memory to hand over directly; instead the filled buffers are
+ * moved to a writer thread and recycled once written, so steady-state
+ * exports allocate nothing. The writer dictionary-encodes string columns
+ * and writes each buffer straight from memory into the file. See Columnar
+ * for the layout and ColumnarReader to read it back.
+ */
+class ColumnarExporter {
+    struct Column {
+        std::vector<char> values;
+        std::vector<std::uint32_t> offsets;
+        std::vector<char> chars;
+    };
+
+    struct Part {
+        bool present{false};
+        std::vector<std::uint8_t> valid;
+        std::vector<Column> columns;
+    };
+
+    struct Batch {
+        std::uint32_t system{0};
+        std::vector<EntityID> ids;
+        std::vector<Part> parts;
+    };
+
+    struct Job {
+        std::uint64_t tick{0};
+        std::vector<Batch> batches;
+    };
+
+    World& world_;
+    const ColumnarSchema& schema_;
+    ColumnarOptions options_;
+    std::FILE* file_{nullptr};
+    std::vector<std::type_index> types_;
+    std::vector<std::size_t> first_field_;
+
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable idle_;
+    std::deque<Job> jobs_;
+    std::vector<Job> spare_;
+    bool busy_{false};
+    bool stopping_{false};
+    std::uint64_t exported_{0};
+    std::uint64_t dropped_{0};
+    SnapshotStatus last_status_{SnapshotStatus::Ok};
+    std::uint64_t bytes_written_{0};
+
+    // Owned by whichever thread writes
+    std::vector<std::unordered_map<std::string, std::uint32_t>> dictionaries_;
+    std::vector<std::uint32_t> new_offsets_;
+    std::vector<char> new_chars_;
+
+public:
+    ColumnarExporter(World& world, const ColumnarSchema& schema, const std::string& path,
+                     const ColumnarOptions& options = {})
+        : world_(world)
+        , schema_(schema)
+        , options_(options) {
+        std::size_t fields = 0;
+        for (const auto& component : schema_.get_components()) {
+            types_.push_back(component->get_type());
+            first_field_.push_back(fields);
+            fields += component->get_fields().size();
+        }
+        dictionaries_.resize(fields);
+
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) {
+            last_status_ = SnapshotStatus::OpenFailed;
+            return;
+        }
+        write_schema();
+
+        if (options_.background) {
+            writer_ = std::thread([this] { work(); });
+        }
+    }
+
+    ColumnarExporter(const ColumnarExporter&) = delete;
+    ColumnarExporter& operator=(const ColumnarExporter&) = delete;
+
+    ~ColumnarExporter() {
+        if (writer_.joinable()) {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            work_available_.notify_all();
+            writer_.join();
+        }
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+
+    /**
+     * @brief Queues the current state of the schema's systems; false if the tick was skipped
+     */
+    bool export_tick() {
+        Job job;
+        {
+            std::lock_guard lock(mutex_);
+            if (!file_ || jobs_.size() >= options_.max_pending) {
+                ++dropped_;
+                return false;
+            }
+            if (!spare_.empty()) {
+                job = std::move(spare_.back());
+                spare_.pop_back();
+            }
+        }
+
+        gather(job);
+
+        if (!writer_.joinable()) {
+            write(job);
+            std::lock_guard lock(mutex_);
+            ++exported_;
+            spare_.push_back(std::move(job));
+            return true;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(std::move(job));
+            ++exported_;
+        }
+        work_available_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Blocks until every queued tick is written
+     */
+    void flush() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+        if (file_) {
+            std::fflush(file_);
+        }
+    }
+
+    std::size_t get_thread_count() const noexcept { return writer_.joinable() ? 1 : 0; }
+
+    /**
+     * @brief Waits until the writer is between ticks and keeps it there while the returned lock is held
+     *
+     * Queued ticks stay queued, and export_tick() blocks until the lock is
+     * released. Used before fork() so the writer is not allocating or
+     * holding a lock when the process is copied.
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> quiesce() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return !busy_; });
+        return lock;
+    }
+
+    std::uint64_t get_exported_ticks() {
+        std::lock_guard lock(mutex_);
+        return exported_;
+    }
+
+    std::uint64_t get_dropped_ticks() {
+        std::lock_guard lock(mutex_);
+        return dropped_;
+    }
+
+    std::uint64_t get_bytes_written() {
+        std::lock_guard lock(mutex_);
+        return bytes_written_;
+    }
+
+    /**
+     * @brief First failure since construction; flush() first to include pending writes
+     */
+    SnapshotStatus get_last_status() {
+        std::lock_guard lock(mutex_);
+        return last_status_;
+    }
+
+private:
+    void gather(Job& job) const {
+        const auto& systems = schema_.get_systems();
+        const auto& components = schema_.get_components();
+
+        job.tick = world_.get_tick_count();
+        job.batches.resize(systems.size());
+        for (std::uint32_t s = 0; s < systems.size(); ++s) {
+            auto& batch = job.batches[s];
+            batch.system = s;
+            batch.ids.clear();
+            batch.parts.resize(components.size());
+            for (auto& part : batch.parts) {
+                part.present = false;
+            }
+
+            const auto* system = systems[s].get(world_);
+            if (!system) {
+                continue;
+            }
+
+            const auto rows = system->get_entities().size();
+            batch.ids.reserve(rows);
+            for (const auto& [id, entity] : system->get_entities()) {
+                const auto row = batch.ids.size();
+                batch.ids.push_back(id);
+
+                // Entities own few components, so scanning them beats hashing every exported type
+                for (const auto& [type, instance] : entity->get_components()) {
+                    const auto c = static_cast<std::size_t>(
+                        std::find(types_.begin(), types_.end(), type) - types_.begin());
+                    if (c == types_.size()) {
+                        continue;
+                    }
+
+                    auto& part = batch.parts[c];
+                    if (!part.present) {
+                        start(part, *components[c], rows);
+                    }
+                    part.valid[row / 8] |= static_cast<std::uint8_t>(1u << (row % 8));
+
+                    const auto* object = reinterpret_cast<const char*>(instance.get());
+                    const auto& fields = components[c]->get_fields();
+                    for (std::size_t f = 0; f < fields.size(); ++f) {
+                        auto& column = part.columns[f];
+                        if (fields[f].kind == ColumnKind::String) {
+                            const auto text = fields[f].text(*instance);
+                            column.chars.insert(column.chars.end(), text.begin(), text.end());
+                            column.offsets[row + 1] = static_cast<std::uint32_t>(column.chars.size());
+                        } else {
+                            std::memcpy(column.values.data() + row * fields[f].size, object + fields[f].offset,
+                                        fields[f].size);
+                        }
+                    }
+                }
+            }
+
+            // Rows without the component repeat the previous end offset
+            for (auto& part : batch.parts) {
+                for (auto& column : part.columns) {
+                    for (std::size_t row = 1; part.present && row < column.offsets.size(); ++row) {
+                        column.offsets[row] = std::max(column.offsets[row], column.offsets[row - 1]);
+                    }
+                }
+            }
+        }
+    }
+
+    static void start(Part& part, const ColumnarComponent& component, const std::size_t rows) {
+        const auto& fields = component.get_fields();
+        part.present = true;
+        part.valid.assign(Columnar::bitmap_size(rows), 0);
+        part.columns.resize(fields.size());
+        for (std::size_t f = 0; f < fields.size(); ++f) {
+            auto& column = part.columns[f];
+            column.values.assign(rows * fields[f].size, 0);
+            column.chars.clear();
+            if (fields[f].kind == ColumnKind::String) {
+                column.offsets.assign(rows + 1, 0);
+            } else {
+                column.offsets.clear();
+            }
+        }
+    }
+
+    void work() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock lock(mutex_);
+                work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return; // Only stop once everything queued is written
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+                busy_ = true;
+            }
+
+            write(job);
+
+            {
+                std::lock_guard lock(mutex_);
+                spare_.push_back(std::move(job));
+                busy_ = false;
+            }
+            idle_.notify_all();
+        }
+    }
+
+    void write_schema() {
+        std::vector<char> body;
+        SnapshotWriter out(body);
+        const auto& components = schema_.get_components();
+        out.write(static_cast<std::uint32_t>(schema_.get_systems().size()));
+        out.write(static_cast<std::uint32_t>(components.size()));
+        for (const auto& system : schema_.get_systems()) {
+            out.write_string(system.name);
+        }
+        for (const auto& component : components) {
+            out.write_string(component->get_name());
+            out.write(static_cast<std::uint32_t>(component->get_fields().size()));
+            for (const auto& field : component->get_fields()) {
+                out.write_string(field.name);
+                out.write(static_cast<std::uint32_t>(field.kind));
+                out.write(field.size);
+            }
+        }
+
+        Columnar::FileHeader header{};
+        std::memcpy(header.magic, "ECSCOLS", 8);
+        header.version = Columnar::VERSION;
+        put(&header, sizeof(header));
+        begin_message(Columnar::Message::Schema, body.size());
+        put(body.data(), body.size());
+        pad(body.size());
+    }
+
+    void write(Job& job) {
+        const auto& components = schema_.get_components();
+        for (auto& batch : job.batches) {
+            if (batch.ids.empty()) {
+                continue;
+            }
+
+            const auto rows = batch.ids.size();
+            std::size_t body = sizeof(Columnar::BatchHeader) + Columnar::padded(rows * sizeof(EntityID)) +
+                               Columnar::padded(components.size());
+            for (std::size_t c = 0; c < components.size(); ++c) {
+                auto& part = batch.parts[c];
+                if (!part.present) {
+                    continue;
+                }
+
+                const auto& fields = components[c]->get_fields();
+                body += Columnar::padded(part.valid.size());
+                for (std::size_t f = 0; f < fields.size(); ++f) {
+                    if (fields[f].kind == ColumnKind::String) {
+                        encode_strings(first_field_[c] + f, part.columns[f], rows);
+                    }
+                    body += Columnar::padded(part.columns[f].values.size());
+                }
+            }
+
+            begin_message(Columnar::Message::Batch, body);
+            const Columnar::BatchHeader header{job.tick, batch.system, static_cast<std::uint32_t>(components.size()),
+                                               rows};
+            put(&header, sizeof(header));
+            put_padded(batch.ids.data(), rows * sizeof(EntityID));
+
+            std::vector<std::uint8_t> present(components.size());
+            for (std::size_t c = 0; c < components.size(); ++c) {
+                present[c] = batch.parts[c].present ? 1 : 0;
+            }
+            put_padded(present.data(), present.size());
+
+            for (auto& part : batch.parts) {
+                if (!part.present) {
+                    continue;
+                }
+                put_padded(part.valid.data(), part.valid.size());
+                for (const auto& column : part.columns) {
+                    put_padded(column.values.data(), column.values.size());
+                }
+            }
+        }
+    }
+
+    // Replaces a string column's characters with dictionary indices, writing a Dictionary message for new strings
+    void encode_strings(const std::size_t field, Column& column, const std::size_t rows) {
+        auto& dictionary = dictionaries_[field];
+        const auto first = dictionary.size();
+        new_offsets_.assign(1, 0);
+        new_chars_.clear();
+
+        for (std::size_t row = 0; row < rows; ++row) {
+            const auto begin = column.offsets[row];
+            const std::string text(column.chars.data() + begin, column.offsets[row + 1] - begin);
+            const auto [it, inserted] = dictionary.emplace(text, static_cast<std::uint32_t>(dictionary.size()));
+            if (inserted) {
+                new_chars_.insert(new_chars_.end(), text.begin(), text.end());
+                new_offsets_.push_back(static_cast<std::uint32_t>(new_chars_.size()));
+            }
+            std::memcpy(column.values.data() + row * sizeof(std::uint32_t), &it->second, sizeof(std::uint32_t));
+        }
+
+        const auto count = new_offsets_.size() - 1;
+        if (count == 0) {
+            return;
+        }
+
+        const Columnar::DictionaryHeader header{static_cast<std::uint32_t>(field), static_cast<std::uint32_t>(count),
+                                                first, new_chars_.size()};
+        begin_message(Columnar::Message::Dictionary,
+                      sizeof(header) + Columnar::padded(new_offsets_.size() * sizeof(std::uint32_t)) +
+                          Columnar::padded(new_chars_.size()));
+        put(&header, sizeof(header));
+        put_padded(new_offsets_.data(), new_offsets_.size() * sizeof(std::uint32_t));
+        put_padded(new_chars_.data(), new_chars_.size());
+    }
+
+    void begin_message(const Columnar::Message kind, const std::size_t body) {
+        const Columnar::MessageHeader header{kind, 0, Columnar::padded(body)};
+        put(&header, sizeof(header));
+    }
+
+    void put_padded(const void* data, const std::size_t size) {
+        put(data, size);
+        pad(size);
+    }
+
+    void pad(const std::size_t size) {
+        static constexpr char zeros[8] = {};
+        put(zeros, Columnar::padded(size) - size);
+    }
+
+    void put(const void* data, const std::size_t size) {
+        if (size == 0) {
+            return;
+        }
+        const bool written = std::fwrite(data, 1, size, file_) == size;
+        std::lock_guard lock(mutex_);
+        if (!written && last_status_ == SnapshotStatus::Ok) {
+            last_status_ = SnapshotStatus::WriteFailed;
+        }
+        bytes_written_ += written ? size : 0;
+    }
+};
+
+/**
+ * @brief One system's rows at one tick, pointing into the data given to ColumnarReader
+ *
+ * Field indices run over all fields of all components in schema order.
+ */
+struct ColumnarBatch {
+    std::uint64_t tick{0};
+    std::uint32_t system{0};
+    std::uint64_t rows{0};
+    const char* ids{nullptr};
+    std::vector<const std::uint8_t*> valid;
+    std::vector<const char*> values;
+
+    EntityID get_id(const std::uint64_t row) const noexcept {
+        EntityID id;
+        std::memcpy(&id, ids + row * sizeof(EntityID), sizeof(id));
+        return id;
+    }
+
+    bool has(const std::size_t component, const std::uint64_t row) const noexcept {
+        return valid[component] && (valid[component][row / 8] >> (row % 8)) & 1;
+    }
+
+    /**
+     * @brief A field's value at `row`; V must match the field's size
+     */
+    template<typename V>
+    V get(const std::size_t field, const std::uint64_t row) const noexcept {
+        static_assert(std::is_trivially_copyable_v<V>, "V must be trivially copyable");
+        V value{};
+        if (values[field]) {
+            std::memcpy(&value, values[field] + row * sizeof(V), sizeof(V));
+        }
+        return value;
+    }
+};
+
+/**
+ * @brief Reads a file written by ColumnarExporter, batch by batch
+ */
+class ColumnarReader {
+public:
+    struct Field {
+        std::string name;
+        ColumnKind kind;
+        std::uint32_t size;
+        std::size_t component;
+    };
+
+private:
+    const char* data_{nullptr};
+    std::size_t size_{0};
+    std::size_t offset_{0};
+    SnapshotStatus status_{SnapshotStatus::Ok};
+    std::vector<std::string> systems_;
+    std::vector<std::string> components_;
+    std::vector<Field> fields_;
+    std::vector<std::size_t> first_field_;
+    std::vector<std::vector<std::string_view>> dictionaries_;
+
+public:
+    /**
+     * @brief Reads the header and schema; the data must outlive the reader
+     */
+    SnapshotStatus open(const char* data, const std::size_t size) {
+        data_ = data;
+        size_ = size;
+        offset_ = 0;
+        systems_.clear();
+        components_.clear();
+        fields_.clear();
+        first_field_.clear();
+        dictionaries_.clear();
+
+        Columnar::FileHeader header;
+        if (size < sizeof(header)) {
+            return status_ = SnapshotStatus::BadHeader;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "ECSCOLS", 8) != 0) {
+            return status_ = SnapshotStatus::BadHeader;
+        }
+        if (header.version != Columnar::VERSION) {
+            return status_ = SnapshotStatus::VersionMismatch;
+        }
+        offset_ = sizeof(header);
+
+        Columnar::MessageHeader message;
+        const char* body = nullptr;
+        if (!take_message(message, body) || message.kind != Columnar::Message::Schema) {
+            return status_ = SnapshotStatus::Corrupt;
+        }
+
+        SnapshotReader in(body, message.size);
+        std::uint32_t system_count = 0;
+        std::uint32_t component_count = 0;
+        if (!in.read(system_count) || !in.read(component_count) || system_count > message.size ||
+            component_count > message.size) {
+            return status_ = SnapshotStatus::Corrupt;
+        }
+        systems_.resize(system_count);
+        for (auto& name : systems_) {
+            if (!in.read_string(name)) {
+                return status_ = SnapshotStatus::Corrupt;
+            }
+        }
+        components_.resize(component_count);
+        for (std::size_t c = 0; c < component_count; ++c) {
+            std::uint32_t field_count = 0;
+            if (!in.read_string(components_[c]) || !in.read(field_count) || field_count > message.size) {
+                return status_ = SnapshotStatus::Corrupt;
+            }
+            first_field_.push_back(fields_.size());
+            for (std::uint32_t f = 0; f < field_count; ++f) {
+                Field field{{}, ColumnKind::Bool, 0, c};
+                std::uint32_t kind = 0;
+                if (!in.read_string(field.name) || !in.read(kind) || !in.read(field.size) ||
+                    kind < static_cast<std::uint32_t>(ColumnKind::Bool) ||
+                    kind > static_cast<std::uint32_t>(ColumnKind::String) || field.size == 0 || field.size > 8) {
+                    return status_ = SnapshotStatus::Corrupt;
+                }
+                field.kind = static_cast<ColumnKind>(kind);
+                fields_.push_back(std::move(field));
+            }
+        }
+        dictionaries_.resize(fields_.size());
+        return status_ = SnapshotStatus::Ok;
+    }
+
+    /**
+     * @brief Ok after every batch; Corrupt if reading stopped at damaged data
+     */
+    SnapshotStatus get_status() const noexcept { return status_; }
+
+    const std::vector<std::string>& get_systems() const noexcept { return systems_; }
+    const std::vector<std::string>& get_components() const noexcept { return components_; }
+    const std::vector<Field>& get_fields() const noexcept { return fields_; }
+
+    /**
+     * @brief Index of a component's field by name; get_fields().size() if there is none
+     */
+    std::size_t find_field(const std::string_view component, const std::string_view field) const noexcept {
+        for (std::size_t f = 0; f < fields_.size(); ++f) {
+            if (fields_[f].name == field && components_[fields_[f].component] == component) {
+                return f;
+            }
+        }
+        return fields_.size();
+    }
+
+    /**
+     * @brief The text of a string field at `row`
+     */
+    std::string_view get_string(const ColumnarBatch& batch, const std::size_t field, const std::uint64_t row) const {
+        const auto index = batch.get<std::uint32_t>(field, row);
+        const auto& dictionary = dictionaries_[field];
+        return index < dictionary.size() ? dictionary[index] : std::string_view();
+    }
+
+    /**
+     * @brief Moves to the next batch; false at the end of the data or when it is damaged
+     */
+    bool next(ColumnarBatch& batch) {
+        Columnar::MessageHeader message;
+        const char* body = nullptr;
+        while (status_ == SnapshotStatus::Ok && offset_ < size_) {
+            if (!take_message(message, body)) {
+                status_ = SnapshotStatus::Corrupt;
+                return false;
+            }
+            if (message.kind == Columnar::Message::Dictionary) {
+                if (!read_dictionary(body, message.size)) {
+                    status_ = SnapshotStatus::Corrupt;
+                    return false;
+                }
+            } else if (message.kind == Columnar::Message::Batch) {
+                if (!read_batch(body, message.size, batch)) {
+                    status_ = SnapshotStatus::Corrupt;
+                    return false;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    bool take_message(Columnar::MessageHeader& message, const char*& body) noexcept {
+        if (sizeof(message) > size_ - offset_) {
+            return false;
+        }
+        std::memcpy(&message, data_ + offset_, sizeof(message));
+        if (message.size > size_ - offset_ - sizeof(message)) {
+            return false;
+        }
+        body = data_ + offset_ + sizeof(message);
+        offset_ += sizeof(message) + static_cast<std::size_t>(message.size);
+        return true;
+    }
+
+    bool read_dictionary(const char* body, const std::size_t size) {
+        Columnar::DictionaryHeader header;
+        if (size < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, body, sizeof(header));
+        const auto offsets_size = Columnar::padded((static_cast<std::size_t>(header.count) + 1) * sizeof(std::uint32_t));
+        if (header.field >= dictionaries_.size() || fields_[header.field].kind != ColumnKind::String ||
+            header.first != dictionaries_[header.field].size() || header.count > size ||
+            header.chars_size > size || sizeof(header) + offsets_size + header.chars_size > size) {
+            return false;
+        }
+
+        const char* offsets = body + sizeof(header);
+        const char* chars = offsets + offsets_size;
+        std::uint32_t begin = 0;
+        std::memcpy(&begin, offsets, sizeof(begin));
+        for (std::uint32_t i = 0; i < header.count; ++i) {
+            std::uint32_t end = 0;
+            std::memcpy(&end, offsets + (i + 1) * sizeof(end), sizeof(end));
+            if (end < begin || end > header.chars_size) {
+                return false;
+            }
+            dictionaries_[header.field].emplace_back(chars + begin, end - begin);
+            begin = end;
+        }
+        return true;
+    }
+
+    bool read_batch(const char* body, const std::size_t size, ColumnarBatch& batch) const {
+        Columnar::BatchHeader header;
+        if (size < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, body, sizeof(header));
+        if (header.system >= systems_.size() || header.component_count != components_.size() ||
+            header.rows > size) {
+            return false;
+        }
+
+        std::size_t at = sizeof(header);
+        const auto take = [&](const std::size_t bytes) -> const char* {
+            if (bytes > size || Columnar::padded(bytes) > size - at) {
+                return nullptr;
+            }
+            const char* result = body + at;
+            at += Columnar::padded(bytes);
+            return result;
+        };
+
+        const auto rows = static_cast<std::size_t>(header.rows);
+        batch.tick = header.tick;
+        batch.system = header.system;
+        batch.rows = header.rows;
+        batch.ids = take(rows * sizeof(EntityID));
+        const char* present = take(components_.size());
+        if (!batch.ids || (!present && !components_.empty())) {
+            return false;
+        }
+
+        batch.valid.assign(components_.size(), nullptr);
+        batch.values.assign(fields_.size(), nullptr);
+        for (std::size_t c = 0; c < components_.size(); ++c) {
+            if (!present[c]) {
+                continue;
+            }
+            batch.valid[c] = reinterpret_cast<const std::uint8_t*>(take(Columnar::bitmap_size(rows)));
+            if (!batch.valid[c]) {
+                return false;
+            }
+
+            const auto end = c + 1 < first_field_.size() ? first_field_[c + 1] : fields_.size();
+            for (auto f = first_field_[c]; f < end; ++f) {
+                batch.values[f] = take(rows * fields_[f].size);
+                if (!batch.values[f] && rows > 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_COLUMNAR_HPP
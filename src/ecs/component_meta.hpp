@@ -0,0 +1,181 @@
+#ifndef GAME_ECS_COMPONENT_META_HPP
+#define GAME_ECS_COMPONENT_META_HPP
+
+#include "component.hpp"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace game {
+namespace ecs {
+
+template<typename T, typename F>
+struct FieldMeta {
+    std::string_view name;
+    F T::*member;
+};
+
+template<typename T, typename F>
+constexpr FieldMeta<T, F> field(const std::string_view name, F T::*member) noexcept {
+    return {name, member};
+}
+
+/**
+ * @brief Compile-time description of a component, declared once per type
+ *
+ * Specialize it next to the component to give the type a stable name, list
+ * its plain-data fields and, for types that are not trivially copyable only
+ * because of Component's virtual destructor, promise that a bitwise copy is
+ * a valid move:
+ *
+ *     template<>
+ *     struct ComponentMeta<Position> {
+ *         static constexpr std::string_view name = "position";
+ *         static constexpr auto fields = std::make_tuple(field("x", &Position::x), field("y", &Position::y));
+ *         static constexpr bool trivially_relocatable = true;
+ *     };
+ *
+ * A type is trivially relocatable when no member points into the object
+ * itself; std::string and some other library types don't qualify.
+ * Unspecialized components have no name or fields and are relocated with
+ * their move constructor.
+ */
+template<typename T>
+struct ComponentMeta {};
+
+template<typename T>
+concept ReflectedComponent = requires {
+    { ComponentMeta<T>::name } -> std::convertible_to<std::string_view>;
+    ComponentMeta<T>::fields;
+};
+
+/**
+ * @brief Whether storage may move a T with memcpy and skip the destructor of the source
+ */
+template<typename T>
+constexpr bool is_trivially_relocatable_v = [] {
+    if constexpr (requires { ComponentMeta<T>::trivially_relocatable; }) {
+        return std::is_trivially_copyable_v<T> || static_cast<bool>(ComponentMeta<T>::trivially_relocatable);
+    } else {
+        return std::is_trivially_copyable_v<T>;
+    }
+}();
+
+enum class FieldKind : std::uint8_t {
+    Bool,
+    Enum,
+    Float,
+    Signed,
+    Unsigned,
+    Other
+};
+
+template<typename F>
+constexpr FieldKind field_kind_of() noexcept {
+    if constexpr (std::is_same_v<F, bool>) {
+        return FieldKind::Bool;
+    } else if constexpr (std::is_enum_v<F>) {
+        return FieldKind::Enum;
+    } else if constexpr (std::is_floating_point_v<F>) {
+        return FieldKind::Float;
+    } else if constexpr (std::is_integral_v<F>) {
+        return std::is_signed_v<F> ? FieldKind::Signed : FieldKind::Unsigned;
+    } else {
+        return FieldKind::Other;
+    }
+}
+
+struct FieldInfo {
+    std::string_view name;
+    std::size_t offset;
+    std::size_t size;
+    std::size_t alignment;
+    FieldKind kind;
+};
+
+/**
+ * @brief Runtime view of a component's metadata, e.g. for inspectors
+ */
+struct ComponentInfo {
+    std::string_view name;
+    std::size_t size;
+    std::size_t alignment;
+    bool trivially_copyable;
+    bool trivially_relocatable;
+    std::span<const FieldInfo> fields;
+};
+
+/**
+ * @brief Calls `fn(name, member)` for each declared field of T, in declaration order
+ */
+template<ReflectedComponent T, typename Fn>
+constexpr void for_each_field_meta(Fn&& fn) {
+    std::apply([&fn](const auto&... fields) {
+        (fn(fields.name, fields.member), ...);
+    }, ComponentMeta<T>::fields);
+}
+
+/**
+ * @brief Calls `fn(name, value)` for each declared field of `component`, e.g. to draw an inspector row
+ */
+template<typename T, typename Fn>
+    requires ReflectedComponent<std::remove_const_t<T>>
+void for_each_field(T& component, Fn&& fn) {
+    for_each_field_meta<std::remove_const_t<T>>([&component, &fn](const std::string_view name, auto member) {
+        fn(name, component.*member);
+    });
+}
+
+template<typename T>
+constexpr std::size_t field_count_of() noexcept {
+    if constexpr (ReflectedComponent<T>) {
+        return std::tuple_size_v<std::remove_cvref_t<decltype(ComponentMeta<T>::fields)>>;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Metadata of T, built on first use; unreflected components report no name or fields
+ */
+template<typename T>
+const ComponentInfo& get_component_info() {
+    static_assert(std::is_base_of_v<Component, T>, "T must inherit Component");
+
+    static const auto fields = [] {
+        std::array<FieldInfo, field_count_of<T>()> result{};
+        if constexpr (ReflectedComponent<T>) {
+            static_assert(std::is_default_constructible_v<T>, "Reflected components need a default constructor");
+            // Member offsets of a non-standard-layout type are only known for a real object
+            const T sample{};
+            std::size_t index = 0;
+            for_each_field_meta<T>([&](const std::string_view name, auto member) {
+                using F = std::remove_cvref_t<decltype(sample.*member)>;
+                const auto offset = static_cast<std::size_t>(
+                    reinterpret_cast<const char*>(&(sample.*member)) - reinterpret_cast<const char*>(&sample));
+                result[index++] = {name, offset, sizeof(F), alignof(F), field_kind_of<F>()};
+            });
+        }
+        return result;
+    }();
+
+    static const ComponentInfo info = [] {
+        std::string_view name;
+        if constexpr (ReflectedComponent<T>) {
+            name = ComponentMeta<T>::name;
+        }
+        return ComponentInfo{name, sizeof(T), alignof(T), std::is_trivially_copyable_v<T>,
+                             is_trivially_relocatable_v<T>, std::span<const FieldInfo>(fields)};
+    }();
+    return info;
+}
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_COMPONENT_META_HPP
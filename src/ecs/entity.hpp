@@ -30,6 +30,41 @@ using EntityID = std::uint64_t;
  */
 using EntityComponents = std::unordered_map<std::type_index, std::unique_ptr<Component>>;
 
+/**
+ * @brief Receives notifications about entity and component changes
+ *
+ * Every entity created by a system reports structural changes (components
+ * added or removed) and explicit writes made through write_component() or
+ * mark_written() to its observer. Facilities such as sleeping or change
+ * tracking implement this interface and attach themselves to a system.
+ * An observer that clears `wants_writes_` is not told about writes, which
+ * keeps write_component() and mark_written() cheap when nobody listens.
+ */
+class EntityObserver {
+protected:
+    bool wants_writes_{true};
+
+public:
+    virtual ~EntityObserver() = default;
+
+    bool wants_writes() const noexcept { return wants_writes_; }
+
+    virtual void on_entity_added(Entity&) noexcept {
+    }
+
+    virtual void on_entity_removed(Entity&) noexcept {
+    }
+
+    virtual void on_component_added(Entity&, const std::type_index&) noexcept {
+    }
+
+    virtual void on_component_removed(Entity&, const std::type_index&) noexcept {
+    }
+
+    virtual void on_component_written(Entity&, const std::type_index&) noexcept {
+    }
+};
+
 /**
  * @brief Core entity class in the ECS architecture
  * 
@@ -41,11 +76,40 @@ using EntityComponents = std::unordered_map<std::type_index, std::unique_ptr<Com
 class Entity {
     EntityID id_;
     EntityComponents components_;
+    EntityObserver* observer_{nullptr};
 
 public:
     explicit Entity(const EntityID id): id_(id) {}
     EntityID get_id() const noexcept { return id_; }
 
+    EntityObserver* get_observer() const noexcept { return observer_; }
+    void set_observer(EntityObserver* observer) noexcept { observer_ = observer; }
+
+    const EntityComponents& get_components() const noexcept { return components_; }
+
+    /**
+     * @brief Gets a component for modification and reports the write to the observer
+     */
+    template<typename T>
+    [[nodiscard]] T* write_component() {
+        auto* component = get_component<T>();
+        if (component && observer_ && observer_->wants_writes()) {
+            observer_->on_component_written(*this, std::type_index(typeid(T)));
+        }
+        return component;
+    }
+
+    /**
+     * @brief Reports that a component was modified through a previously fetched pointer
+     */
+    template<typename T>
+    void mark_written() {
+        static_assert(std::is_base_of_v<Component, T>, "T must inherit Component");
+        if (observer_ && observer_->wants_writes() && has_component<T>()) {
+            observer_->on_component_written(*this, std::type_index(typeid(T)));
+        }
+    }
+
     template<typename T>
     [[nodiscard]] T* get_component() {
         static_assert(std::is_base_of_v<Component, T>, "T must inherit Component");
@@ -102,6 +166,10 @@ public:
 
         components_.emplace(index, std::move(component));
 
+        if (observer_) {
+            observer_->on_component_added(*this, index);
+        }
+
         return component_ptr;
     }
 
@@ -115,6 +183,10 @@ public:
             return false; // Component doesn't exist
         }
         
+        if (observer_) {
+            observer_->on_component_removed(*this, index);
+        }
+
         // Clear owner pointer before removal
         it->second->owner = nullptr;
         components_.erase(it);
@@ -0,0 +1,287 @@
+#ifndef GAME_ECS_FORK_CHECKPOINT_HPP
+#define GAME_ECS_FORK_CHECKPOINT_HPP
+
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#define GAME_ECS_FORK_CHECKPOINT 1
+#endif
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Timing and copy-on-write cost of one forked checkpoint
+ *
+ * `pause_ms` is how long the simulation was blocked (quiescing the pools
+ * plus fork()). `total_ms` runs from the fork to the moment the child was
+ * reaped, so with poll() it includes the time until the next poll. The fault
+ * counts are minor page faults taken while the child was alive; in the parent
+ * they are mostly pages copied because the simulation wrote to them.
+ */
+struct ForkCheckpointStats {
+    SnapshotStatus status{SnapshotStatus::Ok};
+    double pause_ms{0.0};
+    double total_ms{0.0};
+    long parent_minor_faults{0};
+    long child_minor_faults{0};
+};
+
+/**
+ * @brief Writes full snapshots from a forked child while the parent keeps simulating
+ *
+ * begin() is called between ticks. It quiesces every registered worker,
+ * so no pool thread is running a job and no background writer is writing.
+ * It then forks; the child holds a copy-on-write image of the world as of
+ * that tick boundary. The child encodes the image with the calling thread
+ * only, writes it under a temporary name, renames it to `path` and exits
+ * with the SnapshotStatus as its exit code. The parent resumes the workers
+ * immediately and reaps the child with poll() or wait().
+ *
+ * The child allocates while it encodes, and a thread caught mid-allocation
+ * or holding any other lock at fork time leaves that lock held forever in
+ * the child. So every thread in the process besides the caller must belong
+ * to a registered worker: ThreadPools, including those owned by services
+ * such as PathfindingService, and the DeltaCheckpointer, ChangeLog and
+ * ColumnarExporter writers. begin() counts the process's threads and
+ * refuses to fork while any is unaccounted for. Forking is supported on
+ * Linux and macOS, where threads can be counted; elsewhere begin() always
+ * returns false.
+ */
+class ForkCheckpointer {
+    using Clock = std::chrono::steady_clock;
+
+    World& world_;
+    const SnapshotSchema& schema_;
+    std::string path_;
+
+    struct Worker {
+        const void* owner;
+        std::function<std::unique_lock<std::mutex>()> quiesce;
+        std::function<std::size_t()> thread_count;
+    };
+    std::vector<Worker> workers_;
+    std::size_t unregistered_threads_{0};
+
+    long child_{-1};
+    Clock::time_point started_;
+    long parent_faults_at_start_{0};
+    ForkCheckpointStats stats_;
+    std::size_t checkpoint_count_{0};
+
+public:
+    ForkCheckpointer(World& world, const SnapshotSchema& schema, std::string path)
+        : world_(world)
+        , schema_(schema)
+        , path_(std::move(path)) {}
+
+    ForkCheckpointer(const ForkCheckpointer&) = delete;
+    ForkCheckpointer& operator=(const ForkCheckpointer&) = delete;
+
+    ~ForkCheckpointer() {
+        wait();
+    }
+
+    static constexpr bool is_supported() noexcept {
+#ifdef GAME_ECS_FORK_CHECKPOINT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const std::string& get_path() const noexcept { return path_; }
+    bool is_running() const noexcept { return child_ > 0; }
+    std::size_t get_checkpoint_count() const noexcept { return checkpoint_count_; }
+
+    /**
+     * @brief Stats of the most recently finished checkpoint
+     */
+    const ForkCheckpointStats& get_last_stats() const noexcept { return stats_; }
+
+    /**
+     * @brief Threads found running outside any registered worker when begin() last refused to fork
+     */
+    std::size_t get_unregistered_threads() const noexcept { return unregistered_threads_; }
+
+    /**
+     * @brief Registers an owner of threads that must be parked when the process is forked
+     *
+     * `T` provides quiesce(), returning a lock that keeps its threads parked
+     * while held, and get_thread_count(): ThreadPool, DeltaCheckpointer,
+     * ChangeLog and ColumnarExporter all qualify.
+     */
+    template<typename T>
+    void add_worker(T* owner) {
+        const auto registered = [owner](const Worker& worker) { return worker.owner == owner; };
+        if (!owner || std::any_of(workers_.begin(), workers_.end(), registered)) {
+            return;
+        }
+        workers_.push_back({owner, [owner] { return owner->quiesce(); }, [owner] { return owner->get_thread_count(); }});
+    }
+
+    void add_pool(ThreadPool* pool) {
+        add_worker(pool);
+    }
+
+    /**
+     * @brief Forks a child that writes the world as it is now
+     *
+     * Returns false if a checkpoint is still running, a thread is not
+     * accounted for by a registered worker, or fork() failed.
+     */
+    bool begin() {
+#ifdef GAME_ECS_FORK_CHECKPOINT
+        if (is_running()) {
+            return false;
+        }
+
+        const auto start = Clock::now();
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(workers_.size());
+        std::size_t expected = 1; // The calling thread
+        for (const auto& worker : workers_) {
+            locks.push_back(worker.quiesce());
+            expected += worker.thread_count();
+        }
+
+        const auto running = thread_count();
+        unregistered_threads_ = running > expected ? running - expected : 0;
+        if (running == 0 || unregistered_threads_ > 0) {
+            return false;
+        }
+
+        // Flush buffered output so the child does not write it a second time on exit
+        std::fflush(nullptr);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            _exit(static_cast<int>(write_snapshot()));
+        }
+
+        locks.clear();
+        if (pid < 0) {
+            return false;
+        }
+
+        child_ = pid;
+        started_ = start;
+        parent_faults_at_start_ = minor_faults();
+        stats_ = {};
+        stats_.pause_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Reaps the child if it has finished; returns true once the stats are final
+     */
+    bool poll() {
+        return reap(false);
+    }
+
+    /**
+     * @brief Blocks until the running checkpoint, if any, has finished
+     */
+    bool wait() {
+        return reap(true);
+    }
+
+private:
+    bool reap([[maybe_unused]] const bool block) {
+#ifdef GAME_ECS_FORK_CHECKPOINT
+        if (!is_running()) {
+            return true;
+        }
+
+        int status = 0;
+        rusage usage{};
+        const pid_t pid = wait4(static_cast<pid_t>(child_), &status, block ? 0 : WNOHANG, &usage);
+        if (pid == 0) {
+            return false;
+        }
+
+        child_ = -1;
+        ++checkpoint_count_;
+        stats_.total_ms = std::chrono::duration<double, std::milli>(Clock::now() - started_).count();
+        stats_.parent_minor_faults = minor_faults() - parent_faults_at_start_;
+        stats_.child_minor_faults = usage.ru_minflt;
+        if (pid < 0 || !WIFEXITED(status)) {
+            stats_.status = SnapshotStatus::WriteFailed;
+        } else {
+            stats_.status = static_cast<SnapshotStatus>(WEXITSTATUS(status));
+        }
+#endif
+        return true;
+    }
+
+#ifdef GAME_ECS_FORK_CHECKPOINT
+    // Runs in the child, which has no other threads
+    SnapshotStatus write_snapshot() {
+        std::vector<char> buffer;
+        Snapshot::encode(world_, schema_, buffer);
+
+        const auto temporary = path_ + ".tmp";
+        const auto status = Snapshot::write_file(temporary, buffer.data(), buffer.size());
+        if (status != SnapshotStatus::Ok) {
+            return status;
+        }
+        return std::rename(temporary.c_str(), path_.c_str()) == 0 ? SnapshotStatus::Ok : SnapshotStatus::WriteFailed;
+    }
+
+    // Threads in this process, or 0 if they cannot be counted
+    static std::size_t thread_count() noexcept {
+#ifdef __APPLE__
+        thread_act_array_t threads;
+        mach_msg_type_number_t count = 0;
+        if (task_threads(mach_task_self(), &threads, &count) != KERN_SUCCESS) {
+            return 0;
+        }
+        for (mach_msg_type_number_t i = 0; i < count; ++i) {
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(threads), sizeof(thread_act_t) * count);
+        return count;
+#else
+        std::error_code error;
+        std::size_t count = 0;
+        for (std::filesystem::directory_iterator it("/proc/self/task", error), end; !error && it != end;
+             it.increment(error)) {
+            ++count;
+        }
+        return error ? 0 : count;
+#endif
+    }
+
+    static long minor_faults() noexcept {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_minflt;
+    }
+#endif
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_FORK_CHECKPOINT_HPP
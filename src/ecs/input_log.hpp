@@ -0,0 +1,546 @@
+#ifndef GAME_ECS_INPUT_LOG_HPP
+#define GAME_ECS_INPUT_LOG_HPP
+
+#include "entity.hpp"
+#include "snapshot.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+enum class InputStatus {
+    Ok,
+    End,
+    OpenFailed,
+    BadHeader,
+    VersionMismatch,
+    SchemaMismatch,
+    Corrupt
+};
+
+/**
+ * @brief Binary format shared by InputRecorder and InputReplay
+ *
+ * Layout (native endianness):
+ *
+ *     Header, Full snapshot of the starting world (snapshot_size bytes), records
+ *
+ * Each record is an opcode byte followed by its operands. System and
+ * component indices follow the schema's registration order and are varints,
+ * entity IDs are zigzag varint differences to the previous ID in the log:
+ *
+ *     Tick      float delta                  ends a frame
+ *     TickSame                               Tick with the previous delta
+ *     Spawn     system, id
+ *     Remove    system, id
+ *     Set       system, id, component, record, blob size, blob
+ *     Unset     system, id, component
+ */
+class InputLog {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t DETERMINISTIC = 1;
+
+    enum class Op : std::uint8_t { Tick = 0, TickSame = 1, Spawn = 2, Remove = 3, Set = 4, Unset = 5 };
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t flags;
+        std::uint64_t schema_hash;
+        std::uint64_t random_seed;
+        std::uint64_t snapshot_size;
+    };
+
+    /**
+     * @brief Hash of the schema's system names and component layouts, in registration order
+     */
+    static std::uint64_t schema_hash(const SnapshotSchema& schema) noexcept {
+        std::uint64_t hash = hash_name("input");
+        for (const auto& system : schema.get_systems()) {
+            hash = hash_combine(hash, system.name_hash);
+        }
+        for (const auto& component : schema.get_components()) {
+            hash = hash_combine(hash, component->get_schema_hash());
+        }
+        return hash;
+    }
+
+    static void write_varint(SnapshotWriter& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.write(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.write(static_cast<std::uint8_t>(value));
+    }
+
+    static bool read_varint(SnapshotReader& in, std::uint64_t& value) noexcept {
+        value = 0;
+        for (std::uint32_t shift = 0; shift < 64; shift += 7) {
+            std::uint8_t byte = 0;
+            if (!in.read(byte)) {
+                return false;
+            }
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static std::uint64_t zigzag(const EntityID from, const EntityID to) noexcept {
+        const auto difference = static_cast<std::int64_t>(to - from);
+        return (static_cast<std::uint64_t>(difference) << 1) ^ static_cast<std::uint64_t>(difference >> 63);
+    }
+
+    static EntityID unzigzag(const EntityID from, const std::uint64_t value) noexcept {
+        return from + ((value >> 1) ^ (~(value & 1) + 1));
+    }
+};
+
+/**
+ * @brief Records the inputs applied to a world so InputReplay can repeat the session
+ *
+ * The log starts with a Full snapshot of the world and its deterministic
+ * mode and random seed. Observers on the schema's systems then note every
+ * entity created or removed and every component added, removed or written
+ * between ticks. tick() writes those changes, using the components' values
+ * at that moment, followed by the tick delta, and runs World::tick() with
+ * recording paused so the simulation's own changes are left to the replay
+ * to reproduce. Only components registered in the schema are recorded, and
+ * writes through raw pointers are only seen through write_component() or
+ * mark_written(). A replay matches the session exactly when the world runs
+ * in deterministic mode.
+ */
+class InputRecorder {
+    class Watcher : public EntityObserver {
+        InputRecorder& owner_;
+        std::uint32_t system_;
+
+    public:
+        Watcher(InputRecorder& owner, const std::uint32_t system) noexcept
+            : owner_(owner)
+            , system_(system) {}
+
+        void on_entity_added(Entity& entity) noexcept override {
+            if (auto* pending = owner_.touch(system_, entity.get_id())) {
+                pending->spawned = true;
+            }
+        }
+
+        void on_entity_removed(Entity& entity) noexcept override {
+            if (auto* pending = owner_.touch(system_, entity.get_id()); pending && !pending->spawned) {
+                pending->removed = true;
+            }
+        }
+
+        void on_component_added(Entity& entity, const std::type_index& type) noexcept override {
+            owner_.touch_component(system_, entity.get_id(), type);
+        }
+
+        void on_component_removed(Entity& entity, const std::type_index& type) noexcept override {
+            owner_.touch_component(system_, entity.get_id(), type);
+        }
+
+        void on_component_written(Entity& entity, const std::type_index& type) noexcept override {
+            owner_.touch_component(system_, entity.get_id(), type);
+        }
+    };
+
+    // An entity changed during the current frame; `removed` means it existed when the frame began
+    struct Pending {
+        std::uint32_t system;
+        EntityID id;
+        bool spawned{false};
+        bool removed{false};
+        std::vector<std::uint32_t> components;
+    };
+
+    World& world_;
+    const SnapshotSchema& schema_;
+    std::vector<System*> systems_;
+    std::vector<std::unique_ptr<Watcher>> watchers_;
+    std::unordered_map<std::type_index, std::uint32_t> component_of_;
+
+    std::vector<Pending> pending_;
+    std::vector<std::unordered_map<EntityID, std::uint32_t>> pending_of_;
+    bool recording_{true};
+
+    std::vector<char> log_;
+    EntityID last_id_{0};
+    float last_delta_{0.0f};
+    std::uint64_t frame_count_{0};
+    std::vector<char> record_;
+    std::vector<char> blob_;
+
+public:
+    InputRecorder(World& world, const SnapshotSchema& schema)
+        : world_(world)
+        , schema_(schema) {
+        const auto& components = schema_.get_components();
+        for (std::uint32_t i = 0; i < components.size(); ++i) {
+            component_of_.emplace(components[i]->get_type(), i);
+        }
+
+        std::vector<char> snapshot;
+        Snapshot::encode(world_, schema_, snapshot);
+
+        InputLog::Header header{};
+        std::memcpy(header.magic, "ECSINPT", 8);
+        header.version = InputLog::VERSION;
+        header.flags = world_.is_deterministic() ? InputLog::DETERMINISTIC : 0;
+        header.schema_hash = InputLog::schema_hash(schema_);
+        header.random_seed = world_.get_random_seed();
+        header.snapshot_size = snapshot.size();
+
+        SnapshotWriter out(log_);
+        out.write(header);
+        out.write_bytes(snapshot.data(), snapshot.size());
+
+        const auto& systems = schema_.get_systems();
+        pending_of_.resize(systems.size());
+        for (std::uint32_t s = 0; s < systems.size(); ++s) {
+            systems_.push_back(systems[s].get(world_));
+            watchers_.push_back(std::make_unique<Watcher>(*this, s));
+            if (systems_[s]) {
+                systems_[s]->attach_observer(watchers_[s].get());
+            }
+        }
+    }
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    ~InputRecorder() {
+        for (std::size_t s = 0; s < systems_.size(); ++s) {
+            if (systems_[s]) {
+                systems_[s]->detach_observer(watchers_[s].get());
+            }
+        }
+    }
+
+    /**
+     * @brief Writes the inputs of this frame, then ticks the world with recording paused
+     */
+    void tick(const float delta) {
+        flush();
+
+        SnapshotWriter out(log_);
+        if (frame_count_ > 0 && delta == last_delta_) {
+            out.write(InputLog::Op::TickSame);
+        } else {
+            out.write(InputLog::Op::Tick);
+            out.write(delta);
+        }
+        last_delta_ = delta;
+        ++frame_count_;
+
+        recording_ = false;
+        world_.tick(delta);
+        recording_ = true;
+    }
+
+    std::uint64_t get_frame_count() const noexcept { return frame_count_; }
+
+    /**
+     * @brief The log so far; inputs after the last tick() are not in it yet
+     */
+    const std::vector<char>& get_data() const noexcept { return log_; }
+
+    SnapshotStatus save(const std::string& path) const {
+        return Snapshot::write_file(path, log_.data(), log_.size());
+    }
+
+private:
+    Pending* touch(const std::uint32_t system, const EntityID id) noexcept {
+        if (!recording_) {
+            return nullptr;
+        }
+
+        const auto [it, inserted] = pending_of_[system].emplace(id, static_cast<std::uint32_t>(pending_.size()));
+        if (inserted) {
+            pending_.push_back({system, id, false, false, {}});
+        }
+        return &pending_[it->second];
+    }
+
+    void touch_component(const std::uint32_t system, const EntityID id, const std::type_index& type) noexcept {
+        const auto component = component_of_.find(type);
+        if (component == component_of_.end()) {
+            return;
+        }
+
+        if (auto* pending = touch(system, id)) {
+            auto& components = pending->components;
+            if (std::find(components.begin(), components.end(), component->second) == components.end()) {
+                components.push_back(component->second);
+            }
+        }
+    }
+
+    void flush() {
+        const auto& components = schema_.get_components();
+        for (const auto& pending : pending_) {
+            const auto* entity = systems_[pending.system]->get_entity(pending.id);
+            if (pending.removed) {
+                write_entity_op(InputLog::Op::Remove, pending.system, pending.id);
+            }
+
+            if (!entity) {
+                // Created and destroyed within the frame; still consumes the ID
+                if (pending.spawned && !pending.removed) {
+                    write_entity_op(InputLog::Op::Spawn, pending.system, pending.id);
+                    write_entity_op(InputLog::Op::Remove, pending.system, pending.id);
+                }
+                continue;
+            }
+
+            const auto& owned = entity->get_components();
+            if (pending.spawned || pending.removed) {
+                write_entity_op(InputLog::Op::Spawn, pending.system, pending.id);
+                for (std::uint32_t c = 0; c < components.size(); ++c) {
+                    const auto it = owned.find(components[c]->get_type());
+                    if (it != owned.end()) {
+                        write_set(pending.system, pending.id, c, *it->second);
+                    }
+                }
+                continue;
+            }
+
+            for (const auto c : pending.components) {
+                const auto it = owned.find(components[c]->get_type());
+                if (it != owned.end()) {
+                    write_set(pending.system, pending.id, c, *it->second);
+                } else {
+                    write_entity_op(InputLog::Op::Unset, pending.system, pending.id);
+                    SnapshotWriter out(log_);
+                    InputLog::write_varint(out, c);
+                }
+            }
+        }
+
+        pending_.clear();
+        for (auto& pending_of : pending_of_) {
+            pending_of.clear();
+        }
+    }
+
+    void write_entity_op(const InputLog::Op op, const std::uint32_t system, const EntityID id) {
+        SnapshotWriter out(log_);
+        out.write(op);
+        InputLog::write_varint(out, system);
+        InputLog::write_varint(out, InputLog::zigzag(last_id_, id));
+        last_id_ = id;
+    }
+
+    void write_set(const std::uint32_t system, const EntityID id, const std::uint32_t c, const Component& value) {
+        const auto& component = *schema_.get_components()[c];
+        record_.assign(component.get_record_size(), 0);
+        blob_.clear();
+        SnapshotWriter blob(blob_);
+        component.save(value, record_.data(), blob);
+
+        write_entity_op(InputLog::Op::Set, system, id);
+        SnapshotWriter out(log_);
+        InputLog::write_varint(out, c);
+        out.write_bytes(record_.data(), record_.size());
+        InputLog::write_varint(out, blob_.size());
+        out.write_bytes(blob_.data(), blob_.size());
+    }
+};
+
+/**
+ * @brief Replays a log written by InputRecorder into a world as fast as it can run
+ *
+ * open() restores the starting snapshot, deterministic mode and random seed,
+ * so the world must already have the schema's systems; initialize it before
+ * open() if its systems need that. Each step() applies one frame of inputs
+ * and ticks the world. Timing step() calls reproduces a recorded session's
+ * frame spikes offline, and run() makes a whole session a benchmark. The
+ * log must stay alive while replaying unless it was opened from a file.
+ */
+class InputReplay {
+    World& world_;
+    const SnapshotSchema& schema_;
+    std::unique_ptr<MappedFile> file_;
+    SnapshotReader reader_{nullptr, 0};
+    std::size_t size_{0};
+    EntityID last_id_{0};
+    float last_delta_{0.0f};
+    std::uint64_t frame_{0};
+    std::vector<char> record_;
+    std::vector<char> blob_;
+
+public:
+    InputReplay(World& world, const SnapshotSchema& schema) noexcept
+        : world_(world)
+        , schema_(schema) {}
+
+    InputStatus open(const char* data, const std::size_t size) {
+        InputLog::Header header;
+        if (size < sizeof(header)) {
+            return InputStatus::BadHeader;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "ECSINPT", 8) != 0) {
+            return InputStatus::BadHeader;
+        }
+        if (header.version != InputLog::VERSION) {
+            return InputStatus::VersionMismatch;
+        }
+        if (header.schema_hash != InputLog::schema_hash(schema_)) {
+            return InputStatus::SchemaMismatch;
+        }
+        if (header.snapshot_size > size - sizeof(header)) {
+            return InputStatus::Corrupt;
+        }
+
+        const char* snapshot = data + sizeof(header);
+        const auto snapshot_size = static_cast<std::size_t>(header.snapshot_size);
+        if (Snapshot::decode(world_, schema_, snapshot, snapshot_size) != SnapshotStatus::Ok) {
+            return InputStatus::Corrupt;
+        }
+        world_.set_deterministic((header.flags & InputLog::DETERMINISTIC) != 0);
+        world_.set_random_seed(header.random_seed);
+
+        size_ = size - sizeof(header) - snapshot_size;
+        reader_ = SnapshotReader(snapshot + snapshot_size, size_);
+        last_id_ = 0;
+        last_delta_ = 0.0f;
+        frame_ = 0;
+        return InputStatus::Ok;
+    }
+
+    /**
+     * @brief Maps the file into memory and opens it; the mapping lives as long as the replay
+     */
+    InputStatus open_file(const std::string& path) {
+        file_ = std::make_unique<MappedFile>(path);
+        if (!file_->data()) {
+            file_.reset();
+            return InputStatus::OpenFailed;
+        }
+        return open(file_->data(), file_->size());
+    }
+
+    /**
+     * @brief Frames replayed since open()
+     */
+    std::uint64_t get_frame() const noexcept { return frame_; }
+
+    /**
+     * @brief Applies the next frame's inputs and ticks the world; End once the log is exhausted
+     *
+     * Inputs recorded after the session's last tick are applied before End
+     * is returned.
+     */
+    InputStatus step() {
+        const auto& systems = schema_.get_systems();
+        const auto& components = schema_.get_components();
+
+        InputLog::Op op;
+        while (reader_.read(op)) {
+            if (op == InputLog::Op::Tick || op == InputLog::Op::TickSame) {
+                if (op == InputLog::Op::Tick && !reader_.read(last_delta_)) {
+                    return InputStatus::Corrupt;
+                }
+                world_.tick(last_delta_);
+                ++frame_;
+                return InputStatus::Ok;
+            }
+
+            std::uint64_t system_index = 0;
+            std::uint64_t id_delta = 0;
+            if (op > InputLog::Op::Unset || !InputLog::read_varint(reader_, system_index) ||
+                !InputLog::read_varint(reader_, id_delta) || system_index >= systems.size()) {
+                return InputStatus::Corrupt;
+            }
+            auto* system = systems[system_index].get(world_);
+            const auto id = InputLog::unzigzag(last_id_, id_delta);
+            last_id_ = id;
+            if (!system) {
+                return InputStatus::Corrupt;
+            }
+
+            if (op == InputLog::Op::Spawn) {
+                if (!system->add_entity(id)) {
+                    return InputStatus::Corrupt;
+                }
+                continue;
+            }
+            if (op == InputLog::Op::Remove) {
+                system->remove_entity(id);
+                continue;
+            }
+
+            std::uint64_t c = 0;
+            auto* entity = system->get_entity(id);
+            if (!InputLog::read_varint(reader_, c) || c >= components.size() || !entity) {
+                return InputStatus::Corrupt;
+            }
+            const auto& component = *components[c];
+            if (op == InputLog::Op::Unset) {
+                component.remove(*entity);
+                continue;
+            }
+
+            std::uint64_t blob_size = 0;
+            record_.resize(component.get_record_size());
+            if (!reader_.read_bytes(record_.data(), record_.size()) || !InputLog::read_varint(reader_, blob_size) ||
+                blob_size > size_ - reader_.get_offset()) {
+                return InputStatus::Corrupt;
+            }
+            blob_.resize(static_cast<std::size_t>(blob_size));
+            if (!blob_.empty() && !reader_.read_bytes(blob_.data(), blob_.size())) {
+                return InputStatus::Corrupt;
+            }
+
+            SnapshotReader blob(blob_.data(), blob_.size());
+            const auto& owned = entity->get_components();
+            const auto it = owned.find(component.get_type());
+            if (it == owned.end()) {
+                if (!component.load(*entity, record_.data(), blob)) {
+                    return InputStatus::Corrupt;
+                }
+            } else {
+                if (!component.assign(*it->second, record_.data(), blob)) {
+                    return InputStatus::Corrupt;
+                }
+                if (auto* observer = entity->get_observer()) {
+                    observer->on_component_written(*entity, component.get_type());
+                }
+            }
+        }
+        return InputStatus::End;
+    }
+
+    /**
+     * @brief Replays up to `frames` frames; End if the log ran out first
+     */
+    InputStatus run(const std::uint64_t frames = std::numeric_limits<std::uint64_t>::max()) {
+        for (std::uint64_t i = 0; i < frames; ++i) {
+            const auto status = step();
+            if (status != InputStatus::Ok) {
+                return status;
+            }
+        }
+        return InputStatus::Ok;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_INPUT_LOG_HPP
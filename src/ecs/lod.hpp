@@ -0,0 +1,226 @@
+#ifndef GAME_ECS_LOD_HPP
+#define GAME_ECS_LOD_HPP
+
+#include "entity.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief One simulation level of detail
+ *
+ * Entities closer than `max_distance` to the nearest point of interest
+ * (and not within a closer level) are updated every `interval_ticks` ticks.
+ */
+struct LodLevel {
+    float max_distance;
+    std::uint32_t interval_ticks;
+};
+
+/**
+ * @brief Buckets entities by distance so far-away ones update less often
+ *
+ * Each level keeps its entities in `interval_ticks` dense lists and one list
+ * per level is due each tick, so the cost of a level is spread evenly over
+ * its interval instead of spiking. Every entity remembers the simulation time
+ * of its last update, which lets for_each_due() hand it the exact delta it
+ * has missed, even if it changed levels in between.
+ *
+ * Distances are passed in squared so callers never need a sqrt. The last
+ * level catches every entity beyond the configured distances.
+ */
+class LodBuckets {
+    struct Bucket {
+        LodLevel level;
+        float max_distance_sq;
+        std::vector<std::vector<EntityID>> phases;
+        std::uint32_t next_phase{0};
+    };
+
+    struct Slot {
+        std::uint32_t bucket;
+        std::uint32_t phase;
+        std::uint32_t index;
+        double last_update;
+    };
+
+    std::vector<Bucket> buckets_;
+    std::unordered_map<EntityID, Slot> slots_;
+    std::uint64_t tick_{0};
+    double clock_{0.0};
+
+public:
+    LodBuckets() : LodBuckets({{std::numeric_limits<float>::max(), 1}}) {}
+
+    explicit LodBuckets(std::vector<LodLevel> levels) {
+        set_levels(std::move(levels));
+    }
+
+    void set_levels(std::vector<LodLevel> levels) {
+        std::sort(levels.begin(), levels.end(), [](const LodLevel& a, const LodLevel& b) {
+            return a.max_distance < b.max_distance;
+        });
+        if (levels.empty()) {
+            levels.push_back({std::numeric_limits<float>::max(), 1});
+        }
+
+        std::vector<std::pair<EntityID, double>> existing;
+        existing.reserve(slots_.size());
+        for (const auto& [id, slot] : slots_) {
+            existing.emplace_back(id, slot.last_update);
+        }
+        slots_.clear();
+
+        buckets_.clear();
+        for (const auto& level : levels) {
+            Bucket bucket;
+            bucket.level = level;
+            bucket.level.interval_ticks = std::max<std::uint32_t>(level.interval_ticks, 1);
+            bucket.max_distance_sq = level.max_distance * level.max_distance;
+            bucket.phases.resize(bucket.level.interval_ticks);
+            buckets_.push_back(std::move(bucket));
+        }
+        buckets_.back().max_distance_sq = std::numeric_limits<float>::infinity();
+
+        // Re-home existing entities at full detail; they get reclassified on their next update
+        for (const auto& [id, last_update] : existing) {
+            assign(id, 0.0f);
+            slots_.find(id)->second.last_update = last_update;
+        }
+    }
+
+    std::size_t get_level_count() const noexcept { return buckets_.size(); }
+    const LodLevel& get_level(const std::uint32_t level) const noexcept { return buckets_[level].level; }
+    std::size_t size() const noexcept { return slots_.size(); }
+    double get_clock() const noexcept { return clock_; }
+
+    std::uint32_t classify(const float distance_sq) const noexcept {
+        for (std::uint32_t i = 0; i < buckets_.size(); ++i) {
+            if (distance_sq < buckets_[i].max_distance_sq) {
+                return i;
+            }
+        }
+        return static_cast<std::uint32_t>(buckets_.size() - 1);
+    }
+
+    bool contains(const EntityID id) const noexcept {
+        return slots_.find(id) != slots_.end();
+    }
+
+    /**
+     * @brief Returns the level an entity is currently in, or -1 if it isn't tracked
+     */
+    int get_level_of(const EntityID id) const noexcept {
+        const auto it = slots_.find(id);
+        if (it == slots_.end()) {
+            return -1;
+        }
+        return static_cast<int>(it->second.bucket);
+    }
+
+    std::size_t get_level_size(const std::uint32_t level) const noexcept {
+        std::size_t count = 0;
+        for (const auto& phase : buckets_[level].phases) {
+            count += phase.size();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Inserts an entity or moves it to the level matching `distance_sq`
+     *
+     * Must not be called from inside for_each_due(); collect the IDs and
+     * reassign them once iteration has finished.
+     */
+    void assign(const EntityID id, const float distance_sq) {
+        const auto level = classify(distance_sq);
+
+        double last_update = clock_;
+        const auto it = slots_.find(id);
+        if (it != slots_.end()) {
+            if (it->second.bucket == level) {
+                return;
+            }
+            last_update = it->second.last_update;
+            unlink(it->second);
+        }
+
+        auto& bucket = buckets_[level];
+        const auto phase = bucket.next_phase;
+        bucket.next_phase = (bucket.next_phase + 1) % bucket.level.interval_ticks;
+
+        auto& list = bucket.phases[phase];
+        slots_[id] = Slot{level, phase, static_cast<std::uint32_t>(list.size()), last_update};
+        list.push_back(id);
+    }
+
+    bool remove(const EntityID id) {
+        const auto it = slots_.find(id);
+        if (it == slots_.end()) {
+            return false;
+        }
+
+        unlink(it->second);
+        slots_.erase(it);
+        return true;
+    }
+
+    void clear() noexcept {
+        for (auto& bucket : buckets_) {
+            for (auto& phase : bucket.phases) {
+                phase.clear();
+            }
+        }
+        slots_.clear();
+    }
+
+    /**
+     * @brief Advances the LOD clock by one tick of length `delta`
+     */
+    void advance(const float delta) noexcept {
+        ++tick_;
+        clock_ += delta;
+    }
+
+    /**
+     * @brief Visits every entity whose level is due this tick
+     *
+     * `fn(id, elapsed)` receives the simulation time since that entity was
+     * last visited.
+     */
+    template<typename Fn>
+    void for_each_due(Fn&& fn) {
+        for (auto& bucket : buckets_) {
+            const auto phase = static_cast<std::size_t>(tick_ % bucket.level.interval_ticks);
+            for (const auto id : bucket.phases[phase]) {
+                auto& slot = slots_.find(id)->second;
+                const auto elapsed = static_cast<float>(clock_ - slot.last_update);
+                slot.last_update = clock_;
+                fn(id, elapsed);
+            }
+        }
+    }
+
+private:
+    void unlink(const Slot& slot) {
+        auto& list = buckets_[slot.bucket].phases[slot.phase];
+        const auto moved = list.back();
+        list[slot.index] = moved;
+        list.pop_back();
+
+        if (slot.index < list.size()) {
+            slots_.find(moved)->second.index = slot.index;
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_LOD_HPP
@@ -0,0 +1,94 @@
+#ifndef GAME_ECS_LOOPBACK_HPP
+#define GAME_ECS_LOOPBACK_HPP
+
+#include "random.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Statistics of a LoopbackChannel since it was created
+ */
+struct LoopbackStats {
+    std::uint64_t sent{0};
+    std::uint64_t dropped{0};
+    std::uint64_t delivered{0};
+    std::uint64_t bytes_sent{0};
+};
+
+/**
+ * @brief In-memory one-way packet channel with simulated loss and latency
+ *
+ * Packets sent during a step become receivable `latency` calls to advance()
+ * later, in the order they were sent. Each packet is dropped with
+ * probability `loss`, decided by a RandomStream so a given seed always
+ * loses the same packets. Use one channel per direction.
+ */
+class LoopbackChannel {
+    struct Packet {
+        std::uint64_t deliver_at;
+        std::vector<char> data;
+    };
+
+    float loss_;
+    std::uint32_t latency_;
+    RandomStream random_;
+    std::uint64_t now_{0};
+    std::deque<Packet> in_flight_;
+    LoopbackStats stats_;
+
+public:
+    explicit LoopbackChannel(const float loss = 0.0f, const std::uint32_t latency = 0, const std::uint64_t seed = 1) noexcept
+        : loss_(loss)
+        , latency_(latency)
+        , random_(seed, 0, 0) {}
+
+    const LoopbackStats& get_stats() const noexcept { return stats_; }
+    std::size_t get_in_flight() const noexcept { return in_flight_.size(); }
+
+    void set_loss(const float loss) noexcept { loss_ = loss; }
+    void set_latency(const std::uint32_t latency) noexcept { latency_ = latency; }
+
+    void send(const char* data, const std::size_t size) {
+        ++stats_.sent;
+        stats_.bytes_sent += size;
+        if (random_.next_float() < loss_) {
+            ++stats_.dropped;
+            return;
+        }
+        in_flight_.push_back({now_ + latency_, std::vector<char>(data, data + size)});
+    }
+
+    void send(const std::vector<char>& data) {
+        send(data.data(), data.size());
+    }
+
+    /**
+     * @brief Moves to the next step; packets due by then become receivable
+     */
+    void advance() noexcept {
+        ++now_;
+    }
+
+    /**
+     * @brief Pops the next due packet into `out`; false if none is due
+     */
+    bool receive(std::vector<char>& out) {
+        if (in_flight_.empty() || in_flight_.front().deliver_at > now_) {
+            return false;
+        }
+        out.swap(in_flight_.front().data);
+        in_flight_.pop_front();
+        ++stats_.delivered;
+        return true;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_LOOPBACK_HPP
@@ -0,0 +1,68 @@
+#ifndef GAME_ECS_RANDOM_HPP
+#define GAME_ECS_RANDOM_HPP
+
+#include <cstdint>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Counter-based random numbers for deterministic simulation
+ *
+ * A stream is keyed by a seed, a world tick, an entity ID and a salt. Each
+ * draw hashes that key together with a running counter (SplitMix64), so no
+ * generator state lives between ticks. Peers running the same ticks draw the
+ * same numbers no matter in which order entities are visited, and rolling a
+ * world back needs no RNG state. Floats are built from integer bits only, so
+ * draws are identical on every platform.
+ */
+class RandomStream {
+    std::uint64_t key_;
+    std::uint64_t counter_{0};
+
+public:
+    constexpr RandomStream(const std::uint64_t seed, const std::uint64_t tick, const std::uint64_t id,
+                           const std::uint64_t salt = 0) noexcept
+        : key_(mix(seed + mix(tick + mix(id + mix(salt))))) {}
+
+    static constexpr std::uint64_t mix(std::uint64_t value) noexcept {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    constexpr std::uint64_t next_u64() noexcept {
+        return mix(key_ + ++counter_ * 0xD1B54A32D192ED03ull);
+    }
+
+    constexpr std::uint32_t next_u32() noexcept {
+        return static_cast<std::uint32_t>(next_u64() >> 32);
+    }
+
+    /**
+     * @brief Uniform float in [0, 1)
+     */
+    constexpr float next_float() noexcept {
+        return static_cast<float>(next_u64() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    /**
+     * @brief Uniform float in [min, max)
+     */
+    constexpr float range(const float min, const float max) noexcept {
+        return min + (max - min) * next_float();
+    }
+
+    /**
+     * @brief Integer in [0, bound); 0 if bound is 0
+     */
+    constexpr std::uint32_t below(const std::uint32_t bound) noexcept {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(next_u32()) * bound) >> 32);
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_RANDOM_HPP
@@ -0,0 +1,527 @@
+#ifndef GAME_ECS_REGISTRY_HPP
+#define GAME_ECS_REGISTRY_HPP
+
+#include "component.hpp"
+#include "component_meta.hpp"
+#include "entity.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Contiguous storage for one component type of an archetype table
+ *
+ * Like a vector, but rows leave by swapping in the last row, and a row can
+ * be relocated into another column. For trivially relocatable components
+ * (see ComponentMeta) relocation and growth are plain memcpy: no move
+ * constructor runs and the moved-from object is not destroyed.
+ */
+template<typename T>
+class ComponentColumn {
+    static constexpr bool RELOCATABLE = is_trivially_relocatable_v<T>;
+
+    T* data_{nullptr};
+    std::size_t size_{0};
+    std::size_t capacity_{0};
+
+public:
+    ComponentColumn() = default;
+    ComponentColumn(const ComponentColumn&) = delete;
+    ComponentColumn& operator=(const ComponentColumn&) = delete;
+
+    ComponentColumn(ComponentColumn&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0)) {}
+
+    ComponentColumn& operator=(ComponentColumn&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+        }
+        return *this;
+    }
+
+    ~ComponentColumn() {
+        release();
+    }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    T& operator[](const std::size_t row) noexcept { return data_[row]; }
+    const T& operator[](const std::size_t row) const noexcept { return data_[row]; }
+
+    T& back() noexcept { return data_[size_ - 1]; }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        reserve_one();
+        auto* slot = ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    /**
+     * @brief Moves `source[row]` onto the end of this column and fills its slot with source's last row
+     */
+    void relocate_from(ComponentColumn& source, const std::size_t row) {
+        reserve_one();
+        const auto last = source.size_ - 1;
+        if constexpr (RELOCATABLE) {
+            std::memcpy(static_cast<void*>(data_ + size_), static_cast<const void*>(source.data_ + row), sizeof(T));
+            if (row != last) {
+                std::memcpy(static_cast<void*>(source.data_ + row), static_cast<const void*>(source.data_ + last),
+                            sizeof(T));
+            }
+        } else {
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(source.data_[row]));
+            if (row != last) {
+                source.data_[row] = std::move(source.data_[last]);
+            }
+            source.data_[last].~T();
+        }
+        ++size_;
+        --source.size_;
+    }
+
+    /**
+     * @brief Destroys `row` and fills its slot with the last row
+     */
+    void erase_swap(const std::size_t row) noexcept {
+        const auto last = size_ - 1;
+        data_[row].~T();
+        if (row != last) {
+            relocate(data_ + last, data_ + row);
+        }
+        --size_;
+    }
+
+private:
+    // Move-constructs `to` from `from` and ends the lifetime of `from`
+    static void relocate(T* from, T* to) noexcept {
+        if constexpr (RELOCATABLE) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), sizeof(T));
+        } else {
+            ::new (static_cast<void*>(to)) T(std::move(*from));
+            from->~T();
+        }
+    }
+
+    void reserve_one() {
+        if (size_ < capacity_) {
+            return;
+        }
+
+        const auto capacity = capacity_ == 0 ? 16 : capacity_ * 2;
+        auto* data = std::allocator<T>().allocate(capacity);
+        if constexpr (RELOCATABLE) {
+            if (size_ > 0) {
+                std::memcpy(static_cast<void*>(data), static_cast<const void*>(data_), size_ * sizeof(T));
+            }
+        } else {
+            for (std::size_t i = 0; i < size_; ++i) {
+                relocate(data_ + i, data + i);
+            }
+        }
+        if (data_) {
+            std::allocator<T>().deallocate(data_, capacity_);
+        }
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    void release() noexcept {
+        for (std::size_t i = 0; i < size_; ++i) {
+            data_[i].~T();
+        }
+        if (data_) {
+            std::allocator<T>().deallocate(data_, capacity_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+};
+
+/**
+ * @brief Entity storage for a component list fixed at compile time
+ *
+ * Registry<Position, Velocity, Health> gives each listed component a
+ * constexpr ID (its position in the list) and each set of components a
+ * constexpr mask. Entities with the same set of components share an
+ * archetype table holding one typed column per component, so there is no
+ * type erasure and no per-component allocation: view<Position, Velocity>()
+ * visits the matching tables and indexes their columns directly. Adding or
+ * removing a component moves the entity's row to the table of its new
+ * archetype, with memcpy for trivially relocatable components; create()
+ * with components places a new entity straight into its final table.
+ *
+ * Entity IDs start at 1 and are not reused. Components keep a null owner,
+ * as they don't belong to an Entity. Entity and System remain the storage
+ * for components registered at runtime, e.g. by mods.
+ */
+template<typename... Components>
+class Registry {
+    static_assert(sizeof...(Components) > 0, "Registry needs at least one component");
+    static_assert(sizeof...(Components) <= 64, "Registry masks hold at most 64 components");
+    static_assert((std::is_base_of_v<Component, Components> && ...), "Components must inherit Component");
+
+    template<typename T>
+    static constexpr std::size_t count_of = (static_cast<std::size_t>(std::is_same_v<T, Components>) + ...);
+
+    static_assert(((count_of<Components> == 1) && ...), "Each component type may only appear once");
+
+public:
+    using Mask = std::uint64_t;
+
+    static constexpr std::size_t component_count = sizeof...(Components);
+
+    template<typename T>
+    static constexpr bool has_type = count_of<T> == 1;
+
+    template<typename T>
+    static constexpr std::size_t component_id = [] {
+        static_assert(has_type<T>, "T is not one of this registry's components");
+        constexpr bool matches[] = {std::is_same_v<T, Components>...};
+        std::size_t index = 0;
+        while (!matches[index]) {
+            ++index;
+        }
+        return index;
+    }();
+
+    template<typename... Ts>
+    static constexpr Mask mask_of = (Mask{0} | ... | (Mask{1} << component_id<Ts>));
+
+    /**
+     * @brief Entities with exactly one set of components, one column per component
+     *
+     * Columns of components outside the archetype stay empty.
+     */
+    struct Table {
+        Mask mask;
+        std::vector<EntityID> ids;
+        std::tuple<ComponentColumn<Components>...> columns;
+        // Tables reached by adding or removing each component, looked up on first use
+        std::array<std::uint32_t, sizeof...(Components)> add_edges;
+        std::array<std::uint32_t, sizeof...(Components)> remove_edges;
+
+        std::size_t size() const noexcept { return ids.size(); }
+
+        template<typename T>
+        ComponentColumn<T>& column() noexcept { return std::get<component_id<T>>(columns); }
+
+        template<typename T>
+        const ComponentColumn<T>& column() const noexcept { return std::get<component_id<T>>(columns); }
+
+        /**
+         * @brief Start of every column, empty ones included, for indexing by row
+         */
+        std::tuple<Components*...> get_columns() noexcept {
+            return std::apply([](auto&... column) { return std::make_tuple(column.data()...); }, columns);
+        }
+    };
+
+private:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Location {
+        std::uint32_t table{NONE};
+        std::uint32_t row{0};
+    };
+
+    struct Query {
+        std::vector<std::uint32_t> tables;
+        std::size_t seen{0};
+    };
+
+    std::vector<Table> tables_;
+    std::unordered_map<Mask, std::uint32_t> table_of_;
+    std::unordered_map<Mask, Query> queries_;
+    std::vector<Location> locations_{1};
+    std::size_t alive_count_{0};
+
+public:
+    /**
+     * @brief Tables and entities matching all of `Ts`; valid until the registry gains a table
+     */
+    template<typename... Ts>
+    class View {
+        Registry& registry_;
+        const std::vector<std::uint32_t>& tables_;
+
+    public:
+        View(Registry& registry, const std::vector<std::uint32_t>& tables) noexcept
+            : registry_(registry)
+            , tables_(tables) {}
+
+        /**
+         * @brief Calls `fn(EntityID, Ts&...)` for each matching entity; `fn` must not add or remove components
+         */
+        template<typename Fn>
+        void for_each(Fn&& fn) {
+            for (const auto index : tables_) {
+                auto& table = registry_.tables_[index];
+                const auto* ids = table.ids.data();
+                const auto count = table.size();
+                const auto columns = std::make_tuple(table.template column<Ts>().data()...);
+                for (std::size_t row = 0; row < count; ++row) {
+                    fn(ids[row], std::get<Ts*>(columns)[row]...);
+                }
+            }
+        }
+
+        /**
+         * @brief Calls `fn(std::size_t count, const EntityID* ids, Ts*... columns)` once per matching table
+         */
+        template<typename Fn>
+        void for_each_table(Fn&& fn) {
+            for (const auto index : tables_) {
+                auto& table = registry_.tables_[index];
+                if (table.size() > 0) {
+                    fn(table.size(), table.ids.data(), table.template column<Ts>().data()...);
+                }
+            }
+        }
+
+        std::size_t size() const noexcept {
+            std::size_t count = 0;
+            for (const auto index : tables_) {
+                count += registry_.tables_[index].size();
+            }
+            return count;
+        }
+    };
+
+    Registry() = default;
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    /**
+     * @brief Creates an entity with the given components, in the table of their archetype
+     */
+    template<typename... Ts>
+    EntityID create(Ts&&... components) {
+        static_assert(((count_of<std::decay_t<Ts>> == 1) && ...), "Every component must be in the registry");
+        constexpr auto mask = mask_of<std::decay_t<Ts>...>;
+        static_assert(std::popcount(mask) == sizeof...(Ts), "Each component may only be passed once");
+
+        const auto id = static_cast<EntityID>(locations_.size());
+        const auto table_index = get_table(mask);
+        auto& table = tables_[table_index];
+        locations_.push_back({table_index, static_cast<std::uint32_t>(table.size())});
+        table.ids.push_back(id);
+        (table.template column<std::decay_t<Ts>>().push_back(std::forward<Ts>(components)), ...);
+        ++alive_count_;
+        return id;
+    }
+
+    bool destroy(const EntityID id) noexcept {
+        if (!is_alive(id)) {
+            return false;
+        }
+
+        auto& location = locations_[id];
+        erase_row(location.table, location.row);
+        location.table = NONE;
+        --alive_count_;
+        return true;
+    }
+
+    bool is_alive(const EntityID id) const noexcept {
+        return id < locations_.size() && locations_[id].table != NONE;
+    }
+
+    std::size_t get_entity_count() const noexcept { return alive_count_; }
+
+    /**
+     * @brief Component mask of a live entity; 0 for a dead one
+     */
+    Mask get_mask(const EntityID id) const noexcept {
+        return is_alive(id) ? tables_[locations_[id].table].mask : 0;
+    }
+
+    template<typename T>
+    bool has_component(const EntityID id) const noexcept {
+        return (get_mask(id) & mask_of<T>) != 0;
+    }
+
+    template<typename T>
+    [[nodiscard]] T* get_component(const EntityID id) noexcept {
+        if (!has_component<T>(id)) {
+            return nullptr;
+        }
+        const auto& location = locations_[id];
+        return &tables_[location.table].template column<T>()[location.row];
+    }
+
+    template<typename T>
+    [[nodiscard]] const T* get_component(const EntityID id) const noexcept {
+        if (!has_component<T>(id)) {
+            return nullptr;
+        }
+        const auto& location = locations_[id];
+        return &tables_[location.table].template column<T>()[location.row];
+    }
+
+    /**
+     * @brief Moves the entity to the archetype with `T` added; nullptr if dead or `T` is already there
+     */
+    template<typename T, typename... Args>
+    [[nodiscard]] T* add_component(const EntityID id, Args&&... args) {
+        if (!is_alive(id) || has_component<T>(id)) {
+            return nullptr;
+        }
+
+        auto& target = tables_[move_row(id, neighbour<true>(locations_[id].table, component_id<T>))];
+        auto& column = target.template column<T>();
+        column.emplace_back(std::forward<Args>(args)...);
+        return &column.back();
+    }
+
+    template<typename T>
+    bool remove_component(const EntityID id) {
+        if (!has_component<T>(id)) {
+            return false;
+        }
+
+        move_row(id, neighbour<false>(locations_[id].table, component_id<T>));
+        return true;
+    }
+
+    template<typename... Ts>
+    [[nodiscard]] View<Ts...> view() {
+        static_assert(sizeof...(Ts) > 0, "A view needs at least one component");
+        return View<Ts...>(*this, match(mask_of<Ts...>));
+    }
+
+    /**
+     * @brief Calls `fn(EntityID, Ts&...)` for every entity that has all of `Ts`
+     */
+    template<typename... Ts, typename Fn>
+    void for_each(Fn&& fn) {
+        view<Ts...>().for_each(std::forward<Fn>(fn));
+    }
+
+    /**
+     * @brief Tables by index; components may be written in place, but rows must not be added or removed
+     */
+    std::vector<Table>& get_tables() noexcept { return tables_; }
+    const std::vector<Table>& get_tables() const noexcept { return tables_; }
+
+private:
+    std::uint32_t get_table(const Mask mask) {
+        const auto it = table_of_.find(mask);
+        if (it != table_of_.end()) {
+            return it->second;
+        }
+
+        const auto index = static_cast<std::uint32_t>(tables_.size());
+        tables_.push_back(Table{mask, {}, {}, {}, {}});
+        tables_.back().add_edges.fill(NONE);
+        tables_.back().remove_edges.fill(NONE);
+        table_of_.emplace(mask, index);
+        return index;
+    }
+
+    // Tables are never removed, so a query only needs to look at the ones added since it last ran
+    const std::vector<std::uint32_t>& match(const Mask mask) {
+        auto& query = queries_[mask];
+        for (; query.seen < tables_.size(); ++query.seen) {
+            if ((tables_[query.seen].mask & mask) == mask) {
+                query.tables.push_back(static_cast<std::uint32_t>(query.seen));
+            }
+        }
+        return query.tables;
+    }
+
+    template<bool Add>
+    std::uint32_t neighbour(const std::uint32_t table_index, const std::size_t component) {
+        auto edge = Add ? tables_[table_index].add_edges[component] : tables_[table_index].remove_edges[component];
+        if (edge == NONE) {
+            const auto bit = Mask{1} << component;
+            const auto mask = tables_[table_index].mask;
+            // get_table() may grow tables_, so the edge is stored after it returns
+            edge = get_table(Add ? mask | bit : mask & ~bit);
+            (Add ? tables_[table_index].add_edges : tables_[table_index].remove_edges)[component] = edge;
+        }
+        return edge;
+    }
+
+    // Relocates the entity's shared components to the target table and destroys the others
+    std::uint32_t move_row(const EntityID id, const std::uint32_t target_index) {
+        const auto source_index = locations_[id].table;
+        const auto row = locations_[id].row;
+        auto& source = tables_[source_index];
+        auto& target = tables_[target_index];
+
+        (move_cell<Components>(source, row, target), ...);
+        target.ids.push_back(id);
+        erase_id(source, row);
+        locations_[id] = {target_index, static_cast<std::uint32_t>(target.size() - 1)};
+        return target_index;
+    }
+
+    template<typename T>
+    static void move_cell(Table& source, const std::size_t row, Table& target) {
+        if (source.mask & target.mask & mask_of<T>) {
+            target.template column<T>().relocate_from(source.template column<T>(), row);
+        } else if (source.mask & mask_of<T>) {
+            source.template column<T>().erase_swap(row);
+        }
+    }
+
+    // Fills the row with the table's last entity
+    void erase_row(const std::uint32_t table_index, const std::uint32_t row) noexcept {
+        auto& table = tables_[table_index];
+        (erase_cell<Components>(table, row), ...);
+        erase_id(table, row);
+    }
+
+    template<typename T>
+    static void erase_cell(Table& table, const std::size_t row) noexcept {
+        if (table.mask & mask_of<T>) {
+            table.template column<T>().erase_swap(row);
+        }
+    }
+
+    void erase_id(Table& table, const std::uint32_t row) noexcept {
+        const auto last = table.size() - 1;
+        if (row != last) {
+            table.ids[row] = table.ids[last];
+            locations_[table.ids[row]].row = row;
+        }
+        table.ids.pop_back();
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_REGISTRY_HPP
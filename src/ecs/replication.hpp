@@ -0,0 +1,1176 @@
+#ifndef GAME_ECS_REPLICATION_HPP
+#define GAME_ECS_REPLICATION_HPP
+
+#include "entity.hpp"
+#include "snapshot.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Packs values of arbitrary bit widths, least significant bit first
+ *
+ * Varints are written as 7-bit groups with a continuation bit and are not
+ * byte aligned. Call flush() once to write the last partial byte.
+ */
+class BitWriter {
+    std::vector<char>& out_;
+    std::uint64_t buffer_{0};
+    std::uint32_t buffered_{0};
+
+public:
+    explicit BitWriter(std::vector<char>& out) noexcept : out_(out) {}
+
+    /**
+     * @brief Writes the low `bits` bits of `value`; `bits` is at most 32
+     */
+    void write(std::uint32_t value, const std::uint32_t bits) {
+        if (bits < 32) {
+            value &= (1u << bits) - 1;
+        }
+        buffer_ |= static_cast<std::uint64_t>(value) << buffered_;
+        buffered_ += bits;
+        while (buffered_ >= 8) {
+            out_.push_back(static_cast<char>(buffer_ & 0xFF));
+            buffer_ >>= 8;
+            buffered_ -= 8;
+        }
+    }
+
+    void write_bool(const bool value) {
+        write(value ? 1u : 0u, 1);
+    }
+
+    void write_varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            write(static_cast<std::uint32_t>(value & 0x7F) | 0x80, 8);
+            value >>= 7;
+        }
+        write(static_cast<std::uint32_t>(value), 8);
+    }
+
+    void flush() {
+        if (buffered_ > 0) {
+            out_.push_back(static_cast<char>(buffer_ & 0xFF));
+            buffer_ = 0;
+            buffered_ = 0;
+        }
+    }
+};
+
+/**
+ * @brief Reads back a BitWriter stream; every read fails once the data runs out
+ */
+class BitReader {
+    const unsigned char* data_;
+    std::size_t size_;
+    std::size_t position_{0};
+    std::uint64_t buffer_{0};
+    std::uint32_t buffered_{0};
+    bool failed_{false};
+
+public:
+    BitReader(const char* data, const std::size_t size) noexcept
+        : data_(reinterpret_cast<const unsigned char*>(data))
+        , size_(size) {}
+
+    bool has_failed() const noexcept { return failed_; }
+
+    bool read(std::uint32_t& value, const std::uint32_t bits) noexcept {
+        while (buffered_ < bits) {
+            if (position_ >= size_) {
+                failed_ = true;
+                value = 0;
+                return false;
+            }
+            buffer_ |= static_cast<std::uint64_t>(data_[position_++]) << buffered_;
+            buffered_ += 8;
+        }
+        value = static_cast<std::uint32_t>(bits < 32 ? buffer_ & ((1ull << bits) - 1) : buffer_ & 0xFFFFFFFFull);
+        buffer_ >>= bits;
+        buffered_ -= bits;
+        return true;
+    }
+
+    bool read_bool(bool& value) noexcept {
+        std::uint32_t bit = 0;
+        const bool ok = read(bit, 1);
+        value = bit != 0;
+        return ok;
+    }
+
+    bool read_varint(std::uint64_t& value) noexcept {
+        value = 0;
+        for (std::uint32_t shift = 0; shift < 64; shift += 7) {
+            std::uint32_t group = 0;
+            if (!read(group, 8)) {
+                return false;
+            }
+            value |= static_cast<std::uint64_t>(group & 0x7F) << shift;
+            if ((group & 0x80) == 0) {
+                return true;
+            }
+        }
+        failed_ = true;
+        return false;
+    }
+};
+
+/**
+ * @brief Describes how one component type is quantized for replication
+ *
+ * Each registered field becomes an unsigned integer of a fixed bit width.
+ * Floats are clamped to a range and rounded to a step; integers, enums and
+ * bools keep their low bits, with signed values zigzag encoded. Clients see
+ * the dequantized values, so ranges and steps decide replication precision.
+ */
+class ReplicatedComponent {
+protected:
+    enum class Kind { Float, Signed, Unsigned };
+
+    struct Field {
+        std::size_t offset;
+        std::size_t size;
+        Kind kind;
+        std::uint32_t bits;
+        std::uint32_t limit;
+        float min;
+        float step;
+    };
+
+    std::string name_;
+    std::type_index type_;
+    std::vector<Field> fields_;
+    std::uint64_t schema_hash_;
+
+    ReplicatedComponent(const std::string_view name, const std::type_index type)
+        : name_(name)
+        , type_(type)
+        , schema_hash_(hash_name(name)) {}
+
+public:
+    virtual ~ReplicatedComponent() = default;
+
+    const std::string& get_name() const noexcept { return name_; }
+    const std::type_index& get_type() const noexcept { return type_; }
+    std::uint64_t get_schema_hash() const noexcept { return schema_hash_; }
+    std::size_t get_field_count() const noexcept { return fields_.size(); }
+    std::uint32_t get_field_bits(const std::size_t field) const noexcept { return fields_[field].bits; }
+
+    /**
+     * @brief Writes the quantized value of every field to `values`
+     */
+    void quantize(const Component& component, std::uint32_t* values) const noexcept {
+        const auto* object = reinterpret_cast<const char*>(&component);
+        for (std::size_t i = 0; i < fields_.size(); ++i) {
+            values[i] = quantize(fields_[i], object + fields_[i].offset);
+        }
+    }
+
+    /**
+     * @brief Sets or adds the component from quantized values and reports the write
+     */
+    virtual void apply(Entity& entity, const std::uint32_t* values) const = 0;
+    virtual void remove(Entity& entity) const = 0;
+
+protected:
+    void dequantize(Component& component, const std::uint32_t* values) const noexcept {
+        auto* object = reinterpret_cast<char*>(&component);
+        for (std::size_t i = 0; i < fields_.size(); ++i) {
+            dequantize(fields_[i], values[i], object + fields_[i].offset);
+        }
+    }
+
+private:
+    static std::uint32_t quantize(const Field& field, const char* at) noexcept {
+        if (field.kind == Kind::Float) {
+            float value = 0.0f;
+            std::memcpy(&value, at, sizeof(value));
+            if (!(value > field.min)) {
+                return 0; // Also catches NaN
+            }
+            const float steps = (value - field.min) / field.step + 0.5f;
+            return steps >= static_cast<float>(field.limit) ? field.limit : static_cast<std::uint32_t>(steps);
+        }
+
+        std::uint64_t raw = 0;
+        std::memcpy(&raw, at, field.size); // Little-endian hosts only, like snapshots
+        if (field.kind == Kind::Signed) {
+            const auto shift = 64 - 8 * field.size;
+            const auto value = static_cast<std::int64_t>(raw << shift) >> shift;
+            raw = (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+        }
+        return static_cast<std::uint32_t>(raw) & field.limit;
+    }
+
+    static void dequantize(const Field& field, const std::uint32_t value, char* at) noexcept {
+        if (field.kind == Kind::Float) {
+            const float result = field.min + static_cast<float>(value) * field.step;
+            std::memcpy(at, &result, sizeof(result));
+            return;
+        }
+
+        std::uint64_t raw = value;
+        if (field.kind == Kind::Signed) {
+            raw = (raw >> 1) ^ (~(raw & 1) + 1);
+        }
+        std::memcpy(at, &raw, field.size);
+    }
+};
+
+template<typename T>
+class ReplicatedComponentOf : public ReplicatedComponent {
+public:
+    explicit ReplicatedComponentOf(const std::string_view name)
+        : ReplicatedComponent(name, std::type_index(typeid(T))) {
+        static_assert(std::is_base_of_v<Component, T>, "T must inherit Component");
+        static_assert(std::is_default_constructible_v<T>, "T must be default constructible to be replicated");
+    }
+
+    /**
+     * @brief Replicates a float clamped to [min, max] in multiples of `step`
+     */
+    ReplicatedComponentOf& quantized(const std::string_view name, float T::*member, const float min, const float max,
+                                     const float step) {
+        const auto steps = static_cast<std::uint64_t>(std::ceil((max - min) / step));
+        std::uint32_t bits = 1;
+        while (bits < 32 && (1ull << bits) <= steps) {
+            ++bits;
+        }
+
+        fields_.push_back({offset_of(member), sizeof(float), Kind::Float, bits, static_cast<std::uint32_t>(steps), min, step});
+        schema_hash_ = hash_combine(hash_name(name, schema_hash_), bits);
+        schema_hash_ = hash_combine(schema_hash_, bit_pattern(min) | (static_cast<std::uint64_t>(bit_pattern(step)) << 32));
+        return *this;
+    }
+
+    /**
+     * @brief Replicates the low `bits` bits of an integer, enum or bool; signed values are zigzag encoded
+     *
+     * Zigzag encoding doubles non-negative values, so a plain `enum class`,
+     * whose underlying type is int, needs one bit more than its largest
+     * enumerator.
+     */
+    template<typename F>
+    ReplicatedComponentOf& integer(const std::string_view name, F T::*member, const std::uint32_t bits) {
+        static_assert(std::is_integral_v<F> || std::is_enum_v<F>, "Use quantized() for floats");
+        static_assert(sizeof(F) <= 8, "F must fit in 64 bits");
+
+        const bool is_signed = [] {
+            if constexpr (std::is_enum_v<F>) {
+                return std::is_signed_v<std::underlying_type_t<F>>;
+            } else {
+                return std::is_signed_v<F>;
+            }
+        }();
+        const auto width = std::clamp<std::uint32_t>(bits, 1, 32);
+        const auto limit = width < 32 ? (1u << width) - 1 : 0xFFFFFFFFu;
+        fields_.push_back({offset_of(member), sizeof(F), is_signed ? Kind::Signed : Kind::Unsigned, width, limit, 0.0f, 1.0f});
+        schema_hash_ = hash_combine(hash_name(name, schema_hash_), (sizeof(F) << 8) | width);
+        return *this;
+    }
+
+    void apply(Entity& entity, const std::uint32_t* values) const override {
+        if (auto* existing = entity.get_component<T>()) {
+            dequantize(*existing, values);
+            entity.mark_written<T>();
+            return;
+        }
+
+        // Components are added fully populated so system hooks see the replicated state
+        T value{};
+        dequantize(value, values);
+        (void)entity.add_component<T>(std::move(value));
+    }
+
+    void remove(Entity& entity) const override {
+        (void)entity.remove_component<T>();
+    }
+
+private:
+    template<typename F>
+    static std::size_t offset_of(F T::*member) {
+        const T sample{};
+        return static_cast<std::size_t>(
+            reinterpret_cast<const char*>(&(sample.*member)) - reinterpret_cast<const char*>(&sample));
+    }
+
+    static std::uint32_t bit_pattern(const float value) noexcept {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+};
+
+/**
+ * @brief Registry of the systems and components that are replicated
+ *
+ * At most 32 component types can be registered. Systems and components are
+ * matched by registration order, so server and client must build the same
+ * schema; a hash of it is sent with every packet.
+ */
+class ReplicationSchema {
+public:
+    static constexpr std::size_t MAX_COMPONENTS = 32;
+
+    struct SystemEntry {
+        std::string name;
+        System* (*get)(World&);
+    };
+
+private:
+    std::vector<SystemEntry> systems_;
+    std::vector<std::unique_ptr<ReplicatedComponent>> components_;
+
+public:
+    template<typename T>
+    bool add_system(const std::string_view name) {
+        static_assert(std::is_base_of_v<System, T>, "T must inherit System");
+        systems_.push_back({std::string(name), [](World& world) -> System* {
+            return world.get_system<T>();
+        }});
+        return true;
+    }
+
+    /**
+     * @brief Registers a component; returns nullptr once MAX_COMPONENTS are registered
+     */
+    template<typename T>
+    ReplicatedComponentOf<T>* add_component(const std::string_view name) {
+        if (components_.size() >= MAX_COMPONENTS) {
+            return nullptr;
+        }
+        auto component = std::make_unique<ReplicatedComponentOf<T>>(name);
+        auto* result = component.get();
+        components_.push_back(std::move(component));
+        return result;
+    }
+
+    const std::vector<SystemEntry>& get_systems() const noexcept { return systems_; }
+    const std::vector<std::unique_ptr<ReplicatedComponent>>& get_components() const noexcept { return components_; }
+
+    std::uint64_t get_hash() const noexcept {
+        std::uint64_t hash = hash_name("replication");
+        for (const auto& system : systems_) {
+            hash = hash_name(system.name, hash);
+        }
+        for (const auto& component : components_) {
+            hash = hash_combine(hash, component->get_schema_hash());
+        }
+        return hash;
+    }
+};
+
+/**
+ * @brief An entity of a replicated system, identified by the system's index in the schema
+ */
+struct ReplicatedEntity {
+    std::uint32_t system;
+    EntityID id;
+
+    friend bool operator==(const ReplicatedEntity& lhs, const ReplicatedEntity& rhs) noexcept {
+        return lhs.system == rhs.system && lhs.id == rhs.id;
+    }
+
+    friend bool operator<(const ReplicatedEntity& lhs, const ReplicatedEntity& rhs) noexcept {
+        return lhs.system < rhs.system || (lhs.system == rhs.system && lhs.id < rhs.id);
+    }
+};
+
+/**
+ * @brief Quantized state of every replicated entity at one tick
+ *
+ * Entries are sorted by system and ID. An entry's values hold the fields of
+ * each component in its mask, in schema order.
+ */
+struct ReplicationFrame {
+    struct Entry {
+        std::uint32_t system;
+        EntityID id;
+        std::uint32_t mask;
+        std::uint32_t offset;
+    };
+
+    std::uint64_t sequence{0};
+    std::uint64_t tick_count{0};
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> values;
+
+    void clear() noexcept {
+        sequence = 0;
+        tick_count = 0;
+        entries.clear();
+        values.clear();
+    }
+};
+
+enum class ReplicationStatus {
+    Ok,
+    Stale,
+    SchemaMismatch,
+    MissingBaseline,
+    Malformed,
+};
+
+/**
+ * @brief Shared packet layout of ReplicationEncoder and ReplicationDecoder
+ *
+ * A packet starts with the schema hash, the frame sequence, the sequence
+ * of the baseline it is relative to (0 for the empty frame) and the tick
+ * count. Then, per system, each entity that differs from the baseline is
+ * written as a continuation bit, the varint gap to the previous ID and a
+ * two-bit operation. Created entities carry their component mask and full
+ * values. Updated entities carry a mask-changed bit (and the new mask), then
+ * for every component a changed bit followed by one changed bit per field.
+ * Changed fields are sent as a zigzag delta in SMALL_DELTA_BITS when it
+ * fits and at full width otherwise. Removed entities carry nothing else.
+ */
+class Replication {
+public:
+    static constexpr std::uint32_t SMALL_DELTA_BITS = 6;
+
+    enum class Op : std::uint32_t { Update = 0, Create = 1, Remove = 2 };
+
+    /**
+     * @brief Quantizes every replicated entity of `world` into `frame`
+     */
+    static void capture(World& world, const ReplicationSchema& schema, ReplicationFrame& frame) {
+        const auto& components = schema.get_components();
+        std::vector<const Entity*> entities;
+
+        frame.entries.clear();
+        frame.values.clear();
+        frame.tick_count = world.get_tick_count();
+
+        const auto& systems = schema.get_systems();
+        for (std::uint32_t s = 0; s < systems.size(); ++s) {
+            const auto* system = systems[s].get(world);
+            if (!system) {
+                continue;
+            }
+
+            entities.clear();
+            for (const auto& [_, entity] : system->get_entities()) {
+                entities.push_back(entity.get());
+            }
+            std::sort(entities.begin(), entities.end(),
+                      [](const Entity* lhs, const Entity* rhs) { return lhs->get_id() < rhs->get_id(); });
+
+            for (const auto* entity : entities) {
+                ReplicationFrame::Entry entry{s, entity->get_id(), 0, static_cast<std::uint32_t>(frame.values.size())};
+                const auto& owned = entity->get_components();
+                for (std::uint32_t c = 0; c < components.size(); ++c) {
+                    const auto it = owned.find(components[c]->get_type());
+                    if (it == owned.end()) {
+                        continue;
+                    }
+                    entry.mask |= 1u << c;
+                    const auto at = frame.values.size();
+                    frame.values.resize(at + components[c]->get_field_count());
+                    components[c]->quantize(*it->second, frame.values.data() + at);
+                }
+                frame.entries.push_back(entry);
+            }
+        }
+    }
+
+    static void encode(const ReplicationSchema& schema, const ReplicationFrame& baseline, const ReplicationFrame& frame,
+                       std::vector<char>& out) {
+        encode(schema, baseline, nullptr, frame, nullptr, out);
+    }
+
+    /**
+     * @brief encode() restricted to the given entry indices of each frame; nullptr selects every entry
+     */
+    static void encode(const ReplicationSchema& schema, const ReplicationFrame& baseline,
+                       const std::vector<std::uint32_t>* baseline_rows, const ReplicationFrame& frame,
+                       const std::vector<std::uint32_t>* frame_rows, std::vector<char>& out) {
+        const auto& components = schema.get_components();
+        const auto system_count = static_cast<std::uint32_t>(schema.get_systems().size());
+
+        out.clear();
+        BitWriter writer(out);
+        writer.write(static_cast<std::uint32_t>(schema.get_hash()), 32);
+        writer.write_varint(frame.sequence);
+        writer.write_varint(baseline.sequence);
+        writer.write_varint(frame.tick_count);
+
+        const auto baseline_size = baseline_rows ? baseline_rows->size() : baseline.entries.size();
+        const auto frame_size = frame_rows ? frame_rows->size() : frame.entries.size();
+        const auto baseline_at = [&](const std::size_t i) {
+            return &baseline.entries[baseline_rows ? (*baseline_rows)[i] : i];
+        };
+        const auto frame_at = [&](const std::size_t i) {
+            return &frame.entries[frame_rows ? (*frame_rows)[i] : i];
+        };
+
+        std::size_t b = 0;
+        std::size_t f = 0;
+        for (std::uint32_t s = 0; s < system_count; ++s) {
+            EntityID previous = 0;
+            const auto begin_record = [&](const EntityID id, const Op op) {
+                writer.write_bool(true);
+                writer.write_varint(id - previous);
+                writer.write(static_cast<std::uint32_t>(op), 2);
+                previous = id;
+            };
+
+            while (true) {
+                const auto* old_entry = b < baseline_size && baseline_at(b)->system == s ? baseline_at(b) : nullptr;
+                const auto* new_entry = f < frame_size && frame_at(f)->system == s ? frame_at(f) : nullptr;
+                if (!old_entry && !new_entry) {
+                    break;
+                }
+
+                if (new_entry && (!old_entry || new_entry->id < old_entry->id)) {
+                    begin_record(new_entry->id, Op::Create);
+                    writer.write(new_entry->mask, static_cast<std::uint32_t>(components.size()));
+                    write_full(writer, components, new_entry->mask, frame.values.data() + new_entry->offset);
+                    ++f;
+                } else if (old_entry && (!new_entry || old_entry->id < new_entry->id)) {
+                    begin_record(old_entry->id, Op::Remove);
+                    ++b;
+                } else {
+                    if (!same(components, *old_entry, baseline.values, *new_entry, frame.values)) {
+                        begin_record(new_entry->id, Op::Update);
+                        write_update(writer, components, *old_entry, baseline.values, *new_entry, frame.values);
+                    }
+                    ++b;
+                    ++f;
+                }
+            }
+            writer.write_bool(false);
+        }
+        writer.flush();
+    }
+
+    /**
+     * @brief Finds the entries of `frame` for the sorted `entities`; entities not in the frame are skipped
+     */
+    static void select(const ReplicationFrame& frame, const std::vector<ReplicatedEntity>& entities,
+                       std::vector<std::uint32_t>& rows) {
+        rows.clear();
+        auto first = frame.entries.begin();
+        for (const auto& entity : entities) {
+            first = std::lower_bound(first, frame.entries.end(), entity,
+                                     [](const ReplicationFrame::Entry& entry, const ReplicatedEntity& key) {
+                                         return ReplicatedEntity{entry.system, entry.id} < key;
+                                     });
+            if (first == frame.entries.end()) {
+                return;
+            }
+            if (first->system == entity.system && first->id == entity.id) {
+                rows.push_back(static_cast<std::uint32_t>(first - frame.entries.begin()));
+            }
+        }
+    }
+
+    /**
+     * @brief Rebuilds the frame a packet describes; `baseline_for` maps a sequence to a stored frame or nullptr
+     */
+    template<typename BaselineFor>
+    static ReplicationStatus decode(const ReplicationSchema& schema, const char* data, const std::size_t size,
+                                    BaselineFor&& baseline_for, ReplicationFrame& frame) {
+        const auto& components = schema.get_components();
+        const auto system_count = static_cast<std::uint32_t>(schema.get_systems().size());
+
+        BitReader reader(data, size);
+        std::uint32_t hash = 0;
+        std::uint64_t baseline_sequence = 0;
+        reader.read(hash, 32);
+        reader.read_varint(frame.sequence);
+        reader.read_varint(baseline_sequence);
+        reader.read_varint(frame.tick_count);
+        if (reader.has_failed()) {
+            return ReplicationStatus::Malformed;
+        }
+        if (hash != static_cast<std::uint32_t>(schema.get_hash())) {
+            return ReplicationStatus::SchemaMismatch;
+        }
+
+        static const ReplicationFrame empty;
+        const ReplicationFrame* baseline = baseline_sequence == 0 ? &empty : baseline_for(baseline_sequence);
+        if (!baseline) {
+            return ReplicationStatus::MissingBaseline;
+        }
+
+        frame.entries.clear();
+        frame.values.clear();
+
+        const auto copy = [&](const ReplicationFrame::Entry& entry) {
+            const auto offset = static_cast<std::uint32_t>(frame.values.size());
+            const auto count = value_count(components, entry.mask);
+            frame.values.insert(frame.values.end(), baseline->values.begin() + entry.offset,
+                                baseline->values.begin() + entry.offset + count);
+            frame.entries.push_back({entry.system, entry.id, entry.mask, offset});
+        };
+
+        std::size_t b = 0;
+        for (std::uint32_t s = 0; s < system_count; ++s) {
+            EntityID id = 0;
+            bool more = false;
+            while (reader.read_bool(more) && more) {
+                std::uint64_t gap = 0;
+                std::uint32_t op = 0;
+                if (!reader.read_varint(gap) || !reader.read(op, 2) || gap == 0) {
+                    return ReplicationStatus::Malformed;
+                }
+                id += gap;
+
+                while (b < baseline->entries.size() && baseline->entries[b].system == s && baseline->entries[b].id < id) {
+                    copy(baseline->entries[b++]);
+                }
+                const bool in_baseline = b < baseline->entries.size() && baseline->entries[b].system == s &&
+                                         baseline->entries[b].id == id;
+
+                switch (static_cast<Op>(op)) {
+                case Op::Create: {
+                    std::uint32_t mask = 0;
+                    if (in_baseline || !reader.read(mask, static_cast<std::uint32_t>(components.size()))) {
+                        return ReplicationStatus::Malformed;
+                    }
+                    frame.entries.push_back({s, id, mask, static_cast<std::uint32_t>(frame.values.size())});
+                    if (!read_full(reader, components, mask, frame.values)) {
+                        return ReplicationStatus::Malformed;
+                    }
+                    break;
+                }
+                case Op::Update:
+                    if (!in_baseline || !read_update(reader, components, baseline->entries[b], baseline->values, frame)) {
+                        return ReplicationStatus::Malformed;
+                    }
+                    ++b;
+                    break;
+                case Op::Remove:
+                    if (!in_baseline) {
+                        return ReplicationStatus::Malformed;
+                    }
+                    ++b;
+                    break;
+                default:
+                    return ReplicationStatus::Malformed;
+                }
+            }
+            if (reader.has_failed()) {
+                return ReplicationStatus::Malformed;
+            }
+
+            while (b < baseline->entries.size() && baseline->entries[b].system == s) {
+                copy(baseline->entries[b++]);
+            }
+        }
+        return b == baseline->entries.size() ? ReplicationStatus::Ok : ReplicationStatus::Malformed;
+    }
+
+    /**
+     * @brief Applies the difference between two frames to the replicated systems of `world`
+     */
+    static void apply(World& world, const ReplicationSchema& schema, const ReplicationFrame& from,
+                      const ReplicationFrame& to) {
+        const auto& components = schema.get_components();
+        std::vector<System*> systems;
+        for (const auto& entry : schema.get_systems()) {
+            systems.push_back(entry.get(world));
+        }
+
+        std::size_t b = 0;
+        std::size_t f = 0;
+        while (b < from.entries.size() || f < to.entries.size()) {
+            const auto* old_entry = b < from.entries.size() ? &from.entries[b] : nullptr;
+            const auto* new_entry = f < to.entries.size() ? &to.entries[f] : nullptr;
+            const auto before = [](const ReplicationFrame::Entry& lhs, const ReplicationFrame::Entry& rhs) {
+                return lhs.system < rhs.system || (lhs.system == rhs.system && lhs.id < rhs.id);
+            };
+
+            if (new_entry && (!old_entry || before(*new_entry, *old_entry))) {
+                if (auto* system = systems[new_entry->system]) {
+                    if (auto* entity = system->add_entity(new_entry->id)) {
+                        apply_components(*entity, components, 0, nullptr, new_entry->mask, to.values.data() + new_entry->offset);
+                    }
+                }
+                ++f;
+            } else if (old_entry && (!new_entry || before(*old_entry, *new_entry))) {
+                if (auto* system = systems[old_entry->system]) {
+                    system->remove_entity(old_entry->id);
+                }
+                ++b;
+            } else {
+                auto* system = systems[new_entry->system];
+                auto* entity = system ? system->get_entity(new_entry->id) : nullptr;
+                if (entity) {
+                    apply_components(*entity, components, old_entry->mask, from.values.data() + old_entry->offset,
+                                     new_entry->mask, to.values.data() + new_entry->offset);
+                }
+                ++b;
+                ++f;
+            }
+        }
+        world.set_tick_count(to.tick_count);
+    }
+
+private:
+    using Components = std::vector<std::unique_ptr<ReplicatedComponent>>;
+
+    static std::size_t value_count(const Components& components, const std::uint32_t mask) noexcept {
+        std::size_t count = 0;
+        for (std::size_t c = 0; c < components.size(); ++c) {
+            if (mask & (1u << c)) {
+                count += components[c]->get_field_count();
+            }
+        }
+        return count;
+    }
+
+    static bool same(const Components& components, const ReplicationFrame::Entry& lhs,
+                     const std::vector<std::uint32_t>& lhs_values, const ReplicationFrame::Entry& rhs,
+                     const std::vector<std::uint32_t>& rhs_values) noexcept {
+        if (lhs.mask != rhs.mask) {
+            return false;
+        }
+        const auto count = value_count(components, lhs.mask);
+        return std::equal(lhs_values.begin() + lhs.offset, lhs_values.begin() + lhs.offset + count,
+                          rhs_values.begin() + rhs.offset);
+    }
+
+    static void write_full(BitWriter& writer, const Components& components, const std::uint32_t mask,
+                           const std::uint32_t* values) {
+        for (std::size_t c = 0; c < components.size(); ++c) {
+            if (!(mask & (1u << c))) {
+                continue;
+            }
+            for (std::size_t i = 0; i < components[c]->get_field_count(); ++i) {
+                writer.write(*values++, components[c]->get_field_bits(i));
+            }
+        }
+    }
+
+    static bool read_full(BitReader& reader, const Components& components, const std::uint32_t mask,
+                          std::vector<std::uint32_t>& values) {
+        for (std::size_t c = 0; c < components.size(); ++c) {
+            if (!(mask & (1u << c))) {
+                continue;
+            }
+            for (std::size_t i = 0; i < components[c]->get_field_count(); ++i) {
+                std::uint32_t value = 0;
+                if (!reader.read(value, components[c]->get_field_bits(i))) {
+                    return false;
+                }
+                values.push_back(value);
+            }
+        }
+        return true;
+    }
+
+    static void write_field(BitWriter& writer, const std::uint32_t old_value, const std::uint32_t new_value,
+                            const std::uint32_t bits) {
+        const auto delta = static_cast<std::int32_t>(new_value - old_value);
+        const auto zigzag = (static_cast<std::uint32_t>(delta) << 1) ^ static_cast<std::uint32_t>(delta >> 31);
+        if (bits > SMALL_DELTA_BITS + 1) {
+            const bool small = zigzag < (1u << SMALL_DELTA_BITS);
+            writer.write_bool(small);
+            if (small) {
+                writer.write(zigzag, SMALL_DELTA_BITS);
+                return;
+            }
+        }
+        writer.write(new_value, bits);
+    }
+
+    static bool read_field(BitReader& reader, const std::uint32_t old_value, const std::uint32_t bits,
+                           std::uint32_t& value) {
+        if (bits > SMALL_DELTA_BITS + 1) {
+            bool small = false;
+            if (!reader.read_bool(small)) {
+                return false;
+            }
+            if (small) {
+                std::uint32_t zigzag = 0;
+                if (!reader.read(zigzag, SMALL_DELTA_BITS)) {
+                    return false;
+                }
+                value = old_value + ((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+                return true;
+            }
+        }
+        return reader.read(value, bits);
+    }
+
+    static void write_update(BitWriter& writer, const Components& components, const ReplicationFrame::Entry& old_entry,
+                             const std::vector<std::uint32_t>& old_values, const ReplicationFrame::Entry& new_entry,
+                             const std::vector<std::uint32_t>& new_values) {
+        const bool mask_changed = old_entry.mask != new_entry.mask;
+        writer.write_bool(mask_changed);
+        if (mask_changed) {
+            writer.write(new_entry.mask, static_cast<std::uint32_t>(components.size()));
+        }
+
+        const auto* old_at = old_values.data() + old_entry.offset;
+        const auto* new_at = new_values.data() + new_entry.offset;
+        for (std::size_t c = 0; c < components.size(); ++c) {
+            const auto bit = 1u << c;
+            const auto count = components[c]->get_field_count();
+            const bool in_old = old_entry.mask & bit;
+            const bool in_new = new_entry.mask & bit;
+
+            if (in_new && !in_old) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    writer.write(new_at[i], components[c]->get_field_bits(i));
+                }
+            } else if (in_new && in_old) {
+                const bool changed = !std::equal(old_at, old_at + count, new_at);
+                writer.write_bool(changed);
+                for (std::size_t i = 0; changed && i < count; ++i) {
+                    writer.write_bool(old_at[i] != new_at[i]);
+                    if (old_at[i] != new_at[i]) {
+                        write_field(writer, old_at[i], new_at[i], components[c]->get_field_bits(i));
+                    }
+                }
+            }
+
+            old_at += in_old ? count : 0;
+            new_at += in_new ? count : 0;
+        }
+    }
+
+    static bool read_update(BitReader& reader, const Components& components, const ReplicationFrame::Entry& old_entry,
+                            const std::vector<std::uint32_t>& old_values, ReplicationFrame& frame) {
+        bool mask_changed = false;
+        std::uint32_t mask = old_entry.mask;
+        if (!reader.read_bool(mask_changed) ||
+            (mask_changed && !reader.read(mask, static_cast<std::uint32_t>(components.size())))) {
+            return false;
+        }
+
+        frame.entries.push_back({old_entry.system, old_entry.id, mask, static_cast<std::uint32_t>(frame.values.size())});
+        const auto* old_at = old_values.data() + old_entry.offset;
+        for (std::size_t c = 0; c < components.size(); ++c) {
+            const auto bit = 1u << c;
+            const auto count = components[c]->get_field_count();
+            const bool in_old = old_entry.mask & bit;
+            const bool in_new = mask & bit;
+
+            if (in_new && !in_old) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::uint32_t value = 0;
+                    if (!reader.read(value, components[c]->get_field_bits(i))) {
+                        return false;
+                    }
+                    frame.values.push_back(value);
+                }
+            } else if (in_new && in_old) {
+                bool changed = false;
+                if (!reader.read_bool(changed)) {
+                    return false;
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    bool field_changed = false;
+                    std::uint32_t value = old_at[i];
+                    if (changed && (!reader.read_bool(field_changed) ||
+                                    (field_changed && !read_field(reader, old_at[i], components[c]->get_field_bits(i), value)))) {
+                        return false;
+                    }
+                    frame.values.push_back(value);
+                }
+            }
+
+            old_at += in_old ? count : 0;
+        }
+        return true;
+    }
+
+    static void apply_components(Entity& entity, const Components& components, const std::uint32_t old_mask,
+                                 const std::uint32_t* old_at, const std::uint32_t new_mask, const std::uint32_t* new_at) {
+        for (std::size_t c = 0; c < components.size(); ++c) {
+            const auto bit = 1u << c;
+            const auto count = components[c]->get_field_count();
+            const bool in_old = old_mask & bit;
+            const bool in_new = new_mask & bit;
+
+            if (in_new && (!in_old || !std::equal(old_at, old_at + count, new_at))) {
+                components[c]->apply(entity, new_at);
+            } else if (in_old && !in_new) {
+                components[c]->remove(entity);
+            }
+
+            old_at += in_old ? count : 0;
+            new_at += in_new ? count : 0;
+        }
+    }
+};
+
+/**
+ * @brief Server side of replication: one delta stream per client
+ *
+ * capture() quantizes the world once per tick into a new frame and keeps
+ * the last `history` frames. encode() writes the latest frame for a client
+ * as a delta against the newest frame that client acknowledged, or against
+ * the empty frame if that frame is no longer kept. Lost packets need no
+ * resend: the next packet is still relative to what the client has.
+ *
+ * A client can be limited to a relevance set, e.g. from interest
+ * management. Entities entering the set are sent as created and entities
+ * leaving it as removed. The encoder remembers which entries each
+ * unacknowledged packet held, so deltas stay relative to what the client
+ * actually received.
+ */
+class ReplicationEncoder {
+    struct Sent {
+        std::uint64_t sequence;
+        bool filtered;
+        std::vector<std::uint32_t> rows;
+    };
+
+    struct Client {
+        std::uint64_t acknowledged{0};
+        bool connected{false};
+        const std::vector<ReplicatedEntity>* relevant{nullptr};
+        std::deque<Sent> sent;
+    };
+
+    World& world_;
+    const ReplicationSchema& schema_;
+    std::size_t history_;
+    std::deque<ReplicationFrame> frames_;
+    std::vector<Client> clients_;
+    std::uint64_t sequence_{0};
+
+public:
+    ReplicationEncoder(World& world, const ReplicationSchema& schema, const std::size_t history = 32)
+        : world_(world)
+        , schema_(schema)
+        , history_(std::max<std::size_t>(history, 1)) {}
+
+    std::uint64_t get_sequence() const noexcept { return sequence_; }
+
+    /**
+     * @brief Adds a client that starts from the empty frame; returns its ID
+     */
+    std::uint32_t add_client() {
+        for (std::uint32_t id = 0; id < clients_.size(); ++id) {
+            if (!clients_[id].connected) {
+                clients_[id] = {};
+                clients_[id].connected = true;
+                return id;
+            }
+        }
+        clients_.emplace_back();
+        clients_.back().connected = true;
+        return static_cast<std::uint32_t>(clients_.size() - 1);
+    }
+
+    void remove_client(const std::uint32_t client) noexcept {
+        if (client < clients_.size()) {
+            clients_[client].connected = false;
+            clients_[client].relevant = nullptr;
+            clients_[client].sent.clear();
+        }
+    }
+
+    /**
+     * @brief Limits later packets for `client` to the entities in `relevant`, sorted; nullptr sends everything
+     *
+     * The set is read by every encode() call, so it must outlive them or be
+     * replaced first.
+     */
+    void set_relevant(const std::uint32_t client, const std::vector<ReplicatedEntity>* relevant) noexcept {
+        if (client < clients_.size()) {
+            clients_[client].relevant = relevant;
+        }
+    }
+
+    std::uint64_t get_acknowledged(const std::uint32_t client) const noexcept {
+        return client < clients_.size() ? clients_[client].acknowledged : 0;
+    }
+
+    /**
+     * @brief Quantizes the world as it is now into the next frame; returns its sequence
+     */
+    std::uint64_t capture() {
+        if (frames_.size() >= history_) {
+            auto recycled = std::move(frames_.front());
+            frames_.pop_front();
+            frames_.push_back(std::move(recycled));
+        } else {
+            frames_.emplace_back();
+        }
+
+        auto& frame = frames_.back();
+        frame.sequence = ++sequence_;
+        Replication::capture(world_, schema_, frame);
+        return sequence_;
+    }
+
+    /**
+     * @brief Writes the latest frame for `client`; false if nothing was captured or the client is unknown
+     */
+    bool encode(const std::uint32_t client, std::vector<char>& out) {
+        if (frames_.empty() || client >= clients_.size() || !clients_[client].connected) {
+            return false;
+        }
+
+        auto& state = clients_[client];
+        const auto& frame = frames_.back();
+
+        if (state.sent.empty() || state.sent.back().sequence != frame.sequence) {
+            if (state.sent.size() >= history_) {
+                state.sent.pop_front();
+            }
+            state.sent.push_back({frame.sequence, false, {}});
+        }
+        auto& current = state.sent.back();
+
+        // The baseline is what the client received for its acknowledged frame
+        const auto* baseline = find(state.acknowledged);
+        const Sent* baseline_sent = nullptr;
+        for (const auto& sent : state.sent) {
+            if (sent.sequence == state.acknowledged && &sent != &current) {
+                baseline_sent = &sent;
+            }
+        }
+        if (!baseline_sent) {
+            baseline = nullptr;
+        }
+
+        current.filtered = state.relevant != nullptr;
+        if (current.filtered) {
+            Replication::select(frame, *state.relevant, current.rows);
+        } else {
+            current.rows.clear();
+        }
+
+        static const ReplicationFrame empty;
+        const auto* baseline_rows = baseline && baseline_sent->filtered ? &baseline_sent->rows : nullptr;
+        Replication::encode(schema_, baseline ? *baseline : empty, baseline_rows, frame,
+                            current.filtered ? &current.rows : nullptr, out);
+        return true;
+    }
+
+    /**
+     * @brief Records that `client` has applied frame `sequence`; older acknowledgements are ignored
+     */
+    void acknowledge(const std::uint32_t client, const std::uint64_t sequence) noexcept {
+        if (client >= clients_.size() || sequence > sequence_) {
+            return;
+        }
+
+        auto& state = clients_[client];
+        state.acknowledged = std::max(state.acknowledged, sequence);
+        while (!state.sent.empty() && state.sent.front().sequence < state.acknowledged) {
+            state.sent.pop_front();
+        }
+    }
+
+    /**
+     * @brief acknowledge() from a packet written by ReplicationDecoder::write_ack()
+     */
+    bool receive_ack(const std::uint32_t client, const char* data, const std::size_t size) noexcept {
+        BitReader reader(data, size);
+        std::uint64_t sequence = 0;
+        if (!reader.read_varint(sequence)) {
+            return false;
+        }
+        acknowledge(client, sequence);
+        return true;
+    }
+
+private:
+    const ReplicationFrame* find(const std::uint64_t sequence) const noexcept {
+        if (sequence == 0 || frames_.empty() || sequence < frames_.front().sequence) {
+            return nullptr;
+        }
+        const auto index = static_cast<std::size_t>(sequence - frames_.front().sequence);
+        return index < frames_.size() ? &frames_[index] : nullptr;
+    }
+};
+
+/**
+ * @brief Client side of replication: rebuilds frames and applies them to a world
+ *
+ * Each packet is decoded against the frame it names as its baseline, which
+ * must still be among the last `history` frames received. The result is
+ * compared with the frame applied last, and only the difference touches the
+ * world: entities are created with the server's IDs, and components are
+ * added, removed or overwritten through mark_written(). Packets older than
+ * the last applied frame are ignored. The replicated systems of the client
+ * world belong to the decoder; entities created there locally may collide.
+ */
+class ReplicationDecoder {
+    World& world_;
+    const ReplicationSchema& schema_;
+    std::size_t history_;
+    std::deque<ReplicationFrame> frames_;
+    ReplicationFrame decoded_;
+
+public:
+    ReplicationDecoder(World& world, const ReplicationSchema& schema, const std::size_t history = 32)
+        : world_(world)
+        , schema_(schema)
+        , history_(std::max<std::size_t>(history, 1)) {}
+
+    /**
+     * @brief Sequence of the frame the world currently shows; 0 before the first packet
+     */
+    std::uint64_t get_sequence() const noexcept { return frames_.empty() ? 0 : frames_.back().sequence; }
+
+    ReplicationStatus receive(const char* data, const std::size_t size) {
+        const auto status = Replication::decode(schema_, data, size, [this](const std::uint64_t sequence) {
+            return find(sequence);
+        }, decoded_);
+        if (status != ReplicationStatus::Ok) {
+            return status;
+        }
+        if (decoded_.sequence <= get_sequence()) {
+            return ReplicationStatus::Stale;
+        }
+
+        static const ReplicationFrame empty;
+        Replication::apply(world_, schema_, frames_.empty() ? empty : frames_.back(), decoded_);
+
+        if (frames_.size() >= history_) {
+            frames_.pop_front();
+        }
+        frames_.push_back(std::move(decoded_));
+        decoded_.clear();
+        return ReplicationStatus::Ok;
+    }
+
+    /**
+     * @brief Writes the acknowledgement the server passes to ReplicationEncoder::receive_ack()
+     */
+    void write_ack(std::vector<char>& out) const {
+        out.clear();
+        BitWriter writer(out);
+        writer.write_varint(get_sequence());
+        writer.flush();
+    }
+
+private:
+    const ReplicationFrame* find(const std::uint64_t sequence) const noexcept {
+        for (const auto& frame : frames_) {
+            if (frame.sequence == sequence) {
+                return &frame;
+            }
+        }
+        return nullptr;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_REPLICATION_HPP
@@ -0,0 +1,604 @@
+#ifndef GAME_ECS_ROLLBACK_HPP
+#define GAME_ECS_ROLLBACK_HPP
+
+#include "entity.hpp"
+#include "snapshot.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Ring of in-memory world states for rollback and what-if simulation
+ *
+ * capture() stores the world as the next frame and restore() puts the world
+ * back to any retained frame. Both work on chunks of `1 << chunk_shift`
+ * consecutive entity IDs. capture() only writes a chunk that changed since
+ * the previous capture, and restore() only touches a chunk that changed
+ * since the requested frame. A chunk image holds its components' schema
+ * records grouped by component type. Columns that were not written since
+ * the previous image are memcpy'd from it instead of being saved again.
+ *
+ * If a chunk has the same entities and component types as when the image
+ * was taken, it is restored in place through cached component pointers.
+ * Only the columns written since that frame are restored. Chunks that
+ * gained or lost entities or components are rebuilt by removing and
+ * re-creating their entities. In-place writes are reported to the system's
+ * observers as write_component() would report them. When the ring is full,
+ * the oldest frame's images become a per-chunk base. This lets the oldest
+ * frame be restored even for chunks that have not changed for many frames.
+ *
+ * Changes are detected through the same notifications as ChangeTracker, so
+ * writes through raw component pointers must use mark_written().
+ */
+class RollbackBuffer {
+public:
+    static constexpr std::uint64_t NO_FRAME = ~0ull;
+
+private:
+    static constexpr std::uint64_t NO_IMAGE = ~0ull;
+    static constexpr std::uint64_t ALL_COLUMNS = ~0ull;
+
+    struct ImageHeader {
+        std::uint64_t structure;
+        std::uint64_t written; // Column bits written since the chunk's previous image
+        std::uint32_t entity_count;
+        std::uint32_t column_count;
+    };
+
+    struct ImageColumn {
+        std::uint32_t component;
+        std::uint32_t count;
+        std::uint32_t blob_offset;
+        std::uint32_t blob_size;
+    };
+
+    struct ImageView {
+        ImageHeader header;
+        const char* ids;
+        const char* columns;
+        const char* rows;
+        const char* records;
+        const char* blob;
+        std::size_t size;
+
+        ImageColumn column(const std::uint32_t i) const noexcept {
+            ImageColumn result;
+            std::memcpy(&result, columns + i * sizeof(result), sizeof(result));
+            return result;
+        }
+    };
+
+    // Entities and component instances of one chunk in image order
+    struct Layout {
+        std::vector<EntityID> ids;
+        std::vector<ImageColumn> columns;
+        std::vector<std::uint32_t> rows;
+        std::vector<Component*> components;
+    };
+
+    struct Chunk {
+        std::uint64_t structure{0};
+        std::uint64_t written{0};
+        std::uint64_t layout_structure{NO_IMAGE};
+        Layout layout;
+        std::vector<char> base;
+        bool dirty{false};
+    };
+
+    class Tracker;
+
+    struct SystemState {
+        const SnapshotSchema::SystemEntry* entry;
+        System* system;
+        std::unique_ptr<Tracker> tracker;
+        std::vector<Chunk> chunks;
+        std::vector<std::uint32_t> dirty;
+    };
+
+    struct SlotSystem {
+        std::vector<std::uint64_t> image_of;
+        std::vector<std::uint32_t> captured;
+        EntityID next_entity_id{1};
+    };
+
+    struct Slot {
+        std::uint64_t frame{NO_FRAME};
+        std::uint64_t tick_count{0};
+        std::vector<char> arena;
+        std::vector<SlotSystem> systems;
+    };
+
+    /**
+     * @brief Marks chunks dirty; structural events also give the chunk a new structure version
+     */
+    class Tracker : public EntityObserver {
+        RollbackBuffer& owner_;
+        SystemState& state_;
+        std::type_index last_type_{typeid(void)};
+        std::uint64_t last_bit_{0};
+
+    public:
+        Tracker(RollbackBuffer& owner, SystemState& state)
+            : owner_(owner)
+            , state_(state) {}
+
+        void on_entity_added(Entity& entity) noexcept override { structural(entity.get_id()); }
+        void on_entity_removed(Entity& entity) noexcept override { structural(entity.get_id()); }
+
+        void on_component_added(Entity& entity, const std::type_index&) noexcept override {
+            structural(entity.get_id());
+        }
+
+        void on_component_removed(Entity& entity, const std::type_index&) noexcept override {
+            structural(entity.get_id());
+        }
+
+        void on_component_written(Entity& entity, const std::type_index& type) noexcept override {
+            if (owner_.restoring_) {
+                return;
+            }
+            // Writes come in runs of one type, so remember the last lookup
+            if (type != last_type_) {
+                last_type_ = type;
+                last_bit_ = owner_.column_bit(type);
+            }
+            const auto c = owner_.chunk_of(entity.get_id());
+            owner_.chunk(state_, c).written |= last_bit_;
+            owner_.mark_dirty(state_, c);
+        }
+
+    private:
+        void structural(const EntityID id) noexcept {
+            if (owner_.restoring_) {
+                return; // restore() sets chunk state itself
+            }
+            const auto c = owner_.chunk_of(id);
+            auto& chunk = owner_.chunk(state_, c);
+            chunk.structure = ++owner_.structure_counter_;
+            chunk.written = ALL_COLUMNS;
+            owner_.mark_dirty(state_, c);
+        }
+    };
+
+    World& world_;
+    const SnapshotSchema& schema_;
+    std::uint32_t chunk_shift_;
+    std::vector<std::unique_ptr<SystemState>> systems_;
+    std::vector<Slot> slots_;
+    std::unordered_map<std::type_index, std::uint32_t> component_index_;
+    std::uint64_t oldest_{0};
+    std::uint64_t newest_{NO_FRAME};
+    std::uint64_t structure_counter_{0};
+    bool restoring_{false};
+
+    std::vector<char> blob_;
+    std::vector<Entity*> entities_;
+    std::vector<std::vector<std::pair<std::uint32_t, Component*>>> columns_;
+
+public:
+    RollbackBuffer(World& world, const SnapshotSchema& schema, const std::size_t slot_count = 8,
+                   const std::uint32_t chunk_shift = 6)
+        : world_(world)
+        , schema_(schema)
+        , chunk_shift_(chunk_shift)
+        , slots_(std::max<std::size_t>(slot_count, 1))
+        , columns_(schema.get_components().size()) {
+        const auto& components = schema_.get_components();
+        for (std::size_t i = 0; i < components.size(); ++i) {
+            component_index_.emplace(components[i]->get_type(), static_cast<std::uint32_t>(i));
+        }
+
+        for (const auto& entry : schema_.get_systems()) {
+            auto* system = entry.get(world_);
+            if (!system) {
+                continue;
+            }
+
+            auto state = std::make_unique<SystemState>();
+            state->entry = &entry;
+            state->system = system;
+            state->tracker = std::make_unique<Tracker>(*this, *state);
+            system->attach_observer(state->tracker.get());
+
+            // Everything that exists now goes into the first capture
+            for (const auto& [id, _] : system->get_entities()) {
+                auto& target = chunk(*state, chunk_of(id));
+                target.structure = ++structure_counter_;
+                target.written = ALL_COLUMNS;
+                mark_dirty(*state, chunk_of(id));
+            }
+            systems_.push_back(std::move(state));
+        }
+
+        for (auto& slot : slots_) {
+            slot.systems.resize(systems_.size());
+        }
+    }
+
+    RollbackBuffer(const RollbackBuffer&) = delete;
+    RollbackBuffer& operator=(const RollbackBuffer&) = delete;
+
+    ~RollbackBuffer() {
+        for (auto& state : systems_) {
+            state->system->detach_observer(state->tracker.get());
+        }
+    }
+
+    std::size_t get_slot_count() const noexcept { return slots_.size(); }
+    bool empty() const noexcept { return newest_ == NO_FRAME; }
+    std::uint64_t get_oldest_frame() const noexcept { return empty() ? NO_FRAME : oldest_; }
+    std::uint64_t get_newest_frame() const noexcept { return newest_; }
+
+    bool has_frame(const std::uint64_t frame) const noexcept {
+        return !empty() && frame >= oldest_ && frame <= newest_;
+    }
+
+    /**
+     * @brief World tick count when `frame` was captured
+     */
+    std::uint64_t get_tick_count(const std::uint64_t frame) const noexcept {
+        return has_frame(frame) ? slot(frame).tick_count : 0;
+    }
+
+    /**
+     * @brief Stores the current world state as a new frame and returns its number
+     */
+    std::uint64_t capture() {
+        const auto frame = empty() ? oldest_ : newest_ + 1;
+        if (!empty() && frame - oldest_ >= slots_.size()) {
+            evict_oldest();
+        }
+
+        auto& target = slot(frame);
+        target.tick_count = world_.get_tick_count();
+        target.arena.clear();
+
+        for (std::size_t s = 0; s < systems_.size(); ++s) {
+            auto& state = *systems_[s];
+            auto& captured = target.systems[s];
+            captured.image_of.assign(state.chunks.size(), NO_IMAGE);
+            captured.captured.clear();
+            captured.next_entity_id = state.system->get_next_entity_id();
+
+            for (const auto c : state.dirty) {
+                const auto* previous = empty() ? nullptr : find_image(s, c, newest_);
+                captured.image_of[c] = target.arena.size();
+                captured.captured.push_back(c);
+                write_image(state, c, previous, target.arena);
+                state.chunks[c].dirty = false;
+                state.chunks[c].written = 0;
+            }
+            state.dirty.clear();
+        }
+
+        target.frame = frame;
+        newest_ = frame;
+        return frame;
+    }
+
+    /**
+     * @brief Returns the world to `frame`; later frames are discarded
+     *
+     * Returns false if the frame is not retained or a saved record was
+     * rejected by the schema, in which case the world is partially restored.
+     */
+    bool restore(const std::uint64_t frame) {
+        if (!has_frame(frame)) {
+            return false;
+        }
+
+        bool ok = true;
+        restoring_ = true;
+        for (std::size_t s = 0; s < systems_.size(); ++s) {
+            auto& state = *systems_[s];
+
+            // Chunks changed since `frame` are dirty now or were captured by a later frame
+            for (auto later = frame + 1; later <= newest_; ++later) {
+                const auto& captured = slot(later).systems[s];
+                for (const auto c : captured.captured) {
+                    ImageHeader header;
+                    std::memcpy(&header, slot(later).arena.data() + captured.image_of[c], sizeof(header));
+                    state.chunks[c].written |= header.written;
+                    mark_dirty(state, c);
+                }
+            }
+
+            for (const auto c : state.dirty) {
+                ok = restore_chunk(state, c, find_image(s, c, frame)) && ok;
+                state.chunks[c].dirty = false;
+                state.chunks[c].written = 0;
+            }
+            state.dirty.clear();
+            state.system->set_next_entity_id(slot(frame).systems[s].next_entity_id);
+        }
+        restoring_ = false;
+
+        world_.set_tick_count(slot(frame).tick_count);
+        for (auto later = frame + 1; later <= newest_; ++later) {
+            slot(later).frame = NO_FRAME;
+        }
+        newest_ = frame;
+        return ok;
+    }
+
+private:
+    Slot& slot(const std::uint64_t frame) noexcept { return slots_[frame % slots_.size()]; }
+    const Slot& slot(const std::uint64_t frame) const noexcept { return slots_[frame % slots_.size()]; }
+
+    std::uint32_t chunk_of(const EntityID id) const noexcept { return static_cast<std::uint32_t>(id >> chunk_shift_); }
+
+    // Components past the 63rd share the last bit
+    static std::uint64_t bit_of(const std::uint32_t component) noexcept {
+        return 1ull << std::min<std::uint32_t>(component, 63);
+    }
+
+    std::uint64_t column_bit(const std::type_index& type) const noexcept {
+        const auto it = component_index_.find(type);
+        return it != component_index_.end() ? bit_of(it->second) : 0;
+    }
+
+    Chunk& chunk(SystemState& state, const std::uint32_t c) {
+        if (c >= state.chunks.size()) {
+            state.chunks.resize(c + 1);
+        }
+        return state.chunks[c];
+    }
+
+    void mark_dirty(SystemState& state, const std::uint32_t c) {
+        auto& target = chunk(state, c);
+        if (!target.dirty) {
+            target.dirty = true;
+            state.dirty.push_back(c);
+        }
+    }
+
+    void evict_oldest() {
+        auto& oldest = slot(oldest_);
+        for (std::size_t s = 0; s < systems_.size(); ++s) {
+            auto& state = *systems_[s];
+            const auto& captured = oldest.systems[s];
+            for (const auto c : captured.captured) {
+                const auto* image = oldest.arena.data() + captured.image_of[c];
+                state.chunks[c].base.assign(image, image + view(image).size);
+            }
+        }
+        oldest.frame = NO_FRAME;
+        ++oldest_;
+    }
+
+    /**
+     * @brief Latest image of chunk `c` taken at or before `frame`, or nullptr if the chunk was empty then
+     */
+    const char* find_image(const std::size_t s, const std::uint32_t c, const std::uint64_t frame) const noexcept {
+        for (auto f = frame + 1; f-- > oldest_;) {
+            const auto& captured = slot(f).systems[s];
+            if (c < captured.image_of.size() && captured.image_of[c] != NO_IMAGE) {
+                return slot(f).arena.data() + captured.image_of[c];
+            }
+        }
+        const auto& base = systems_[s]->chunks[c].base;
+        return base.empty() ? nullptr : base.data();
+    }
+
+    ImageView view(const char* image) const noexcept {
+        ImageView result;
+        std::memcpy(&result.header, image, sizeof(result.header));
+        result.ids = image + sizeof(ImageHeader);
+        result.columns = result.ids + result.header.entity_count * sizeof(EntityID);
+        result.rows = result.columns + result.header.column_count * sizeof(ImageColumn);
+
+        std::size_t instances = 0;
+        std::size_t record_bytes = 0;
+        std::size_t blob_bytes = 0;
+        for (std::uint32_t i = 0; i < result.header.column_count; ++i) {
+            const auto column = result.column(i);
+            instances += column.count;
+            record_bytes += column.count * schema_.get_components()[column.component]->get_record_size();
+            blob_bytes += column.blob_size;
+        }
+        result.records = result.rows + instances * sizeof(std::uint32_t);
+        result.blob = result.records + record_bytes;
+        result.size = static_cast<std::size_t>(result.blob + blob_bytes - image);
+        return result;
+    }
+
+    const Layout& layout(SystemState& state, const std::uint32_t c) {
+        auto& target = state.chunks[c];
+        if (target.layout_structure == target.structure) {
+            return target.layout;
+        }
+
+        auto& result = target.layout;
+        result.ids.clear();
+        result.columns.clear();
+        result.rows.clear();
+        result.components.clear();
+        for (auto& column : columns_) {
+            column.clear();
+        }
+
+        const EntityID first = static_cast<EntityID>(c) << chunk_shift_;
+        const EntityID last = static_cast<EntityID>(c + 1) << chunk_shift_;
+        for (auto id = first; id < last; ++id) {
+            const auto* entity = state.system->get_entity(id);
+            if (!entity) {
+                continue;
+            }
+            const auto row = static_cast<std::uint32_t>(result.ids.size());
+            result.ids.push_back(id);
+            for (const auto& [type, component] : entity->get_components()) {
+                const auto it = component_index_.find(type);
+                if (it != component_index_.end()) {
+                    columns_[it->second].emplace_back(row, component.get());
+                }
+            }
+        }
+
+        for (std::uint32_t i = 0; i < columns_.size(); ++i) {
+            if (columns_[i].empty()) {
+                continue;
+            }
+            // Rows were appended in ID order, so each column is already sorted
+            result.columns.push_back({i, static_cast<std::uint32_t>(columns_[i].size()), 0, 0});
+            for (const auto& [row, component] : columns_[i]) {
+                result.rows.push_back(row);
+                result.components.push_back(component);
+            }
+        }
+
+        target.layout_structure = target.structure;
+        return result;
+    }
+
+    /**
+     * @brief Appends [header][ids][columns][rows][records][blob] for chunk `c`
+     *
+     * Columns not written since `previous` was taken are copied from it.
+     */
+    void write_image(SystemState& state, const std::uint32_t c, const char* previous, std::vector<char>& out) {
+        const auto& target = state.chunks[c];
+        const auto& chunk_layout = layout(state, c);
+        const auto& components = schema_.get_components();
+
+        ImageView reuse{};
+        if (previous) {
+            reuse = view(previous);
+            if (reuse.header.structure != target.structure) {
+                previous = nullptr;
+            }
+        }
+
+        const ImageHeader header{target.structure, target.written, static_cast<std::uint32_t>(chunk_layout.ids.size()),
+                                 static_cast<std::uint32_t>(chunk_layout.columns.size())};
+        append(out, &header, sizeof(header));
+        append(out, chunk_layout.ids.data(), chunk_layout.ids.size() * sizeof(EntityID));
+        const auto columns_at = out.size();
+        append(out, chunk_layout.columns.data(), chunk_layout.columns.size() * sizeof(ImageColumn));
+        append(out, chunk_layout.rows.data(), chunk_layout.rows.size() * sizeof(std::uint32_t));
+
+        blob_.clear();
+        SnapshotWriter blob(blob_);
+        const char* reuse_records = previous ? reuse.records : nullptr;
+        std::size_t k = 0;
+        for (std::uint32_t i = 0; i < chunk_layout.columns.size(); ++i) {
+            auto column = chunk_layout.columns[i];
+            const auto& schema = *components[column.component];
+            const auto bytes = column.count * schema.get_record_size();
+            const auto records_at = out.size();
+            out.resize(records_at + bytes);
+
+            column.blob_offset = static_cast<std::uint32_t>(blob_.size());
+            if (previous && !(target.written & bit_of(column.component))) {
+                const auto old = reuse.column(i);
+                std::memcpy(out.data() + records_at, reuse_records, bytes);
+                blob_.insert(blob_.end(), reuse.blob + old.blob_offset, reuse.blob + old.blob_offset + old.blob_size);
+            } else {
+                schema.save_column(chunk_layout.components.data() + k, column.count, out.data() + records_at, blob);
+            }
+            column.blob_size = static_cast<std::uint32_t>(blob_.size() - column.blob_offset);
+            std::memcpy(out.data() + columns_at + i * sizeof(ImageColumn), &column, sizeof(column));
+
+            if (reuse_records) {
+                reuse_records += bytes;
+            }
+            k += column.count;
+        }
+        append(out, blob_.data(), blob_.size());
+    }
+
+    bool restore_chunk(SystemState& state, const std::uint32_t c, const char* image) {
+        auto& target = state.chunks[c];
+        const auto& components = schema_.get_components();
+
+        // Same entities and component types as when the image was taken: overwrite the written columns in place
+        if (image) {
+            const auto image_view = view(image);
+            if (image_view.header.structure == target.structure) {
+                const auto& chunk_layout = layout(state, c);
+                const char* records = image_view.records;
+                bool ok = true;
+                std::size_t k = 0;
+                for (std::uint32_t i = 0; i < chunk_layout.columns.size(); ++i) {
+                    const auto column = image_view.column(i);
+                    const auto& schema = *components[column.component];
+                    if (target.written & bit_of(column.component)) {
+                        SnapshotReader blob(image_view.blob + column.blob_offset, column.blob_size);
+                        auto* const* instances = chunk_layout.components.data() + k;
+                        ok = schema.assign_column(instances, column.count, records, blob) && ok;
+                        for (std::uint32_t j = 0; j < column.count; ++j) {
+                            if (auto* observer = instances[j]->owner->get_observer()) {
+                                observer->on_component_written(*instances[j]->owner, schema.get_type());
+                            }
+                        }
+                    }
+                    records += column.count * schema.get_record_size();
+                    k += column.count;
+                }
+                return ok;
+            }
+        }
+
+        // Entities or components were added or removed since: rebuild the chunk
+        const EntityID first = static_cast<EntityID>(c) << chunk_shift_;
+        const EntityID last = static_cast<EntityID>(c + 1) << chunk_shift_;
+        for (auto id = first; id < last; ++id) {
+            state.system->remove_entity(id);
+        }
+
+        target.layout_structure = NO_IMAGE;
+        if (!image) {
+            target.structure = ++structure_counter_;
+            return true;
+        }
+
+        const auto image_view = view(image);
+        target.structure = image_view.header.structure;
+
+        entities_.resize(image_view.header.entity_count);
+        for (std::uint32_t i = 0; i < image_view.header.entity_count; ++i) {
+            EntityID id;
+            std::memcpy(&id, image_view.ids + i * sizeof(id), sizeof(id));
+            entities_[i] = state.system->add_entity(id);
+        }
+
+        const char* row_at = image_view.rows;
+        const char* records = image_view.records;
+        bool ok = true;
+        for (std::uint32_t i = 0; i < image_view.header.column_count; ++i) {
+            const auto column = image_view.column(i);
+            const auto& schema = *components[column.component];
+            SnapshotReader blob(image_view.blob + column.blob_offset, column.blob_size);
+            for (std::uint32_t j = 0; j < column.count; ++j, row_at += sizeof(std::uint32_t)) {
+                std::uint32_t row;
+                std::memcpy(&row, row_at, sizeof(row));
+                ok = entities_[row] && schema.load(*entities_[row], records, blob) && ok;
+                records += schema.get_record_size();
+            }
+        }
+        return ok;
+    }
+
+    static void append(std::vector<char>& out, const void* data, const std::size_t size) {
+        if (size > 0) {
+            const auto at = out.size();
+            out.resize(at + size);
+            std::memcpy(out.data() + at, data, size);
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_ROLLBACK_HPP
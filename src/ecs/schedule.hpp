@@ -0,0 +1,44 @@
+#ifndef GAME_ECS_SCHEDULE_HPP
+#define GAME_ECS_SCHEDULE_HPP
+
+#include <cstdint>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Describes how often a system should be ticked by the world
+ *
+ * By default a system runs every tick. A system can instead run every
+ * `interval_ticks` ticks, or whenever `interval_seconds` of simulation time
+ * has accumulated (a non-zero `interval_seconds` takes precedence). The delta
+ * passed to the system is always the total time elapsed since it last ran.
+ *
+ * When `slices` is greater than one, the system's entity set is split into
+ * that many slices (by entity ID) and only one slice is processed per run,
+ * round-robin, so each entity is updated every `slices` runs with the
+ * delta accumulated for its slice.
+ *
+ * When `stagger` is set, the world spreads systems that share the same
+ * interval evenly across ticks so they don't all run on the same frame.
+ */
+struct UpdateSchedule {
+    std::uint32_t interval_ticks{1};
+    float interval_seconds{0.0f};
+    std::uint32_t slices{1};
+    bool stagger{true};
+
+    bool uses_seconds() const noexcept { return interval_seconds > 0.0f; }
+
+    bool same_interval(const UpdateSchedule& other) const noexcept {
+        if (uses_seconds() || other.uses_seconds()) {
+            return interval_seconds == other.interval_seconds;
+        }
+        return interval_ticks == other.interval_ticks;
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_SCHEDULE_HPP
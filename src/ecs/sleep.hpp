@@ -0,0 +1,178 @@
+#ifndef GAME_ECS_SLEEP_HPP
+#define GAME_ECS_SLEEP_HPP
+
+#include "entity.hpp"
+#include <cstdint>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Splits a system's entities into awake and sleeping sets
+ *
+ * Awake entities live in a dense list that systems iterate with
+ * update_awake(); an entity is put to sleep when the update callback
+ * reports it has nothing left to do, and costs nothing until it is woken.
+ * Attached to a system as an EntityObserver, the set tracks entity creation
+ * and removal and wakes an entity whenever one of its components is added,
+ * removed or written. Other wake-up sources (proximity, events) call wake().
+ */
+class SleepSet : public EntityObserver {
+    struct Slot {
+        bool sleeping;
+        std::uint32_t index;
+    };
+
+    std::vector<EntityID> awake_;
+    std::vector<EntityID> sleeping_;
+    std::unordered_map<EntityID, Slot> slots_;
+
+public:
+    const std::vector<EntityID>& get_awake() const noexcept { return awake_; }
+    const std::vector<EntityID>& get_sleeping() const noexcept { return sleeping_; }
+    std::size_t size() const noexcept { return slots_.size(); }
+
+    bool contains(const EntityID id) const noexcept {
+        return slots_.find(id) != slots_.end();
+    }
+
+    bool is_sleeping(const EntityID id) const noexcept {
+        const auto it = slots_.find(id);
+        return it != slots_.end() && it->second.sleeping;
+    }
+
+    /**
+     * @brief Starts tracking an entity as awake
+     */
+    void track(const EntityID id) {
+        if (contains(id)) {
+            return;
+        }
+        slots_.emplace(id, Slot{false, static_cast<std::uint32_t>(awake_.size())});
+        awake_.push_back(id);
+    }
+
+    bool untrack(const EntityID id) noexcept {
+        const auto it = slots_.find(id);
+        if (it == slots_.end()) {
+            return false;
+        }
+
+        unlink(it->second);
+        slots_.erase(it);
+        return true;
+    }
+
+    void clear() noexcept {
+        awake_.clear();
+        sleeping_.clear();
+        slots_.clear();
+    }
+
+    bool wake(const EntityID id) {
+        const auto it = slots_.find(id);
+        if (it == slots_.end() || !it->second.sleeping) {
+            return false;
+        }
+
+        unlink(it->second);
+        it->second = Slot{false, static_cast<std::uint32_t>(awake_.size())};
+        awake_.push_back(id);
+        return true;
+    }
+
+    /**
+     * @brief Puts an entity to sleep; use the update_awake() return value while iterating instead
+     */
+    bool sleep(const EntityID id) {
+        const auto it = slots_.find(id);
+        if (it == slots_.end() || it->second.sleeping) {
+            return false;
+        }
+
+        unlink(it->second);
+        it->second = Slot{true, static_cast<std::uint32_t>(sleeping_.size())};
+        sleeping_.push_back(id);
+        return true;
+    }
+
+    /**
+     * @brief Wakes every sleeping entity matching `pred(id)`, e.g. those near an explosion
+     */
+    template<typename Pred>
+    std::size_t wake_if(Pred&& pred) {
+        std::vector<EntityID> woken;
+        for (const auto id : sleeping_) {
+            if (pred(id)) {
+                woken.push_back(id);
+            }
+        }
+        for (const auto id : woken) {
+            wake(id);
+        }
+        return woken.size();
+    }
+
+    /**
+     * @brief Visits the awake entities; `fn(id)` returns false to put the entity to sleep
+     *
+     * Entities woken from inside `fn` are appended and visited in the same pass.
+     */
+    template<typename Fn>
+    void update_awake(Fn&& fn) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < awake_.size(); ++i) {
+            const auto id = awake_[i];
+            if (fn(id)) {
+                awake_[kept] = id;
+                slots_.find(id)->second.index = static_cast<std::uint32_t>(kept);
+                ++kept;
+            } else {
+                auto& slot = slots_.find(id)->second;
+                slot = Slot{true, static_cast<std::uint32_t>(sleeping_.size())};
+                sleeping_.push_back(id);
+            }
+        }
+        awake_.resize(kept);
+    }
+
+    void on_entity_added(Entity& entity) noexcept override {
+        track(entity.get_id());
+    }
+
+    void on_entity_removed(Entity& entity) noexcept override {
+        untrack(entity.get_id());
+    }
+
+    void on_component_added(Entity& entity, const std::type_index&) noexcept override {
+        wake(entity.get_id());
+    }
+
+    void on_component_removed(Entity& entity, const std::type_index&) noexcept override {
+        wake(entity.get_id());
+    }
+
+    void on_component_written(Entity& entity, const std::type_index&) noexcept override {
+        wake(entity.get_id());
+    }
+
+private:
+    void unlink(const Slot& slot) noexcept {
+        auto& list = slot.sleeping ? sleeping_ : awake_;
+        const auto moved = list.back();
+        list[slot.index] = moved;
+        list.pop_back();
+
+        if (slot.index < list.size()) {
+            slots_.find(moved)->second.index = slot.index;
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_SLEEP_HPP
@@ -0,0 +1,1197 @@
+#ifndef GAME_ECS_SNAPSHOT_HPP
+#define GAME_ECS_SNAPSHOT_HPP
+
+#include "component_meta.hpp"
+#include "entity.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GAME_ECS_SNAPSHOT_MMAP 1
+#endif
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief FNV-1a hash used for names and schemas stored in snapshots
+ */
+constexpr std::uint64_t hash_name(const std::string_view name, std::uint64_t hash = 14695981039346656037ull) noexcept {
+    for (const char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+constexpr std::uint64_t hash_combine(std::uint64_t hash, const std::uint64_t value) noexcept {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+enum class SnapshotStatus {
+    Ok,
+    OpenFailed,
+    WriteFailed,
+    BadHeader,
+    VersionMismatch,
+    UnknownSystem,
+    SchemaMismatch,
+    Truncated,
+    Corrupt
+};
+
+/**
+ * @brief Appends variable-length data for custom component serializers
+ */
+class SnapshotWriter {
+    std::vector<char>& out_;
+
+public:
+    explicit SnapshotWriter(std::vector<char>& out) noexcept : out_(out) {}
+
+    void write_bytes(const void* data, const std::size_t size) {
+        const auto* bytes = static_cast<const char*>(data);
+        out_.insert(out_.end(), bytes, bytes + size);
+    }
+
+    template<typename V>
+    void write(const V& value) {
+        static_assert(std::is_trivially_copyable_v<V>, "V must be trivially copyable");
+        write_bytes(&value, sizeof(V));
+    }
+
+    void write_string(const std::string_view value) {
+        write(static_cast<std::uint32_t>(value.size()));
+        write_bytes(value.data(), value.size());
+    }
+};
+
+/**
+ * @brief Reads back data written by a SnapshotWriter; every read fails once the data runs out
+ */
+class SnapshotReader {
+    const char* data_;
+    std::size_t size_;
+    std::size_t offset_{0};
+
+public:
+    SnapshotReader(const char* data, const std::size_t size) noexcept : data_(data), size_(size) {}
+
+    std::size_t get_offset() const noexcept { return offset_; }
+
+    bool read_bytes(void* out, const std::size_t size) noexcept {
+        if (size > size_ - offset_) {
+            offset_ = size_;
+            return false;
+        }
+        std::memcpy(out, data_ + offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    template<typename V>
+    bool read(V& value) noexcept {
+        static_assert(std::is_trivially_copyable_v<V>, "V must be trivially copyable");
+        return read_bytes(&value, sizeof(V));
+    }
+
+    bool read_string(std::string& value) {
+        std::uint32_t size = 0;
+        if (!read(size) || size > size_ - offset_) {
+            return false;
+        }
+        value.assign(data_ + offset_, size);
+        offset_ += size;
+        return true;
+    }
+};
+
+/**
+ * @brief Describes how one component type is stored in a snapshot
+ *
+ * Fields registered with field() are trivially copyable members that are
+ * packed into a fixed-size record and copied with memcpy. Anything else
+ * (strings, containers) goes through custom() serializers that append to the
+ * column's variable-length blob. The schema hash covers the component name
+ * and each field's name, size, alignment and kind, so a snapshot written by
+ * a build with a different layout is rejected before anything is loaded.
+ */
+class ComponentSchema {
+protected:
+    std::string name_;
+    std::uint64_t name_hash_;
+    std::uint64_t schema_hash_;
+    std::size_t record_size_{0};
+    std::type_index type_;
+
+    ComponentSchema(const std::string_view name, const std::type_index type)
+        : name_(name)
+        , name_hash_(hash_name(name))
+        , schema_hash_(hash_name(name))
+        , type_(type) {}
+
+public:
+    virtual ~ComponentSchema() = default;
+
+    const std::string& get_name() const noexcept { return name_; }
+    std::uint64_t get_name_hash() const noexcept { return name_hash_; }
+    std::uint64_t get_schema_hash() const noexcept { return schema_hash_; }
+    std::size_t get_record_size() const noexcept { return record_size_; }
+    const std::type_index& get_type() const noexcept { return type_; }
+
+    virtual void save(const Component& component, char* record, SnapshotWriter& blob) const = 0;
+    virtual bool load(Entity& entity, const char* record, SnapshotReader& blob) const = 0;
+
+    /**
+     * @brief Overwrites an existing component in place with a saved record
+     */
+    virtual bool assign(Component& component, const char* record, SnapshotReader& blob) const = 0;
+
+    /**
+     * @brief Removes this component type from `entity`; false if it had none
+     */
+    virtual bool remove(Entity& entity) const = 0;
+
+    /**
+     * @brief save() for `count` components of this type into consecutive records
+     */
+    virtual void save_column(const Component* const* components, std::size_t count, char* records,
+                             SnapshotWriter& blob) const = 0;
+
+    /**
+     * @brief assign() for `count` components of this type from consecutive records
+     */
+    virtual bool assign_column(Component* const* components, std::size_t count, const char* records,
+                               SnapshotReader& blob) const = 0;
+};
+
+template<typename T>
+class ComponentSchemaOf : public ComponentSchema {
+    struct Field {
+        std::size_t record_offset;
+        std::size_t object_offset;
+        std::size_t size;
+    };
+
+    struct Custom {
+        std::function<void(const T&, SnapshotWriter&)> save;
+        std::function<bool(T&, SnapshotReader&)> load;
+    };
+
+    std::vector<Field> fields_;
+    std::vector<Custom> custom_;
+    std::function<bool(const T&)> validate_;
+    std::size_t packed_size_{0};
+    std::size_t record_align_{1};
+
+public:
+    explicit ComponentSchemaOf(const std::string_view name)
+        : ComponentSchema(name, std::type_index(typeid(T))) {
+        static_assert(std::is_base_of_v<Component, T>, "T must inherit Component");
+        static_assert(std::is_default_constructible_v<T>, "T must be default constructible to be loaded");
+    }
+
+    /**
+     * @brief Stores a trivially copyable member in the component's fixed-size record
+     */
+    template<typename F>
+    ComponentSchemaOf& field(const std::string_view name, F T::*member) {
+        static_assert(std::is_trivially_copyable_v<F>, "Use custom() for members that are not trivially copyable");
+
+        const T sample{};
+        const auto object_offset = static_cast<std::size_t>(
+            reinterpret_cast<const char*>(&(sample.*member)) - reinterpret_cast<const char*>(&sample));
+        const auto record_offset = (packed_size_ + alignof(F) - 1) / alignof(F) * alignof(F);
+
+        // Members adjacent in both the object and the record are copied with one memcpy
+        auto* last = fields_.empty() ? nullptr : &fields_.back();
+        if (last && last->record_offset + last->size == record_offset &&
+            last->object_offset + last->size == object_offset) {
+            last->size += sizeof(F);
+        } else {
+            fields_.push_back({record_offset, object_offset, sizeof(F)});
+        }
+        packed_size_ = record_offset + sizeof(F);
+        record_align_ = std::max(record_align_, alignof(F));
+        record_size_ = (packed_size_ + record_align_ - 1) / record_align_ * record_align_;
+
+        schema_hash_ = hash_combine(hash_name(name, schema_hash_), (sizeof(F) << 16) | (alignof(F) << 8) | kind_of<F>());
+        return *this;
+    }
+
+    /**
+     * @brief Stores data with user serializers; bump `version` whenever their format changes
+     */
+    ComponentSchemaOf& custom(const std::string_view name, const std::uint32_t version,
+                              std::function<void(const T&, SnapshotWriter&)> save,
+                              std::function<bool(T&, SnapshotReader&)> load) {
+        custom_.push_back({std::move(save), std::move(load)});
+        schema_hash_ = hash_combine(hash_name(name, schema_hash_), 0xC0570000ull | version);
+        return *this;
+    }
+
+    /**
+     * @brief Rejects loaded values that would break invariants, e.g. out-of-range enums or indices
+     */
+    ComponentSchemaOf& validate(std::function<bool(const T&)> validate) {
+        validate_ = std::move(validate);
+        return *this;
+    }
+
+    void save(const Component& component, char* record, SnapshotWriter& blob) const override {
+        const auto& value = static_cast<const T&>(component);
+        const auto* object = reinterpret_cast<const char*>(&value);
+        for (const auto& field : fields_) {
+            std::memcpy(record + field.record_offset, object + field.object_offset, field.size);
+        }
+        for (const auto& custom : custom_) {
+            custom.save(value, blob);
+        }
+    }
+
+    bool load(Entity& entity, const char* record, SnapshotReader& blob) const override {
+        T value{};
+        auto* object = reinterpret_cast<char*>(&value);
+        for (const auto& field : fields_) {
+            std::memcpy(object + field.object_offset, record + field.record_offset, field.size);
+        }
+        for (const auto& custom : custom_) {
+            if (!custom.load(value, blob)) {
+                return false;
+            }
+        }
+        if (validate_ && !validate_(value)) {
+            return false;
+        }
+
+        // Components are added fully populated so system hooks see the restored state
+        return entity.add_component<T>(std::move(value)) != nullptr;
+    }
+
+    bool assign(Component& component, const char* record, SnapshotReader& blob) const override {
+        auto& value = static_cast<T&>(component);
+        auto* object = reinterpret_cast<char*>(&value);
+        for (const auto& field : fields_) {
+            std::memcpy(object + field.object_offset, record + field.record_offset, field.size);
+        }
+        for (const auto& custom : custom_) {
+            if (!custom.load(value, blob)) {
+                return false;
+            }
+        }
+        return !validate_ || validate_(value);
+    }
+
+    bool remove(Entity& entity) const override {
+        return entity.remove_component<T>();
+    }
+
+    void save_column(const Component* const* components, const std::size_t count, char* records,
+                     SnapshotWriter& blob) const override {
+        for (std::size_t i = 0; i < count; ++i, records += record_size_) {
+            ComponentSchemaOf::save(*components[i], records, blob);
+        }
+    }
+
+    bool assign_column(Component* const* components, const std::size_t count, const char* records,
+                       SnapshotReader& blob) const override {
+        bool ok = true;
+        for (std::size_t i = 0; i < count; ++i, records += record_size_) {
+            ok = ComponentSchemaOf::assign(*components[i], records, blob) && ok;
+        }
+        return ok;
+    }
+
+private:
+    template<typename F>
+    static constexpr std::uint64_t kind_of() noexcept {
+        if constexpr (std::is_same_v<F, bool>) {
+            return 1;
+        } else if constexpr (std::is_enum_v<F>) {
+            return 2;
+        } else if constexpr (std::is_floating_point_v<F>) {
+            return 3;
+        } else if constexpr (std::is_integral_v<F>) {
+            return std::is_signed_v<F> ? 4 : 5;
+        } else {
+            return 6;
+        }
+    }
+};
+
+/**
+ * @brief Registry of the systems and component types a snapshot contains
+ *
+ * Systems and components are identified in the file by the hash of the
+ * name they are registered under, so names must be stable across builds.
+ * Components an entity has but that are not registered are not saved.
+ */
+class SnapshotSchema {
+public:
+    struct SystemEntry {
+        std::string name;
+        std::uint64_t name_hash;
+        System* (*get)(World&);
+    };
+
+private:
+    std::vector<SystemEntry> systems_;
+    std::vector<std::unique_ptr<ComponentSchema>> components_;
+
+public:
+    template<typename T>
+    bool add_system(const std::string_view name) {
+        static_assert(std::is_base_of_v<System, T>, "T must inherit System");
+        if (find_system(hash_name(name))) {
+            return false;
+        }
+
+        systems_.push_back({std::string(name), hash_name(name), [](World& world) -> System* {
+            return world.get_system<T>();
+        }});
+        return true;
+    }
+
+    template<typename T>
+    ComponentSchemaOf<T>& add_component(const std::string_view name) {
+        auto schema = std::make_unique<ComponentSchemaOf<T>>(name);
+        auto& result = *schema;
+        components_.push_back(std::move(schema));
+        return result;
+    }
+
+    /**
+     * @brief Registers T under its ComponentMeta name with every declared field
+     */
+    template<ReflectedComponent T>
+    ComponentSchemaOf<T>& add_component() {
+        auto& result = add_component<T>(ComponentMeta<T>::name);
+        for_each_field_meta<T>([&result](const std::string_view name, auto member) {
+            result.field(name, member);
+        });
+        return result;
+    }
+
+    const std::vector<SystemEntry>& get_systems() const noexcept { return systems_; }
+    const std::vector<std::unique_ptr<ComponentSchema>>& get_components() const noexcept { return components_; }
+
+    const SystemEntry* find_system(const std::uint64_t name_hash) const noexcept {
+        for (const auto& system : systems_) {
+            if (system.name_hash == name_hash) {
+                return &system;
+            }
+        }
+        return nullptr;
+    }
+
+    const ComponentSchema* find_component(const std::uint64_t name_hash) const noexcept {
+        for (const auto& component : components_) {
+            if (component->get_name_hash() == name_hash) {
+                return component.get();
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Read-only view of a file, memory-mapped where the platform allows it
+ */
+class MappedFile {
+    const char* data_{nullptr};
+    std::size_t size_{0};
+#ifdef GAME_ECS_SNAPSHOT_MMAP
+    void* mapping_{nullptr};
+#else
+    std::vector<char> buffer_;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef GAME_ECS_SNAPSHOT_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat info {};
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                ::madvise(mapping, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+                mapping_ = mapping;
+                data_ = static_cast<const char*>(mapping);
+                size_ = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+#else
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return;
+        }
+
+        char chunk[65536];
+        std::size_t read = 0;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            buffer_.insert(buffer_.end(), chunk, chunk + read);
+        }
+        std::fclose(file);
+
+        if (!buffer_.empty()) {
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifdef GAME_ECS_SNAPSHOT_MMAP
+        if (mapping_) {
+            ::munmap(mapping_, size_);
+        }
+#endif
+    }
+
+    const char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+};
+
+/**
+ * @brief Binary world snapshots
+ *
+ * Layout (native endianness, every section 8-byte aligned):
+ *
+ *     FileHeader
+ *     per system:   SystemHeader, EntityID[entity_count], EntityID[removed_count]
+ *       per column: ColumnHeader, uint32 row[count], records,
+ *                   uint64 blob_offset[count] (only if blob_size > 0), blob
+ *
+ * A column holds every instance of one component type in a system: `row`
+ * indexes the system's entity list, records are the packed fields of each
+ * instance back to back, and the blob holds custom-serialized data in the
+ * same order, starting at each instance's blob offset. Entities are written
+ * in ID order so identical worlds produce identical bytes.
+ *
+ * A Full snapshot replaces every entity of the systems it contains. A Delta
+ * snapshot only lists the entities that changed: removed IDs are destroyed,
+ * and every listed entity is recreated with exactly the components written.
+ */
+class Snapshot {
+public:
+    static constexpr std::uint32_t VERSION = 2;
+
+    enum class Kind : std::uint32_t { Full = 0, Delta = 1 };
+
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t system_count;
+        std::uint64_t tick_count;
+        std::uint64_t size;
+        Kind kind;
+        std::uint32_t reserved;
+        std::uint64_t sequence;
+    };
+
+    struct SystemHeader {
+        std::uint64_t name_hash;
+        std::uint64_t next_entity_id;
+        std::uint64_t entity_count;
+        std::uint64_t removed_count;
+        std::uint32_t column_count;
+        std::uint32_t reserved;
+    };
+
+    struct ColumnHeader {
+        std::uint64_t name_hash;
+        std::uint64_t schema_hash;
+        std::uint64_t count;
+        std::uint64_t record_size;
+        std::uint64_t blob_size;
+    };
+
+    /**
+     * @brief The entities of one system to write, sorted by ID
+     */
+    struct Selection {
+        const SnapshotSchema::SystemEntry* entry;
+        const System* system;
+        std::vector<const Entity*> entities;
+        std::vector<EntityID> removed;
+    };
+
+    /**
+     * @brief Serializes every registered system of `world` into `out`
+     */
+    static void encode(World& world, const SnapshotSchema& schema, std::vector<char>& out, std::uint64_t sequence = 0) {
+        std::vector<Selection> selections;
+        for (const auto& entry : schema.get_systems()) {
+            const auto* system = entry.get(world);
+            if (!system) {
+                continue;
+            }
+
+            Selection selection{&entry, system, {}, {}};
+            selection.entities.reserve(system->get_entities().size());
+            for (const auto& [_, entity] : system->get_entities()) {
+                selection.entities.push_back(entity.get());
+            }
+            std::sort(selection.entities.begin(), selection.entities.end(),
+                      [](const Entity* lhs, const Entity* rhs) { return lhs->get_id() < rhs->get_id(); });
+            selections.push_back(std::move(selection));
+        }
+
+        encode(schema, Kind::Full, sequence, world.get_tick_count(), selections, out);
+    }
+
+    /**
+     * @brief Serializes the selected entities of each system into `out`
+     */
+    static void encode(const SnapshotSchema& schema, const Kind kind, const std::uint64_t sequence,
+                       const std::uint64_t tick_count, const std::vector<Selection>& selections,
+                       std::vector<char>& out) {
+        const auto& components = schema.get_components();
+        std::unordered_map<std::type_index, std::size_t> column_of;
+        for (std::size_t i = 0; i < components.size(); ++i) {
+            column_of.emplace(components[i]->get_type(), i);
+        }
+
+        std::vector<Column> columns(components.size());
+        std::vector<EntityID> ids;
+        std::vector<char> blob;
+
+        out.clear();
+        out.resize(sizeof(FileHeader));
+
+        for (const auto& selection : selections) {
+            // One pass over each entity's components fills every column
+            for (auto& column : columns) {
+                column.rows.clear();
+                column.instances.clear();
+            }
+            ids.resize(selection.entities.size());
+            for (std::size_t row = 0; row < selection.entities.size(); ++row) {
+                ids[row] = selection.entities[row]->get_id();
+                for (const auto& [type, component] : selection.entities[row]->get_components()) {
+                    const auto it = column_of.find(type);
+                    if (it != column_of.end()) {
+                        columns[it->second].rows.push_back(static_cast<std::uint32_t>(row));
+                        columns[it->second].instances.push_back(component.get());
+                    }
+                }
+            }
+
+            const auto system_at = reserve(out, sizeof(SystemHeader));
+            append(out, ids.data(), ids.size() * sizeof(EntityID));
+            append(out, selection.removed.data(), selection.removed.size() * sizeof(EntityID));
+
+            std::uint32_t column_count = 0;
+            for (std::size_t i = 0; i < components.size(); ++i) {
+                if (columns[i].instances.empty()) {
+                    continue;
+                }
+                ++column_count;
+                write_column(out, *components[i], columns[i], blob);
+            }
+
+            const SystemHeader header{selection.entry->name_hash, selection.system->get_next_entity_id(),
+                                      ids.size(), selection.removed.size(), column_count, 0};
+            std::memcpy(out.data() + system_at, &header, sizeof(header));
+        }
+
+        FileHeader header{};
+        std::memcpy(header.magic, "ECSSNAP", 8);
+        header.version = VERSION;
+        header.system_count = static_cast<std::uint32_t>(selections.size());
+        header.tick_count = tick_count;
+        header.size = out.size();
+        header.kind = kind;
+        header.sequence = sequence;
+        std::memcpy(out.data(), &header, sizeof(header));
+    }
+
+    /**
+     * @brief Applies a Full or Delta snapshot to `world`
+     *
+     * All headers and schema hashes are validated before the world is
+     * touched, so a snapshot from a mismatched build leaves the world as it
+     * was. Damaged component data is only detected while loading and returns
+     * Corrupt with the affected systems partially restored. Systems
+     * registered in `schema` but absent from the snapshot are left alone.
+     */
+    static SnapshotStatus decode(World& world, const SnapshotSchema& schema, const char* data, const std::size_t size) {
+        const auto status = validate(schema, data, size);
+        if (status != SnapshotStatus::Ok) {
+            return status;
+        }
+
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        std::size_t offset = sizeof(FileHeader);
+        std::vector<Entity*> entities;
+
+        for (std::uint32_t s = 0; s < header.system_count; ++s) {
+            SystemHeader system_header;
+            std::memcpy(&system_header, data + offset, sizeof(system_header));
+            offset += sizeof(SystemHeader);
+
+            auto* system = schema.find_system(system_header.name_hash)->get(world);
+            const char* ids = data + offset;
+            offset += padded(system_header.entity_count * sizeof(EntityID));
+            const char* removed = data + offset;
+            offset += padded(system_header.removed_count * sizeof(EntityID));
+
+            if (header.kind == Kind::Full) {
+                system->clear_entities();
+                system->get_entities().reserve(system_header.entity_count);
+            } else {
+                for (std::uint64_t i = 0; i < system_header.removed_count; ++i) {
+                    system->remove_entity(read_id(removed, i));
+                }
+            }
+
+            entities.resize(system_header.entity_count);
+            for (std::uint64_t i = 0; i < system_header.entity_count; ++i) {
+                const auto id = read_id(ids, i);
+                if (header.kind == Kind::Delta) {
+                    system->remove_entity(id);
+                }
+                entities[i] = system->add_entity(id);
+            }
+
+            for (std::uint32_t c = 0; c < system_header.column_count; ++c) {
+                ColumnHeader column;
+                std::memcpy(&column, data + offset, sizeof(column));
+                offset += sizeof(ColumnHeader);
+
+                const auto* component = schema.find_component(column.name_hash);
+                const char* rows = data + offset;
+                offset += padded(column.count * sizeof(std::uint32_t));
+                const char* records = data + offset;
+                offset += padded(column.count * column.record_size);
+                if (column.blob_size > 0) {
+                    offset += padded(column.count * sizeof(std::uint64_t));
+                }
+                SnapshotReader blob(data + offset, column.blob_size);
+                offset += padded(column.blob_size);
+
+                for (std::uint64_t i = 0; i < column.count; ++i) {
+                    std::uint32_t row;
+                    std::memcpy(&row, rows + i * sizeof(row), sizeof(row));
+                    if (row >= entities.size() || !entities[row] ||
+                        !component->load(*entities[row], records + i * column.record_size, blob)) {
+                        return SnapshotStatus::Corrupt;
+                    }
+                }
+            }
+
+            system->set_next_entity_id(system_header.next_entity_id);
+        }
+
+        world.set_tick_count(header.tick_count);
+        return SnapshotStatus::Ok;
+    }
+
+    /**
+     * @brief Reads and checks the file header without decoding anything else
+     */
+    static SnapshotStatus read_header(const char* data, const std::size_t size, FileHeader& header) noexcept {
+        if (size < sizeof(header)) {
+            return SnapshotStatus::BadHeader;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "ECSSNAP", 8) != 0) {
+            return SnapshotStatus::BadHeader;
+        }
+        if (header.version != VERSION) {
+            return SnapshotStatus::VersionMismatch;
+        }
+        if (header.kind != Kind::Full && header.kind != Kind::Delta) {
+            return SnapshotStatus::BadHeader;
+        }
+        if (header.size != size) {
+            return SnapshotStatus::Truncated;
+        }
+        return SnapshotStatus::Ok;
+    }
+
+    /**
+     * @brief Checks headers, section sizes, schema hashes, rows and blob offsets of a whole snapshot
+     *
+     * Every row must index its system's entity list and every blob offset
+     * must lie within its column's blob, in order, so parse() and compact()
+     * can follow them without further checks.
+     */
+    static SnapshotStatus validate(const SnapshotSchema& schema, const char* data, const std::size_t size) {
+        FileHeader header;
+        const auto status = read_header(data, size, header);
+        if (status != SnapshotStatus::Ok) {
+            return status;
+        }
+
+        std::size_t offset = sizeof(FileHeader);
+        auto take = [&](const std::uint64_t bytes) {
+            if (bytes > size || padded(bytes) > size - offset) {
+                return false;
+            }
+            offset += padded(bytes);
+            return true;
+        };
+
+        for (std::uint32_t s = 0; s < header.system_count; ++s) {
+            SystemHeader system_header;
+            if (sizeof(system_header) > size - offset) {
+                return SnapshotStatus::Truncated;
+            }
+            std::memcpy(&system_header, data + offset, sizeof(system_header));
+            offset += sizeof(SystemHeader);
+
+            if (!schema.find_system(system_header.name_hash)) {
+                return SnapshotStatus::UnknownSystem;
+            }
+            if (system_header.entity_count > size / sizeof(EntityID) ||
+                system_header.removed_count > size / sizeof(EntityID) ||
+                !take(system_header.entity_count * sizeof(EntityID)) ||
+                !take(system_header.removed_count * sizeof(EntityID))) {
+                return SnapshotStatus::Truncated;
+            }
+
+            for (std::uint32_t c = 0; c < system_header.column_count; ++c) {
+                ColumnHeader column;
+                if (sizeof(column) > size - offset) {
+                    return SnapshotStatus::Truncated;
+                }
+                std::memcpy(&column, data + offset, sizeof(column));
+                offset += sizeof(ColumnHeader);
+
+                const auto* component = schema.find_component(column.name_hash);
+                if (!component || component->get_schema_hash() != column.schema_hash ||
+                    component->get_record_size() != column.record_size) {
+                    return SnapshotStatus::SchemaMismatch;
+                }
+                if (column.count > system_header.entity_count) {
+                    return SnapshotStatus::Truncated;
+                }
+                const char* rows = data + offset;
+                if (!take(column.count * sizeof(std::uint32_t)) || !take(column.count * column.record_size)) {
+                    return SnapshotStatus::Truncated;
+                }
+                const char* blob_offsets = data + offset;
+                if ((column.blob_size > 0 && !take(column.count * sizeof(std::uint64_t))) ||
+                    !take(column.blob_size)) {
+                    return SnapshotStatus::Truncated;
+                }
+
+                for (std::uint64_t i = 0; i < column.count; ++i) {
+                    std::uint32_t row;
+                    std::memcpy(&row, rows + i * sizeof(row), sizeof(row));
+                    if (row >= system_header.entity_count) {
+                        return SnapshotStatus::Corrupt;
+                    }
+                }
+                if (column.blob_size > 0) {
+                    std::uint64_t previous = 0;
+                    for (std::uint64_t i = 0; i < column.count; ++i) {
+                        std::uint64_t begin;
+                        std::memcpy(&begin, blob_offsets + i * sizeof(begin), sizeof(begin));
+                        if (begin < previous || begin > column.blob_size) {
+                            return SnapshotStatus::Corrupt;
+                        }
+                        previous = begin;
+                    }
+                }
+            }
+        }
+
+        return SnapshotStatus::Ok;
+    }
+
+    struct ColumnView {
+        ColumnHeader header;
+        const char* rows;
+        const char* records;
+        const char* blob_offsets; // nullptr when the column has no blob
+        const char* blob;
+
+        std::uint32_t row(const std::uint64_t i) const noexcept {
+            std::uint32_t value;
+            std::memcpy(&value, rows + i * sizeof(value), sizeof(value));
+            return value;
+        }
+
+        std::pair<std::uint64_t, std::uint64_t> blob_range(const std::uint64_t i) const noexcept {
+            if (!blob_offsets) {
+                return {0, 0};
+            }
+            std::uint64_t begin;
+            std::uint64_t end = header.blob_size;
+            std::memcpy(&begin, blob_offsets + i * sizeof(begin), sizeof(begin));
+            if (i + 1 < header.count) {
+                std::memcpy(&end, blob_offsets + (i + 1) * sizeof(end), sizeof(end));
+            }
+            return {begin, end};
+        }
+    };
+
+    struct SystemView {
+        SystemHeader header;
+        const char* ids;
+        const char* removed;
+        std::vector<ColumnView> columns;
+
+        EntityID id(const std::uint64_t i) const noexcept { return read_id(ids, i); }
+        EntityID removed_id(const std::uint64_t i) const noexcept { return read_id(removed, i); }
+
+        const ColumnView* find_column(const std::uint64_t name_hash) const noexcept {
+            for (const auto& column : columns) {
+                if (column.header.name_hash == name_hash) {
+                    return &column;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    struct View {
+        FileHeader header;
+        std::vector<SystemView> systems;
+
+        const SystemView* find_system(const std::uint64_t name_hash) const noexcept {
+            for (const auto& system : systems) {
+                if (system.header.name_hash == name_hash) {
+                    return &system;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    /**
+     * @brief Indexes the sections of a snapshot that has already passed validate()
+     */
+    static View parse(const char* data) {
+        View view;
+        std::memcpy(&view.header, data, sizeof(view.header));
+        std::size_t offset = sizeof(FileHeader);
+
+        for (std::uint32_t s = 0; s < view.header.system_count; ++s) {
+            SystemView system;
+            std::memcpy(&system.header, data + offset, sizeof(system.header));
+            offset += sizeof(SystemHeader);
+            system.ids = data + offset;
+            offset += padded(system.header.entity_count * sizeof(EntityID));
+            system.removed = data + offset;
+            offset += padded(system.header.removed_count * sizeof(EntityID));
+
+            for (std::uint32_t c = 0; c < system.header.column_count; ++c) {
+                ColumnView column;
+                std::memcpy(&column.header, data + offset, sizeof(column.header));
+                offset += sizeof(ColumnHeader);
+                column.rows = data + offset;
+                offset += padded(column.header.count * sizeof(std::uint32_t));
+                column.records = data + offset;
+                offset += padded(column.header.count * column.header.record_size);
+                column.blob_offsets = nullptr;
+                if (column.header.blob_size > 0) {
+                    column.blob_offsets = data + offset;
+                    offset += padded(column.header.count * sizeof(std::uint64_t));
+                }
+                column.blob = data + offset;
+                offset += padded(column.header.blob_size);
+                system.columns.push_back(column);
+            }
+            view.systems.push_back(std::move(system));
+        }
+        return view;
+    }
+
+    /**
+     * @brief Folds a Full snapshot and the Delta snapshots that follow it into one Full snapshot
+     *
+     * Works on the encoded bytes alone: records and blob slices are copied
+     * without loading any components. The result is byte-identical to a Full
+     * snapshot of the world the inputs describe.
+     */
+    static SnapshotStatus compact(const SnapshotSchema& schema, const char* base, const std::size_t base_size,
+                                  const std::vector<std::pair<const char*, std::size_t>>& deltas,
+                                  std::vector<char>& out) {
+        std::vector<View> views;
+        views.reserve(deltas.size() + 1);
+        for (std::size_t i = 0; i <= deltas.size(); ++i) {
+            const char* data = i == 0 ? base : deltas[i - 1].first;
+            const std::size_t size = i == 0 ? base_size : deltas[i - 1].second;
+            const auto status = validate(schema, data, size);
+            if (status != SnapshotStatus::Ok) {
+                return status;
+            }
+            views.push_back(parse(data));
+            if (views.back().header.kind != (i == 0 ? Kind::Full : Kind::Delta)) {
+                return SnapshotStatus::BadHeader;
+            }
+        }
+
+        struct Source {
+            EntityID id;
+            std::uint32_t file;
+            std::uint32_t row;
+        };
+
+        struct Instance {
+            std::uint32_t row;
+            const ColumnView* column;
+            std::uint64_t index;
+        };
+
+        constexpr std::uint32_t REMOVED = 0xFFFFFFFFu;
+        std::unordered_map<EntityID, std::uint32_t> latest;
+        std::vector<Source> sources;
+        std::vector<std::vector<std::uint32_t>> new_rows(views.size());
+        std::vector<Instance> instances;
+        std::vector<EntityID> ids;
+        std::vector<std::uint32_t> rows;
+        std::vector<std::uint64_t> blob_offsets;
+        std::vector<char> blob;
+
+        out.clear();
+        out.resize(sizeof(FileHeader));
+        std::uint32_t system_count = 0;
+
+        for (const auto& entry : schema.get_systems()) {
+            std::vector<const SystemView*> per_file(views.size(), nullptr);
+            const SystemView* last = nullptr;
+            for (std::size_t i = 0; i < views.size(); ++i) {
+                per_file[i] = views[i].find_system(entry.name_hash);
+                last = per_file[i] ? per_file[i] : last;
+            }
+            if (!last) {
+                continue;
+            }
+            ++system_count;
+
+            // The newest file mentioning an entity decides whether and how it survives
+            latest.clear();
+            for (std::uint32_t i = 1; i < views.size(); ++i) {
+                if (const auto* system = per_file[i]) {
+                    for (std::uint64_t r = 0; r < system->header.removed_count; ++r) {
+                        latest[system->removed_id(r)] = REMOVED;
+                    }
+                    for (std::uint64_t r = 0; r < system->header.entity_count; ++r) {
+                        latest[system->id(r)] = i;
+                    }
+                }
+            }
+
+            sources.clear();
+            for (std::uint32_t i = 0; i < views.size(); ++i) {
+                const auto* system = per_file[i];
+                if (!system) {
+                    continue;
+                }
+                for (std::uint64_t r = 0; r < system->header.entity_count; ++r) {
+                    const auto id = system->id(r);
+                    const auto it = latest.find(id);
+                    if ((i == 0 && it == latest.end()) || (i > 0 && it->second == i)) {
+                        sources.push_back({id, i, static_cast<std::uint32_t>(r)});
+                    }
+                }
+            }
+            std::sort(sources.begin(), sources.end(),
+                      [](const Source& lhs, const Source& rhs) { return lhs.id < rhs.id; });
+
+            for (std::size_t i = 0; i < views.size(); ++i) {
+                new_rows[i].assign(per_file[i] ? per_file[i]->header.entity_count : 0, REMOVED);
+            }
+            ids.resize(sources.size());
+            for (std::size_t k = 0; k < sources.size(); ++k) {
+                ids[k] = sources[k].id;
+                new_rows[sources[k].file][sources[k].row] = static_cast<std::uint32_t>(k);
+            }
+
+            const auto system_at = reserve(out, sizeof(SystemHeader));
+            append(out, ids.data(), ids.size() * sizeof(EntityID));
+
+            std::uint32_t column_count = 0;
+            for (const auto& component : schema.get_components()) {
+                instances.clear();
+                for (std::size_t i = 0; i < views.size(); ++i) {
+                    const auto* column = per_file[i] ? per_file[i]->find_column(component->get_name_hash()) : nullptr;
+                    if (!column) {
+                        continue;
+                    }
+                    for (std::uint64_t j = 0; j < column->header.count; ++j) {
+                        const auto row = new_rows[i][column->row(j)];
+                        if (row != REMOVED) {
+                            instances.push_back({row, column, j});
+                        }
+                    }
+                }
+                if (instances.empty()) {
+                    continue;
+                }
+                ++column_count;
+                std::sort(instances.begin(), instances.end(),
+                          [](const Instance& lhs, const Instance& rhs) { return lhs.row < rhs.row; });
+
+                const auto record_size = component->get_record_size();
+                rows.resize(instances.size());
+                blob_offsets.resize(instances.size());
+                blob.clear();
+
+                const auto column_at = reserve(out, sizeof(ColumnHeader));
+                for (std::size_t k = 0; k < instances.size(); ++k) {
+                    rows[k] = instances[k].row;
+                }
+                append(out, rows.data(), rows.size() * sizeof(std::uint32_t));
+
+                const auto records_at = reserve(out, instances.size() * record_size);
+                for (std::size_t k = 0; k < instances.size(); ++k) {
+                    const auto& instance = instances[k];
+                    std::memcpy(out.data() + records_at + k * record_size,
+                                instance.column->records + instance.index * record_size, record_size);
+
+                    const auto [begin, end] = instance.column->blob_range(instance.index);
+                    blob_offsets[k] = blob.size();
+                    blob.insert(blob.end(), instance.column->blob + begin, instance.column->blob + end);
+                }
+
+                if (!blob.empty()) {
+                    append(out, blob_offsets.data(), blob_offsets.size() * sizeof(std::uint64_t));
+                }
+                append(out, blob.data(), blob.size());
+
+                const ColumnHeader header{component->get_name_hash(), component->get_schema_hash(),
+                                          instances.size(), record_size, blob.size()};
+                std::memcpy(out.data() + column_at, &header, sizeof(header));
+            }
+
+            const SystemHeader header{entry.name_hash, last->header.next_entity_id, ids.size(), 0, column_count, 0};
+            std::memcpy(out.data() + system_at, &header, sizeof(header));
+        }
+
+        FileHeader header{};
+        std::memcpy(header.magic, "ECSSNAP", 8);
+        header.version = VERSION;
+        header.system_count = system_count;
+        header.tick_count = views.back().header.tick_count;
+        header.size = out.size();
+        header.kind = Kind::Full;
+        header.sequence = views.back().header.sequence;
+        std::memcpy(out.data(), &header, sizeof(header));
+        return SnapshotStatus::Ok;
+    }
+
+    static SnapshotStatus save(World& world, const SnapshotSchema& schema, const std::string& path) {
+        std::vector<char> buffer;
+        encode(world, schema, buffer);
+        return write_file(path, buffer.data(), buffer.size());
+    }
+
+    /**
+     * @brief Maps the file into memory and decodes it in place
+     */
+    static SnapshotStatus load(World& world, const SnapshotSchema& schema, const std::string& path) {
+        MappedFile file(path);
+        if (!file.data()) {
+            return SnapshotStatus::OpenFailed;
+        }
+        return decode(world, schema, file.data(), file.size());
+    }
+
+    static SnapshotStatus write_file(const std::string& path, const char* data, const std::size_t size) {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return SnapshotStatus::OpenFailed;
+        }
+
+        const bool written = std::fwrite(data, 1, size, file) == size;
+        const bool closed = std::fclose(file) == 0;
+        return written && closed ? SnapshotStatus::Ok : SnapshotStatus::WriteFailed;
+    }
+
+    static constexpr std::size_t padded(const std::size_t size) noexcept {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+
+private:
+    struct Column {
+        std::vector<std::uint32_t> rows;
+        std::vector<const Component*> instances;
+    };
+
+    static EntityID read_id(const char* ids, const std::uint64_t index) noexcept {
+        EntityID id;
+        std::memcpy(&id, ids + index * sizeof(EntityID), sizeof(id));
+        return id;
+    }
+
+    static std::size_t reserve(std::vector<char>& out, const std::size_t size) {
+        const auto at = out.size();
+        out.resize(at + padded(size));
+        return at;
+    }
+
+    static void append(std::vector<char>& out, const void* data, const std::size_t size) {
+        const auto at = reserve(out, size);
+        if (size > 0) {
+            std::memcpy(out.data() + at, data, size);
+        }
+    }
+
+    static void write_column(std::vector<char>& out, const ComponentSchema& component, const Column& column,
+                             std::vector<char>& blob) {
+        const auto count = column.instances.size();
+        const auto column_at = reserve(out, sizeof(ColumnHeader));
+        append(out, column.rows.data(), count * sizeof(std::uint32_t));
+
+        const auto record_size = component.get_record_size();
+        const auto records_at = reserve(out, count * record_size);
+
+        std::vector<std::uint64_t> blob_offsets(count);
+        blob.clear();
+        SnapshotWriter blob_writer(blob);
+        for (std::size_t k = 0; k < count; ++k) {
+            blob_offsets[k] = blob.size();
+            component.save(*column.instances[k], out.data() + records_at + k * record_size, blob_writer);
+        }
+
+        if (!blob.empty()) {
+            append(out, blob_offsets.data(), count * sizeof(std::uint64_t));
+        }
+        append(out, blob.data(), blob.size());
+
+        const ColumnHeader header{component.get_name_hash(), component.get_schema_hash(), count, record_size,
+                                  blob.size()};
+        std::memcpy(out.data() + column_at, &header, sizeof(header));
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_SNAPSHOT_HPP
@@ -0,0 +1,139 @@
+#ifndef GAME_ECS_STATE_BUCKETS_HPP
+#define GAME_ECS_STATE_BUCKETS_HPP
+
+#include "entity.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Keeps entities in one dense list per state
+ *
+ * Each state's bucket holds a payload per entity (typically cached component
+ * pointers) so a handler can process a homogeneous batch in a tight loop
+ * without switching on the state per entity. Transitions found during a pass
+ * are recorded and applied as bucket moves afterwards, which keeps the
+ * buckets stable while they are being iterated.
+ *
+ * `State` must be an enum whose values are 0 .. Count - 1.
+ */
+template<typename State, std::size_t Count, typename Item>
+class StateBuckets {
+    struct Slot {
+        std::uint32_t state;
+        std::uint32_t index;
+    };
+
+    std::array<std::vector<Item>, Count> items_;
+    std::array<std::vector<EntityID>, Count> ids_;
+    std::unordered_map<EntityID, Slot> slots_;
+    std::vector<std::pair<EntityID, State>> transitions_;
+
+public:
+    std::size_t size() const noexcept { return slots_.size(); }
+
+    std::vector<Item>& get_items(const State state) noexcept { return items_[index_of(state)]; }
+    const std::vector<Item>& get_items(const State state) const noexcept { return items_[index_of(state)]; }
+    const std::vector<EntityID>& get_ids(const State state) const noexcept { return ids_[index_of(state)]; }
+
+    bool contains(const EntityID id) const noexcept {
+        return slots_.find(id) != slots_.end();
+    }
+
+    bool insert(const EntityID id, const State state, Item item) {
+        if (contains(id)) {
+            return false;
+        }
+
+        const auto bucket = index_of(state);
+        slots_.emplace(id, Slot{bucket, static_cast<std::uint32_t>(ids_[bucket].size())});
+        ids_[bucket].push_back(id);
+        items_[bucket].push_back(std::move(item));
+        return true;
+    }
+
+    bool erase(const EntityID id) {
+        const auto it = slots_.find(id);
+        if (it == slots_.end()) {
+            return false;
+        }
+
+        unlink(it->second);
+        slots_.erase(it);
+        return true;
+    }
+
+    void clear() noexcept {
+        for (std::size_t i = 0; i < Count; ++i) {
+            items_[i].clear();
+            ids_[i].clear();
+        }
+        slots_.clear();
+        transitions_.clear();
+    }
+
+    /**
+     * @brief Queues a move to `state`, applied by apply_transitions()
+     */
+    void record_transition(const EntityID id, const State state) {
+        transitions_.emplace_back(id, state);
+    }
+
+    std::size_t get_pending_transitions() const noexcept { return transitions_.size(); }
+
+    /**
+     * @brief Moves every entity with a recorded transition into its new bucket
+     *
+     * Returns the number of entities that changed buckets.
+     */
+    std::size_t apply_transitions() {
+        std::size_t moved = 0;
+        for (const auto& [id, state] : transitions_) {
+            const auto it = slots_.find(id);
+            const auto bucket = index_of(state);
+            if (it == slots_.end() || it->second.state == bucket) {
+                continue;
+            }
+
+            Item item = std::move(items_[it->second.state][it->second.index]);
+            unlink(it->second);
+
+            it->second = Slot{bucket, static_cast<std::uint32_t>(ids_[bucket].size())};
+            ids_[bucket].push_back(id);
+            items_[bucket].push_back(std::move(item));
+            ++moved;
+        }
+        transitions_.clear();
+        return moved;
+    }
+
+private:
+    static std::uint32_t index_of(const State state) noexcept {
+        return static_cast<std::uint32_t>(state);
+    }
+
+    void unlink(const Slot& slot) {
+        auto& ids = ids_[slot.state];
+        auto& items = items_[slot.state];
+
+        const auto moved = ids.back();
+        if (slot.index + 1 < ids.size()) {
+            ids[slot.index] = moved;
+            items[slot.index] = std::move(items.back());
+            slots_.find(moved)->second.index = slot.index;
+        }
+        ids.pop_back();
+        items.pop_back();
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_STATE_BUCKETS_HPP
@@ -0,0 +1,200 @@
+#ifndef GAME_ECS_STATIC_WORLD_HPP
+#define GAME_ECS_STATIC_WORLD_HPP
+
+#include "random.hpp"
+#include "schedule.hpp"
+#include "system.hpp"
+#include "world.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief World with a fixed set of systems, resolved at compile time
+ *
+ * The systems live inside the world in a tuple, in the order they are
+ * listed, instead of behind a type-keyed map of pointers. get_system<T>()
+ * is an index into the tuple, and tick() calls each system's own tick()
+ * directly rather than through the vtable, so the compiler can inline
+ * systems into the tick loop and across each other. Ordering, update
+ * schedules, staggering, deterministic mode and random seeds behave as in
+ * World. Tools that take a `World&` (snapshots, replication, ...) need a
+ * World; StaticWorld is meant for shipped builds whose system set is fixed.
+ */
+template<typename... Systems>
+class StaticWorld {
+    static_assert(sizeof...(Systems) > 0, "StaticWorld needs at least one system");
+    static_assert((std::is_base_of_v<System, Systems> && ...), "Systems must inherit System");
+
+    template<typename T>
+    static constexpr std::size_t count_of = (static_cast<std::size_t>(std::is_same_v<T, Systems>) + ...);
+
+    static_assert(((count_of<Systems> == 1) && ...), "Each system type may only appear once");
+
+    template<typename T>
+    static constexpr std::size_t index_of() noexcept {
+        constexpr bool matches[] = {std::is_same_v<T, Systems>...};
+        std::size_t index = 0;
+        while (!matches[index]) {
+            ++index;
+        }
+        return index;
+    }
+
+    // Builds a system in place from a tuple of constructor arguments; systems can't be moved
+    template<typename T>
+    struct Slot {
+        T system;
+
+        Slot() = default;
+
+        template<typename... Args>
+        explicit Slot(std::tuple<Args...>&& args)
+            : system(std::make_from_tuple<T>(std::move(args))) {}
+    };
+
+    std::tuple<Slot<Systems>...> systems_;
+    std::array<System*, sizeof...(Systems)> order_;
+    std::uint64_t tick_count_{0};
+    std::uint64_t random_seed_{0};
+    bool deterministic_{false};
+    bool running_{true};
+
+public:
+    static constexpr std::size_t system_count = sizeof...(Systems);
+
+    StaticWorld() {
+        collect_order();
+    }
+
+    /**
+     * @brief Constructs each system from its own tuple of arguments, e.g. `std::forward_as_tuple(service)`
+     */
+    template<typename... ArgTuples>
+    explicit StaticWorld(std::piecewise_construct_t, ArgTuples&&... args)
+        : systems_(std::forward<ArgTuples>(args)...) {
+        static_assert(sizeof...(ArgTuples) == sizeof...(Systems), "Pass one argument tuple per system");
+        collect_order();
+    }
+
+    StaticWorld(const StaticWorld&) = delete;
+    StaticWorld& operator=(const StaticWorld&) = delete;
+
+    ~StaticWorld() {
+        shutdown();
+    }
+
+    bool initialize() noexcept {
+        stagger_systems();
+        return std::apply([](auto&... slots) {
+            return (slots.system.initialize() && ...);
+        }, systems_);
+    }
+
+    void tick(const float& delta) noexcept {
+        if (!running_) {
+            return;
+        }
+        std::apply([this, &delta](auto&... slots) {
+            (tick_system(slots.system, delta), ...);
+        }, systems_);
+        ++tick_count_;
+    }
+
+    /**
+     * @brief Shuts systems down in reverse order; the world doesn't tick afterwards
+     */
+    void shutdown() noexcept {
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+            (*it)->shutdown();
+        }
+    }
+
+    std::uint64_t get_tick_count() const noexcept { return tick_count_; }
+
+    void set_tick_count(const std::uint64_t tick_count) noexcept { tick_count_ = tick_count; }
+
+    bool is_deterministic() const noexcept { return deterministic_; }
+
+    void set_deterministic(const bool deterministic) {
+        deterministic_ = deterministic;
+        for (auto* system : order_) {
+            system->set_deterministic(deterministic);
+        }
+    }
+
+    std::uint64_t get_random_seed() const noexcept { return random_seed_; }
+
+    /**
+     * @brief Seeds every system's random streams the same way World does for the same order
+     */
+    void set_random_seed(const std::uint64_t seed) noexcept {
+        random_seed_ = seed;
+        for (std::size_t i = 0; i < order_.size(); ++i) {
+            order_[i]->set_random_seed(RandomStream::mix(seed + i));
+        }
+    }
+
+    const std::array<System*, sizeof...(Systems)>& get_system_order() const noexcept { return order_; }
+
+    void stagger_systems() noexcept {
+        stagger_update_phases(order_);
+    }
+
+    template<typename T>
+    void set_update_schedule(const UpdateSchedule& schedule) noexcept {
+        get_system<T>()->set_update_schedule(schedule);
+        stagger_systems();
+    }
+
+    template<typename T>
+    static constexpr bool has_system() noexcept {
+        return count_of<T> == 1;
+    }
+
+    /**
+     * @brief Never null; asking for a system the world doesn't have fails to compile
+     */
+    template<typename T>
+    [[nodiscard]] T* get_system() noexcept {
+        static_assert(has_system<T>(), "T is not one of this world's systems");
+        return &std::get<index_of<T>()>(systems_).system;
+    }
+
+    template<typename T>
+    [[nodiscard]] const T* get_system() const noexcept {
+        static_assert(has_system<T>(), "T is not one of this world's systems");
+        return &std::get<index_of<T>()>(systems_).system;
+    }
+
+private:
+    void collect_order() noexcept {
+        order_ = std::apply([](auto&... slots) {
+            return std::array<System*, sizeof...(Systems)>{&slots.system...};
+        }, systems_);
+        set_random_seed(random_seed_);
+    }
+
+    template<typename T>
+    void tick_system(T& system, const float& delta) noexcept {
+        float system_delta = 0.0f;
+        if (system.advance_schedule(tick_count_, delta, system_delta)) {
+            system.T::tick(system_delta); // Qualified, so not a virtual call
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_STATIC_WORLD_HPP
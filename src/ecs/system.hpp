@@ -2,8 +2,15 @@
 #define GAME_ECS_SYSTEM_HPP
 
 #include "entity.hpp"
+#include "random.hpp"
+#include "schedule.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <typeindex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace game {
 namespace ecs {
@@ -27,10 +34,114 @@ using SystemEntities = std::unordered_map<EntityID, std::unique_ptr<Entity>>;
  * as well as managing the lifecycle of entities they own.
  */
 class System {
+    /**
+     * @brief Routes entity notifications to the system's hooks and its attached observers
+     *
+     * Writes are only routed while an observer that wants them is attached or
+     * the system has enabled its own write hook; otherwise entities skip the
+     * notification entirely.
+     */
+    class Observers : public EntityObserver {
+        System& system_;
+        std::vector<EntityObserver*> attached_;
+        bool write_hook_{false};
+
+    public:
+        explicit Observers(System& system) noexcept : system_(system) {
+            wants_writes_ = false;
+        }
+
+        bool attach(EntityObserver* observer) {
+            if (!observer || std::find(attached_.begin(), attached_.end(), observer) != attached_.end()) {
+                return false;
+            }
+            attached_.push_back(observer);
+            update_wants_writes();
+            return true;
+        }
+
+        bool detach(EntityObserver* observer) noexcept {
+            const auto it = std::find(attached_.begin(), attached_.end(), observer);
+            if (it == attached_.end()) {
+                return false;
+            }
+            attached_.erase(it);
+            update_wants_writes();
+            return true;
+        }
+
+        void set_write_hook(const bool enabled) noexcept {
+            write_hook_ = enabled;
+            update_wants_writes();
+        }
+
+        void update_wants_writes() noexcept {
+            wants_writes_ = write_hook_ || std::any_of(attached_.begin(), attached_.end(), [](const auto* observer) {
+                return observer->wants_writes();
+            });
+        }
+
+        void on_entity_added(Entity& entity) noexcept override {
+            system_.on_entity_added(entity);
+            for (auto* observer : attached_) {
+                observer->on_entity_added(entity);
+            }
+        }
+
+        void on_entity_removed(Entity& entity) noexcept override {
+            system_.on_entity_removed(entity.get_id());
+            for (auto* observer : attached_) {
+                observer->on_entity_removed(entity);
+            }
+        }
+
+        void on_component_added(Entity& entity, const std::type_index& type) noexcept override {
+            system_.on_component_added(entity, type);
+            for (auto* observer : attached_) {
+                observer->on_component_added(entity, type);
+            }
+        }
+
+        void on_component_removed(Entity& entity, const std::type_index& type) noexcept override {
+            system_.on_component_removed(entity, type);
+            for (auto* observer : attached_) {
+                observer->on_component_removed(entity, type);
+            }
+        }
+
+        void on_component_written(Entity& entity, const std::type_index& type) noexcept override {
+            if (write_hook_) {
+                system_.on_component_written(entity, type);
+            }
+            for (auto* observer : attached_) {
+                observer->on_component_written(entity, type);
+            }
+        }
+    };
+
     EntityID next_entity_id_{1};
     SystemEntities entities_;
+    Observers observers_{*this};
+    UpdateSchedule schedule_;
+    std::uint32_t phase_ticks_{0};
+    float phase_seconds_{0.0f};
+    float pending_delta_{0.0f};
+    std::vector<float> slice_deltas_;
+    std::uint32_t current_slice_{0};
+    std::uint64_t current_tick_{0};
+    std::uint64_t random_seed_{0};
+
+    // Deterministic mode: entities by ID; removed entries are nulled and compacted before the next pass
+    bool deterministic_{false};
+    std::vector<std::pair<EntityID, Entity*>> order_;
+    bool order_sorted_{true};
+    std::size_t order_removed_{0};
+    std::uint32_t passes_running_{0};
 
 public:
+    System() = default;
+    System(const System&) = delete;
+    System& operator=(const System&) = delete;
     virtual ~System() = default;
 
     virtual bool initialize() noexcept {
@@ -42,6 +153,164 @@ public:
     virtual void shutdown() noexcept {
     }
 
+    const UpdateSchedule& get_update_schedule() const noexcept { return schedule_; }
+
+    void set_update_schedule(const UpdateSchedule& schedule) noexcept {
+        schedule_ = schedule;
+        if (schedule_.interval_ticks == 0) {
+            schedule_.interval_ticks = 1;
+        }
+        if (schedule_.slices == 0) {
+            schedule_.slices = 1;
+        }
+
+        phase_ticks_ = 0;
+        phase_seconds_ = 0.0f;
+        pending_delta_ = 0.0f;
+        current_slice_ = 0;
+        slice_deltas_.assign(schedule_.slices, 0.0f);
+    }
+
+    /**
+     * @brief Offsets this system's runs as member `index` of `count` systems sharing its interval
+     */
+    void set_update_phase(const std::uint32_t index, const std::uint32_t count) noexcept {
+        if (count == 0) {
+            return;
+        }
+
+        if (schedule_.uses_seconds()) {
+            phase_seconds_ = schedule_.interval_seconds * static_cast<float>(index) / static_cast<float>(count);
+        } else {
+            phase_ticks_ = static_cast<std::uint32_t>(
+                static_cast<std::uint64_t>(schedule_.interval_ticks) * index / count);
+        }
+    }
+
+    /**
+     * @brief Accumulates `delta` and reports whether the system is due on world tick `tick`
+     *
+     * When due, `run_delta` receives the time accumulated for the work that runs
+     * this tick (the current slice, if the system is sliced).
+     */
+    bool advance_schedule(const std::uint64_t tick, const float delta, float& run_delta) noexcept {
+        current_tick_ = tick;
+        pending_delta_ += delta;
+
+        bool due = false;
+        if (schedule_.uses_seconds()) {
+            due = pending_delta_ + phase_seconds_ >= schedule_.interval_seconds;
+        } else {
+            due = (tick + phase_ticks_) % schedule_.interval_ticks == 0;
+        }
+
+        if (!due) {
+            return false;
+        }
+
+        const float elapsed = pending_delta_;
+        pending_delta_ = 0.0f;
+        phase_seconds_ = 0.0f;
+
+        if (schedule_.slices <= 1) {
+            run_delta = elapsed;
+            return true;
+        }
+
+        for (auto& slice_delta : slice_deltas_) {
+            slice_delta += elapsed;
+        }
+
+        current_slice_ = (current_slice_ + 1) % schedule_.slices;
+        run_delta = slice_deltas_[current_slice_];
+        slice_deltas_[current_slice_] = 0.0f;
+        return true;
+    }
+
+    std::uint32_t get_current_slice() const noexcept { return current_slice_; }
+
+    bool in_current_slice(const EntityID id) const noexcept {
+        return schedule_.slices <= 1 || id % schedule_.slices == current_slice_;
+    }
+
+    template<typename Fn>
+    void for_each_slice_entity(Fn&& fn) {
+        for_each_entity([this, &fn](const EntityID id, Entity& entity) {
+            if (in_current_slice(id)) {
+                fn(id, entity);
+            }
+        });
+    }
+
+    /**
+     * @brief Calls `fn(id, entity)` for every entity, in ID order when the system is deterministic
+     *
+     * In deterministic mode `fn` may remove entities, including ones not yet
+     * visited; entities added during the pass are visited from the next pass.
+     * Otherwise the order follows the hash map and `fn` must not add or remove
+     * entities.
+     */
+    template<typename Fn>
+    void for_each_entity(Fn&& fn) {
+        if (!deterministic_) {
+            for (auto& [id, entity] : entities_) {
+                fn(id, *entity);
+            }
+            return;
+        }
+
+        if (passes_running_ == 0) {
+            prepare_order();
+        }
+
+        ++passes_running_;
+        const auto count = order_.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (auto* entity = order_[i].second) {
+                fn(order_[i].first, *entity);
+            }
+        }
+        --passes_running_;
+    }
+
+    bool is_deterministic() const noexcept { return deterministic_; }
+
+    /**
+     * @brief Makes for_each_entity() and for_each_slice_entity() visit entities in ID order
+     */
+    void set_deterministic(const bool deterministic) {
+        deterministic_ = deterministic;
+        order_.clear();
+        order_removed_ = 0;
+        order_sorted_ = true;
+        if (!deterministic_) {
+            return;
+        }
+
+        order_.reserve(entities_.size());
+        for (auto& [id, entity] : entities_) {
+            order_.emplace_back(id, entity.get());
+        }
+        std::sort(order_.begin(), order_.end());
+    }
+
+    /**
+     * @brief Seeds the streams handed out by random_stream(); World sets this per system
+     */
+    void set_random_seed(const std::uint64_t seed) noexcept { random_seed_ = seed; }
+    std::uint64_t get_random_seed() const noexcept { return random_seed_; }
+
+    /**
+     * @brief Random numbers for one entity on the current world tick
+     *
+     * The stream depends only on the system's seed, the tick, `id` and
+     * `salt`, so it is the same on every peer and after a rollback. Use
+     * different salts for independent draws for the same entity in a tick.
+     */
+    RandomStream random_stream(const EntityID id, const std::uint64_t salt = 0) const noexcept {
+        return RandomStream(random_seed_, current_tick_, id, salt);
+    }
+
     const SystemEntities& get_entities() const noexcept { return entities_; }
     SystemEntities& get_entities() noexcept { return entities_; }
 
@@ -76,20 +345,184 @@ public:
         auto entity = std::make_unique<Entity>(new_entity_id);
         auto* entity_ptr = entity.get();
 
+        entity_ptr->set_observer(&observers_);
+
         entities_.emplace(new_entity_id, std::move(entity));
+        track_order(new_entity_id, entity_ptr);
+        observers_.on_entity_added(*entity_ptr);
+
+        return entity_ptr;
+    }
+
+    /**
+     * @brief Creates an entity with a given ID, e.g. when restoring saved state
+     *
+     * Returns nullptr if the ID is 0 or already in use. Later add_entity()
+     * calls continue after the highest ID seen.
+     */
+    [[nodiscard]] Entity* add_entity(const EntityID id) noexcept {
+        if (id == 0 || entities_.find(id) != entities_.end()) {
+            return nullptr;
+        }
+
+        next_entity_id_ = std::max(next_entity_id_, id + 1);
+
+        auto entity = std::make_unique<Entity>(id);
+        auto* entity_ptr = entity.get();
+
+        entity_ptr->set_observer(&observers_);
+
+        entities_.emplace(id, std::move(entity));
+        track_order(id, entity_ptr);
+        observers_.on_entity_added(*entity_ptr);
 
         return entity_ptr;
     }
 
+    EntityID get_next_entity_id() const noexcept { return next_entity_id_; }
+
+    /**
+     * @brief Sets the ID the next add_entity() call will use; ignored if it is already in use or below a live ID
+     */
+    bool set_next_entity_id(const EntityID id) noexcept {
+        // Every live ID is below next_entity_id_, so only IDs being handed back need checking
+        if (id < next_entity_id_) {
+            if (next_entity_id_ - id <= entities_.size()) {
+                for (auto candidate = id; candidate < next_entity_id_; ++candidate) {
+                    if (entities_.find(candidate) != entities_.end()) {
+                        return false;
+                    }
+                }
+            } else {
+                for (const auto& [existing, _] : entities_) {
+                    if (existing >= id) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        next_entity_id_ = std::max<EntityID>(id, 1);
+        return true;
+    }
+
+    /**
+     * @brief Removes every entity, notifying hooks and observers for each
+     */
+    void clear_entities() noexcept {
+        for (auto& [_, entity] : entities_) {
+            observers_.on_entity_removed(*entity);
+        }
+        entities_.clear();
+
+        for (auto& entry : order_) {
+            entry.second = nullptr;
+        }
+        order_removed_ = order_.size();
+    }
+
     bool remove_entity(const EntityID id) noexcept {
         const auto it = entities_.find(id);
         if (it == entities_.end()) {
             return false; // Entity doesn't exist
         }
         
+        observers_.on_entity_removed(*it->second);
+        untrack_order(id, it->second.get());
         entities_.erase(it);
         return true;
     }
+
+    /**
+     * @brief Attaches an observer that receives entity and component events from this system
+     */
+    bool attach_observer(EntityObserver* observer) {
+        return observers_.attach(observer);
+    }
+
+    bool detach_observer(EntityObserver* observer) noexcept {
+        return observers_.detach(observer);
+    }
+
+protected:
+    /**
+     * @brief Called right after an entity is created by add_entity()
+     */
+    virtual void on_entity_added(Entity&) noexcept {
+    }
+
+    /**
+     * @brief Called right before an entity is destroyed by remove_entity()
+     */
+    virtual void on_entity_removed(const EntityID) noexcept {
+    }
+
+    virtual void on_component_added(Entity&, const std::type_index&) noexcept {
+    }
+
+    virtual void on_component_removed(Entity&, const std::type_index&) noexcept {
+    }
+
+    /**
+     * @brief Called when a component is modified through Entity::write_component() or mark_written()
+     *
+     * Only called after enable_write_hook(); without it, and with no observer
+     * attached, writes are not reported at all.
+     */
+    virtual void on_component_written(Entity&, const std::type_index&) noexcept {
+    }
+
+    /**
+     * @brief Routes writes to on_component_written() even when no observer is attached
+     */
+    void enable_write_hook(const bool enabled = true) noexcept {
+        observers_.set_write_hook(enabled);
+    }
+
+private:
+    void track_order(const EntityID id, Entity* entity) {
+        if (!deterministic_) {
+            return;
+        }
+        if (!order_.empty() && order_.back().first > id) {
+            order_sorted_ = false;
+        }
+        order_.emplace_back(id, entity);
+    }
+
+    void untrack_order(const EntityID id, const Entity* entity) noexcept {
+        if (!deterministic_) {
+            return;
+        }
+
+        auto first = order_.begin();
+        auto last = order_.end();
+        if (order_sorted_) {
+            first = std::lower_bound(first, last, id, [](const std::pair<EntityID, Entity*>& entry, const EntityID key) {
+                return entry.first < key;
+            });
+        }
+        for (; first != last; ++first) {
+            if (first->second == entity) {
+                first->second = nullptr;
+                ++order_removed_;
+                return;
+            }
+        }
+    }
+
+    void prepare_order() {
+        if (order_removed_ > 0) {
+            order_.erase(std::remove_if(order_.begin(), order_.end(),
+                                        [](const std::pair<EntityID, Entity*>& entry) { return !entry.second; }),
+                         order_.end());
+            order_removed_ = 0;
+        }
+        if (!order_sorted_) {
+            std::sort(order_.begin(), order_.end());
+            order_sorted_ = true;
+        }
+    }
 };
 
 }//ecs
@@ -0,0 +1,352 @@
+#ifndef GAME_ECS_SYSTEM_BASE_HPP
+#define GAME_ECS_SYSTEM_BASE_HPP
+
+#include "entity.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+template<typename... Ts>
+struct TypeList {};
+
+/**
+ * @brief What a CRTP system's update() asks for, read off its signature
+ *
+ * Each parameter of `update` is the tick's delta (`float`), the entity's ID
+ * (`EntityID`) or a reference to one of the entity's components, in any
+ * order. The components form the system's query; `const` references mark
+ * components the system only reads.
+ */
+template<typename Derived>
+class UpdateTraits {
+    template<typename F>
+    struct Signature;
+
+    template<typename C, typename R, typename... Ps>
+    struct Signature<R (C::*)(Ps...)> {
+        using Params = TypeList<Ps...>;
+    };
+
+    template<typename C, typename R, typename... Ps>
+    struct Signature<R (C::*)(Ps...) noexcept> {
+        using Params = TypeList<Ps...>;
+    };
+
+    template<typename C, typename R, typename... Ps>
+    struct Signature<R (C::*)(Ps...) const> {
+        using Params = TypeList<Ps...>;
+    };
+
+    template<typename C, typename R, typename... Ps>
+    struct Signature<R (C::*)(Ps...) const noexcept> {
+        using Params = TypeList<Ps...>;
+    };
+
+    template<typename Found, typename... Ps>
+    struct Components;
+
+    template<typename... Cs>
+    struct Components<TypeList<Cs...>> {
+        using Type = TypeList<Cs...>;
+    };
+
+    template<typename... Cs, typename P, typename... Ps>
+    struct Components<TypeList<Cs...>, P, Ps...>
+        : std::conditional_t<std::is_base_of_v<Component, std::remove_cvref_t<P>>,
+                             Components<TypeList<Cs..., std::remove_cvref_t<P>>, Ps...>,
+                             Components<TypeList<Cs...>, Ps...>> {};
+
+    template<typename List>
+    struct QueryOf;
+
+    template<typename... Ps>
+    struct QueryOf<TypeList<Ps...>> {
+        using Type = typename Components<TypeList<>, Ps...>::Type;
+    };
+
+public:
+    using Params = typename Signature<decltype(&Derived::update)>::Params;
+    using Query = typename QueryOf<Params>::Type;
+};
+
+template<typename S>
+concept HasInitialize = requires(S& system) {
+    { system.initialize() } -> std::convertible_to<bool>;
+};
+
+template<typename S>
+concept HasShutdown = requires(S& system) {
+    system.shutdown();
+};
+
+/**
+ * @brief Whether a scheduler may run the system's update() in one loop with its neighbours'
+ *
+ * True unless the system declares `static constexpr bool fusible = false`,
+ * which it should when an update depends on what the system did to other
+ * entities earlier in the same pass.
+ */
+template<typename S>
+constexpr bool is_fusible = [] {
+    if constexpr (requires { S::fusible; }) {
+        return static_cast<bool>(S::fusible);
+    } else {
+        return true;
+    }
+}();
+
+/**
+ * @brief Base for systems that declare a per-entity update() and let the framework run the loop
+ *
+ * A system derives from SystemBase<itself> and defines e.g.
+ * `void update(float delta, Position& pos, const Velocity& vel)`. run()
+ * visits every entity of a Registry that has the queried components and
+ * calls update() directly, without virtual dispatch. `initialize()` and
+ * `shutdown()` are optional and are detected at compile time. Entities
+ * passed to destroy_later() are removed after the system's pass, as the
+ * tables can't change while they are being iterated.
+ */
+template<typename Derived>
+class SystemBase {
+    std::vector<EntityID> pending_destroy_;
+
+public:
+    using Traits = UpdateTraits<Derived>;
+
+    template<typename Registry>
+    void run(Registry& registry, const float delta) {
+        run_query(registry, delta, typename Traits::Query{});
+        apply_pending(registry);
+    }
+
+    /**
+     * @brief Calls update() for one entity, given the column pointers of its table
+     */
+    template<typename Columns>
+    void update_row(const float& delta, const EntityID& id, const Columns& columns, const std::size_t row) {
+        call_update(delta, id, columns, row, typename Traits::Params{});
+    }
+
+    template<typename Registry>
+    void apply_pending(Registry& registry) {
+        for (const auto id : pending_destroy_) {
+            registry.destroy(id);
+        }
+        pending_destroy_.clear();
+    }
+
+    bool has_pending() const noexcept { return !pending_destroy_.empty(); }
+
+protected:
+    void destroy_later(const EntityID id) { pending_destroy_.push_back(id); }
+
+private:
+    template<typename Registry, typename... Cs>
+    void run_query(Registry& registry, const float delta, TypeList<Cs...>) {
+        static_assert(sizeof...(Cs) > 0, "update() must take at least one component");
+        registry.template view<Cs...>().for_each_table(
+            [this, delta](const std::size_t count, const EntityID* ids, Cs*... columns) {
+                const auto pointers = std::make_tuple(columns...);
+                for (std::size_t row = 0; row < count; ++row) {
+                    update_row(delta, ids[row], pointers, row);
+                }
+            });
+    }
+
+    template<typename Columns, typename... Ps>
+    void call_update(const float& delta, const EntityID& id, const Columns& columns, const std::size_t row,
+                     TypeList<Ps...>) {
+        static_cast<Derived&>(*this).update(argument<Ps>(delta, id, columns, row)...);
+    }
+
+    template<typename P, typename Columns>
+    static decltype(auto) argument(const float& delta, const EntityID& id, const Columns& columns,
+                                   const std::size_t row) noexcept {
+        using T = std::remove_cvref_t<P>;
+        if constexpr (std::is_same_v<T, float>) {
+            return (delta);
+        } else if constexpr (std::is_same_v<T, EntityID>) {
+            return (id);
+        } else {
+            static_assert(std::is_base_of_v<Component, T>, "update() parameters are float, EntityID or components");
+            return (std::get<T*>(columns)[row]);
+        }
+    }
+};
+
+/**
+ * @brief Runs CRTP systems over one Registry in the listed order, with no virtual calls
+ *
+ * Consecutive fusible systems, up to four at a time, are fused: instead of
+ * one pass over the tables per system, a single pass visits each table once
+ * and, row by row, calls the update() of every system whose query the table
+ * matches, in the listed order. Each table runs a loop compiled for exactly
+ * the systems that match it. Each entity still sees the systems in order, so the result
+ * is the same as running them one after another as long as no update reads
+ * other entities; entities passed to destroy_later() are removed after the
+ * fused pass rather than after each system.
+ */
+template<typename Registry, typename... Systems>
+class StaticScheduler {
+    using Mask = typename Registry::Mask;
+
+    Registry& registry_;
+    std::tuple<Systems...> systems_;
+    std::uint64_t tick_count_{0};
+    bool fusion_enabled_{true};
+
+    // Each fused group compiles one loop per subset of its systems
+    static constexpr std::size_t MAX_FUSED = 4;
+
+    template<std::size_t I>
+    using SystemAt = std::tuple_element_t<I, std::tuple<Systems...>>;
+
+    template<typename... Cs>
+    static constexpr Mask mask_of(TypeList<Cs...>) noexcept {
+        return Registry::template mask_of<Cs...>;
+    }
+
+    template<typename S>
+    static constexpr Mask query_mask = mask_of(typename S::Traits::Query{});
+
+    // End of the run of fusible systems starting at I
+    template<std::size_t I>
+    static constexpr std::size_t fused_end() noexcept {
+        if constexpr (I < sizeof...(Systems)) {
+            if constexpr (is_fusible<SystemAt<I>>) {
+                return fused_end<I + 1>();
+            }
+        }
+        return I;
+    }
+
+public:
+    explicit StaticScheduler(Registry& registry)
+        : registry_(registry) {}
+
+    bool initialize() {
+        return std::apply([](auto&... systems) {
+            return (initialize_system(systems) && ...);
+        }, systems_);
+    }
+
+    void tick(const float delta) {
+        if (fusion_enabled_) {
+            tick_from<0>(delta);
+        } else {
+            std::apply([this, delta](auto&... systems) {
+                (systems.run(registry_, delta), ...);
+            }, systems_);
+        }
+        ++tick_count_;
+    }
+
+    bool is_fusion_enabled() const noexcept { return fusion_enabled_; }
+
+    /**
+     * @brief Runs every system in its own pass when disabled, e.g. to compare timings
+     */
+    void set_fusion_enabled(const bool enabled) noexcept { fusion_enabled_ = enabled; }
+
+    void shutdown() {
+        shutdown_from<sizeof...(Systems)>();
+    }
+
+    std::uint64_t get_tick_count() const noexcept { return tick_count_; }
+
+    Registry& get_registry() noexcept { return registry_; }
+
+    template<typename T>
+    [[nodiscard]] T* get_system() noexcept {
+        return &std::get<T>(systems_);
+    }
+
+private:
+    template<typename S>
+    static bool initialize_system(S& system) {
+        if constexpr (HasInitialize<S>) {
+            return system.initialize();
+        } else {
+            return true;
+        }
+    }
+
+    template<std::size_t I>
+    void tick_from(const float delta) {
+        if constexpr (I < sizeof...(Systems)) {
+            constexpr auto end = std::min(fused_end<I>(), I + MAX_FUSED);
+            if constexpr (end > I + 1) {
+                run_fused<I>(delta, std::make_index_sequence<end - I>{});
+                tick_from<end>(delta);
+            } else {
+                std::get<I>(systems_).run(registry_, delta);
+                tick_from<I + 1>(delta);
+            }
+        }
+    }
+
+    template<std::size_t Begin, std::size_t... Is>
+    void run_fused(const float delta, std::index_sequence<Is...>) {
+        constexpr Mask masks[] = {query_mask<SystemAt<Begin + Is>>...};
+        for (auto& table : registry_.get_tables()) {
+            const bool applies[] = {(table.mask & masks[Is]) == masks[Is]...};
+            if (table.size() == 0 || !(applies[Is] || ...)) {
+                continue;
+            }
+
+            const std::size_t subset = ((static_cast<std::size_t>(applies[Is]) << Is) | ...);
+            run_subset<Begin, sizeof...(Is)>(subset, delta, table,
+                                              std::make_index_sequence<std::size_t{1} << sizeof...(Is)>{});
+        }
+        (std::get<Begin + Is>(systems_).apply_pending(registry_), ...);
+    }
+
+    // Picks the loop compiled for exactly the systems that apply to the table
+    template<std::size_t Begin, std::size_t Count, typename Table, std::size_t... Subsets>
+    void run_subset(const std::size_t subset, const float delta, Table& table, std::index_sequence<Subsets...>) {
+        (void)((subset == Subsets ? (run_rows<Begin, Subsets>(delta, table, std::make_index_sequence<Count>{}), true)
+                                  : false) || ...);
+    }
+
+    template<std::size_t Begin, std::size_t Subset, typename Table, std::size_t... Is>
+    void run_rows(const float delta, Table& table, std::index_sequence<Is...>) {
+        const auto columns = table.get_columns();
+        const auto* ids = table.ids.data();
+        const auto count = table.size();
+        for (std::size_t row = 0; row < count; ++row) {
+            (update_if<Begin + Is, (Subset >> Is & 1) != 0>(delta, ids[row], columns, row), ...);
+        }
+    }
+
+    template<std::size_t I, bool Applies, typename Columns>
+    void update_if(const float& delta, const EntityID& id, const Columns& columns, const std::size_t row) {
+        if constexpr (Applies) {
+            std::get<I>(systems_).update_row(delta, id, columns, row);
+        }
+    }
+
+    // Reverse order, as World does
+    template<std::size_t I>
+    void shutdown_from() {
+        if constexpr (I > 0) {
+            auto& system = std::get<I - 1>(systems_);
+            if constexpr (HasShutdown<std::remove_reference_t<decltype(system)>>) {
+                system.shutdown();
+            }
+            shutdown_from<I - 1>();
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_SYSTEM_BASE_HPP
@@ -0,0 +1,180 @@
+#ifndef GAME_ECS_THREAD_POOL_HPP
+#define GAME_ECS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace game {
+namespace ecs {
+
+/**
+ * @brief Fixed set of worker threads shared by framework services
+ *
+ * Jobs are plain callables run in FIFO order. parallel_for() splits a range
+ * into chunks that the workers and the calling thread pull from until the
+ * range is exhausted, and returns once every chunk has run. parallel_for()
+ * must not be called from inside a pool job.
+ */
+class ThreadPool {
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable idle_;
+    std::size_t active_{0};
+    bool stopping_{false};
+
+public:
+    explicit ThreadPool(std::size_t thread_count = default_thread_count()) {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        workers_.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        work_available_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    static std::size_t default_thread_count() noexcept {
+        const auto hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 1;
+    }
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+    /**
+     * @brief Threads that quiesce() parks; lets a ForkCheckpointer account for them
+     */
+    std::size_t get_thread_count() const noexcept { return workers_.size(); }
+
+    std::size_t get_pending_count() {
+        std::lock_guard lock(mutex_);
+        return jobs_.size();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        work_available_.notify_one();
+    }
+
+    /**
+     * @brief Blocks until the queue is empty and no job is running
+     */
+    void wait_idle() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return jobs_.empty() && active_ == 0; });
+    }
+
+    /**
+     * @brief Waits until the pool is idle and keeps new jobs from starting while the returned lock is held
+     *
+     * Used before fork() so no worker is inside a job or holds the pool's
+     * mutex when the process is copied. submit() blocks until the lock is released.
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> quiesce() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return jobs_.empty() && active_ == 0; });
+        return lock;
+    }
+
+    /**
+     * @brief Runs `fn(begin, end)` over [0, count) in chunks of at most `grain` items
+     */
+    template<typename Fn>
+    void parallel_for(const std::size_t count, std::size_t grain, Fn&& fn) {
+        if (count == 0) {
+            return;
+        }
+
+        grain = std::max<std::size_t>(grain, 1);
+        const auto chunks = (count + grain - 1) / grain;
+        if (chunks == 1) {
+            fn(std::size_t{0}, count);
+            return;
+        }
+
+        std::atomic<std::size_t> next_chunk{0};
+        auto run_chunks = [&] {
+            for (auto chunk = next_chunk.fetch_add(1); chunk < chunks; chunk = next_chunk.fetch_add(1)) {
+                const auto begin = chunk * grain;
+                fn(begin, std::min(begin + grain, count));
+            }
+        };
+
+        const auto helpers = std::min(workers_.size(), chunks - 1);
+        std::mutex done_mutex;
+        std::condition_variable done;
+        std::size_t remaining = helpers;
+
+        for (std::size_t i = 0; i < helpers; ++i) {
+            submit([&] {
+                run_chunks();
+                std::lock_guard lock(done_mutex);
+                if (--remaining == 0) {
+                    done.notify_one();
+                }
+            });
+        }
+
+        run_chunks();
+
+        std::unique_lock lock(done_mutex);
+        done.wait(lock, [&] { return remaining == 0; });
+    }
+
+private:
+    void work() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(mutex_);
+                work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (stopping_ && jobs_.empty()) {
+                    return;
+                }
+
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+                ++active_;
+            }
+
+            job();
+
+            {
+                std::lock_guard lock(mutex_);
+                --active_;
+                if (jobs_.empty() && active_ == 0) {
+                    idle_.notify_all();
+                }
+            }
+        }
+    }
+};
+
+}//ecs
+}//game
+
+#endif//GAME_ECS_THREAD_POOL_HPP
@@ -1,11 +1,17 @@
 #ifndef GAME_ECS_WORLD_HPP
 #define GAME_ECS_WORLD_HPP
 
+#include "random.hpp"
+#include "schedule.hpp"
 #include "system.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <vector>
 
 namespace game {
 namespace ecs {
@@ -20,6 +26,39 @@ namespace ecs {
  */
 using WorldSystems = std::unordered_map<std::type_index, std::unique_ptr<System>>;
 
+/**
+ * @brief Spreads the staggered systems that share an update interval evenly across ticks
+ */
+inline void stagger_update_phases(const std::span<System* const> systems) noexcept {
+    std::vector<System*> pending;
+    for (auto* system : systems) {
+        const auto& schedule = system->get_update_schedule();
+        if (schedule.stagger && (schedule.uses_seconds() || schedule.interval_ticks > 1)) {
+            pending.push_back(system);
+        }
+    }
+
+    std::vector<System*> group;
+    while (!pending.empty()) {
+        const auto& schedule = pending.front()->get_update_schedule();
+
+        group.clear();
+        for (auto it = pending.begin(); it != pending.end();) {
+            if ((*it)->get_update_schedule().same_interval(schedule)) {
+                group.push_back(*it);
+                it = pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        const auto count = static_cast<std::uint32_t>(group.size());
+        for (std::uint32_t i = 0; i < count; ++i) {
+            group[i]->set_update_phase(i, count);
+        }
+    }
+}
+
 /**
  * @brief Central coordinator for the ECS architecture
  * 
@@ -27,10 +66,16 @@ using WorldSystems = std::unordered_map<std::type_index, std::unique_ptr<System>
  * It handles system registration, initialization, updating, and shutdown.
  * The World class serves as the main entry point for the ECS framework,
  * coordinating the execution of all systems during the game loop.
- * Each world can have at most one system of each type.
+ * Each world can have at most one system of each type. Systems are
+ * initialized and ticked in the order they were added and shut down in
+ * reverse order.
  */
 class World {
     WorldSystems systems_;
+    std::vector<System*> order_;
+    std::uint64_t tick_count_{0};
+    std::uint64_t random_seed_{0};
+    bool deterministic_{false};
 
 public:
     World() = default;
@@ -41,8 +86,10 @@ public:
 
     bool initialize() noexcept {
         bool all_systems_initialized = true;
-        
-        for (auto& [_, system] : systems_) {
+
+        stagger_systems();
+
+        for (auto* system : order_) {
             if (!system->initialize()) {
                 all_systems_initialized = false;
                 break;
@@ -53,15 +100,80 @@ public:
     }
 
     void tick(const float& delta) noexcept {
-        for (auto& [_, system] : systems_) {
-            system->tick(delta);
+        for (auto* system : order_) {
+            float system_delta = 0.0f;
+            if (system->advance_schedule(tick_count_, delta, system_delta)) {
+                system->tick(system_delta);
+            }
+        }
+        ++tick_count_;
+    }
+
+    std::uint64_t get_tick_count() const noexcept { return tick_count_; }
+
+    /**
+     * @brief Rewinds or advances the tick counter, e.g. after restoring saved state
+     */
+    void set_tick_count(const std::uint64_t tick_count) noexcept { tick_count_ = tick_count; }
+
+    bool is_deterministic() const noexcept { return deterministic_; }
+
+    /**
+     * @brief Switches every system, including ones added later, to ID-ordered entity passes
+     *
+     * Together with the fixed system order and System::random_stream() this
+     * makes a tick depend only on the world state and the inputs, which is
+     * what lockstep peers need. Floating-point results must still be built
+     * with the same compiler settings on every peer.
+     */
+    void set_deterministic(const bool deterministic) {
+        deterministic_ = deterministic;
+        for (auto* system : order_) {
+            system->set_deterministic(deterministic);
+        }
+    }
+
+    std::uint64_t get_random_seed() const noexcept { return random_seed_; }
+
+    /**
+     * @brief Seeds every system's random streams; each system gets its own seed from its position in the order
+     */
+    void set_random_seed(const std::uint64_t seed) noexcept {
+        random_seed_ = seed;
+        for (std::size_t i = 0; i < order_.size(); ++i) {
+            order_[i]->set_random_seed(RandomStream::mix(seed + i));
+        }
+    }
+
+    /**
+     * @brief Systems in the order they are initialized and ticked
+     */
+    const std::vector<System*>& get_system_order() const noexcept { return order_; }
+
+    /**
+     * @brief Spreads systems that share an update interval evenly across ticks
+     */
+    void stagger_systems() noexcept {
+        stagger_update_phases(order_);
+    }
+
+    template<typename T>
+    bool set_update_schedule(const UpdateSchedule& schedule) noexcept {
+        auto* system = get_system<T>();
+        if (!system) {
+            return false;
         }
+
+        system->set_update_schedule(schedule);
+        stagger_systems();
+        return true;
     }
 
     void shutdown() noexcept {
-        for (auto& [_, system] : systems_) {
-            system->shutdown();
+        for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+            (*it)->shutdown();
         }
+        order_.clear();
         systems_.clear();
     }
 
@@ -113,8 +225,12 @@ public:
 
         auto system = std::make_unique<T>(std::forward<Args>(args)...);
         auto* system_ptr = system.get();
-        
+
+        system_ptr->set_deterministic(deterministic_);
+        system_ptr->set_random_seed(RandomStream::mix(random_seed_ + order_.size()));
+
         systems_.emplace(index, std::move(system));
+        order_.push_back(system_ptr);
 
         return system_ptr;
     }
@@ -132,6 +248,7 @@ public:
         // Call system shutdown lifecycle event
         it->second->shutdown();
 
+        order_.erase(std::find(order_.begin(), order_.end(), it->second.get()));
         systems_.erase(it);
         return true;
     }